@@ -40,9 +40,25 @@ int ec_group_set_name(ec_group ec, const char* name);
 char* ec_group_get_name(ec_group ec);
 
 
+/* Inversion and square root in the field of a curve, with the addition chains of the field
+ * prime if it has a known form. ec_field_sqrt returns 1 if A is a square */
+void ec_field_inv(mpz_t R, mpz_t A, ec_group ec);
+int ec_field_sqrt(mpz_t R, mpz_t A, ec_group ec);
+
 /* Initialize a curve, i.e., allocate memory for parameters of the curve */
 ec_group ec_group_init();
 
+/* Set up/Release the fixed-width arithmetic of a curve, see fe_ops.h */
+void ec_group_init_arith(ec_group ec);
+void ec_group_clear_arith(ec_group ec);
+
+/* Set up/Release the GLV endomorphism of a curve, NULL if none is known, see ecp_glv.c.
+ * ec_glv_split writes k = (-1)^neg1 * k1 + (-1)^neg2 * k2 * lambda mod order with plain halves
+ * k1, k2 < 2^(FE_BITS / 2), in data-independent time. Require: ec->glv != NULL */
+ec_glv ec_glv_init(const ec_group ec);
+void ec_glv_free(ec_glv glv);
+void ec_glv_split(fe_t k1, int *neg1, fe_t k2, int *neg2, const mpz_t k, const ec_group ec);
+
 /* Create a new EC group from a given name */
 ec_group ec_group_init_by_curve_name(const char* name);
 
@@ -77,6 +93,13 @@ ec_group ec_group_init_set_str_hex(const char* name, const char* field, const ch
 /* Release memory used by curve parameters */
 void ec_group_free(ec_group ec);
 
+/* Allocate/Release the scratch context of a curve, see ec_ctx.c */
+ec_ctx ec_ctx_init(const ec_group ec);
+void ec_ctx_free(ec_ctx ctx);
+/* Return the scratch context of the point operations of the calling thread, sized for ec unless
+ * ec is NULL */
+ec_ctx ec_ctx_thread(const ec_group ec);
+
 
 
 /************************************************************************/
@@ -88,16 +111,40 @@ ec_point ec_point_add_atomic(ec_point P, ec_point Q, ec_group ec);
 ec_point ec_point_add(ec_point P, ec_point Q, ec_group ec);
 ec_point ec_point_dbl(ec_point P, ec_group ec);
 
+/* Same operations writing into the caller's point R, R may alias P or Q. The temporaries come from
+ * ctx, so that no memory is allocated */
+void ec_point_add_atomic_to(ec_point R, const ec_point P, const ec_point Q, const ec_group ec, ec_ctx ctx);
+void ec_point_add_to(ec_point R, const ec_point P, const ec_point Q, const ec_group ec, ec_ctx ctx);
+void ec_point_dbl_to(ec_point R, const ec_point P, const ec_group ec, ec_ctx ctx);
+
 
 /*Set point R = 2P*/
 // pt_point point_doubling(pt_point P, pt_curve ec);
 
 /* Perform scalar multiplication to P, with the factor scalar on the curve curve EC due to the atomic principle */
 ec_point ecp_mul_atomic(const ec_point P, const mpz_t scalar, ec_group ec);
+/* Montgomery ladder on the complete formulas, constant time and inversion-free, see ecp_rcb.c */
+ec_point ecp_mul_complete(const ec_point P, const mpz_t scalar, ec_group ec);
 ec_point ecp_mul_montgomery(ec_point P, mpz_t scalar, ec_group ec);
 ec_point ecp_mul_rand_montgomery(ec_point P, mpz_t scalar, ec_group ec);
 
-/* Perform scalar multiplication to P, with the factor scalar on the curve curve EC due to the atomic principle */
+/* Perform scalar multiplication in Jacobian coordinates, with a single inversion, see ecp_proj.c */
+ec_point ecp_mul_proj(const ec_point P, const mpz_t scalar, ec_group ec);
+/* Compute k * P + l * Q in Jacobian coordinates */
+ec_point ecp_mul2_proj(const ec_point P, const mpz_t k, const ec_point Q, const mpz_t l, ec_group ec);
+
+/* Multiply the generator with the shared tables, see ecp_comb.c. Compute k * G with a sequence of
+ * operations independent of k (see ecp_comb_mul) and k * G + l * Q in variable time (interleaved
+ * wNAF, for public scalars) */
+ec_point ecp_mul_base(const mpz_t scalar, ec_group ec);
+ec_point ecp_mul2_base(const mpz_t k, const ec_point Q, const mpz_t l, ec_group ec);
+
+/* Multiply a point with the width-w NAF of the scalar, see ecp_wnaf.c. Variable time, only for
+ * public scalars (verification, key validation). On GLV curves, scalars below the order are only
+ * valid for points of the subgroup of prime order */
+ec_point ecp_mul_wnaf(const ec_point P, const mpz_t scalar, int w, ec_group ec);
+
+/* Perform scalar multiplication to P with signed fixed windows, in constant time for secret scalars */
 ec_point ec_sec_wmul(const ec_point P, const mpz_t scalar, ec_group ec);
 
 
@@ -0,0 +1,248 @@
+/*
+ * ec_arena.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+
+/*-
+ * Optional allocator of GMP, installed with mp_set_memory_functions by ec_arena_enable.
+ *
+ * The numbers of this library have at most a few hundred bits, so GMP mostly asks for blocks of
+ * a few to a few dozen limbs. Each thread bumps such blocks out of its own chunk of
+ * EC_ARENA_CHUNK bytes, without locking. A block starts with a header giving its chunk and its
+ * capacity, and links to the block below it; the chunk counts its live blocks, plus one while
+ * it is the current chunk of its thread. A block of the current chunk freed by its thread is
+ * marked, and the marked blocks at the top of the chunk are given back to the bump pointer: the
+ * temporaries of GMP are mostly freed in reverse order, and once all the numbers of an operation
+ * are freed, the bump offset is back to its value before the operation, whatever lives below.
+ * A chunk whose blocks are all freed is rewound at the reset point (ec_arena_reset, called
+ * after each signature and verification) or released once it is no longer current. Blocks
+ * freed by another thread only decrease the count, with atomic operations.
+ *
+ * Blocks larger than EC_ARENA_MAX_BLOCK go to malloc, as well as the numbers allocated while
+ * ec_arena_outside is set, that live across operations (the scratch contexts of ec_ctx.c) and
+ * would otherwise stay on top of the chunk. Such blocks stay out of the chunks when they grow.
+ *
+ * Every block is zeroed when it is freed or moved by a reallocation, so that no secret limb
+ * (private key, nonce) stays in memory that is reused.
+ */
+
+#define EC_ARENA_CHUNK		(64 * 1024)
+#define EC_ARENA_MAX_BLOCK	1024
+#define EC_ARENA_ALIGN		16
+#define EC_ARENA_NONE		((size_t) -1)
+
+typedef struct ec_arena_chunk_st* ec_arena_chunk;
+
+struct ec_arena_chunk_st {
+	long live;				/* live blocks, plus one while current, updated atomically */
+	size_t used;			/* bump offset in data */
+	size_t last;			/* offset of the header of the top block, EC_ARENA_NONE if empty */
+	unsigned char *data;	/* EC_ARENA_CHUNK bytes aligned on EC_ARENA_ALIGN */
+};
+
+/* Header in front of each block, keeps the blocks aligned on EC_ARENA_ALIGN */
+typedef union {
+	struct {
+		ec_arena_chunk chunk;	/* NULL for the blocks from malloc */
+		size_t cap;				/* bytes usable after the header */
+		size_t below;			/* offset of the header of the block below, EC_ARENA_NONE if none */
+		int freed;				/* freed by the thread of the chunk, below a live block */
+	} h;
+	unsigned char pad[2 * EC_ARENA_ALIGN];
+} ec_arena_hdr;
+
+/* Zero memory through a volatile pointer, so that the stores are not removed */
+static void *(*const volatile ec_arena_memset)(void *, int, size_t) = memset;
+
+static int arena_enabled = 0;
+static __thread ec_arena_chunk thread_chunk = NULL;
+static __thread int thread_outside = 0;
+static pthread_key_t thread_chunk_key;
+static pthread_once_t thread_chunk_once = PTHREAD_ONCE_INIT;
+
+static size_t ec_arena_round(size_t n) {
+	return (n + EC_ARENA_ALIGN - 1) & ~(size_t) (EC_ARENA_ALIGN - 1);
+}
+
+/* Drop a reference to chunk, release it with the last one */
+static void ec_arena_unref(ec_arena_chunk chunk) {
+	if (__atomic_sub_fetch(&chunk->live, 1, __ATOMIC_ACQ_REL) == 0)
+		free(chunk);
+}
+
+/* Thread exit: the current chunk is released once its blocks are freed */
+static void ec_arena_thread_exit(void *chunk) {
+	thread_chunk = NULL;
+	ec_arena_unref(chunk);
+}
+
+static void ec_arena_key_init(void) {
+	pthread_key_create(&thread_chunk_key, ec_arena_thread_exit);
+}
+
+static ec_arena_chunk ec_arena_chunk_new(void) {
+	ec_arena_chunk chunk;
+
+	chunk = malloc(ec_arena_round(sizeof(struct ec_arena_chunk_st)) + EC_ARENA_CHUNK + EC_ARENA_ALIGN);
+	assert(chunk != NULL);
+	chunk->data = (unsigned char *) ec_arena_round((size_t) chunk + sizeof(struct ec_arena_chunk_st));
+	chunk->used = 0;
+	chunk->last = EC_ARENA_NONE;
+	chunk->live = 1;
+	return chunk;
+}
+
+/* Block of n bytes from malloc, out of the chunks */
+static void *ec_arena_malloc(size_t n) {
+	size_t cap = ec_arena_round(n);
+	ec_arena_hdr *h;
+
+	h = malloc(sizeof(ec_arena_hdr) + cap);
+	assert(h != NULL);
+	h->h.chunk = NULL;
+	h->h.cap = cap;
+	return h + 1;
+}
+
+/* Give the freed blocks at the top of chunk back to the bump pointer */
+static void ec_arena_pop(ec_arena_chunk chunk) {
+	ec_arena_hdr *h;
+
+	while (chunk->last != EC_ARENA_NONE) {
+		h = (ec_arena_hdr *) (chunk->data + chunk->last);
+		if (!h->h.freed)
+			break;
+		chunk->used = chunk->last;
+		chunk->last = h->h.below;
+	}
+}
+
+/* Return 1 if the block h ends at the bump offset of the current chunk of the thread */
+static int ec_arena_is_last(const ec_arena_hdr *h) {
+	ec_arena_chunk chunk = thread_chunk;
+
+	return chunk != NULL && h->h.chunk == chunk
+			&& (const unsigned char *) (h + 1) + h->h.cap == chunk->data + chunk->used;
+}
+
+static void *ec_arena_alloc(size_t n) {
+	ec_arena_chunk chunk = thread_chunk;
+	size_t cap = ec_arena_round(n), need = sizeof(ec_arena_hdr) + cap;
+	ec_arena_hdr *h;
+
+	if (n > EC_ARENA_MAX_BLOCK || thread_outside)
+		return ec_arena_malloc(n);
+
+	if (chunk != NULL && chunk->used + need > EC_ARENA_CHUNK) {
+		if (__atomic_load_n(&chunk->live, __ATOMIC_ACQUIRE) == 1) {
+			chunk->used = 0;		/* all its blocks are freed */
+			chunk->last = EC_ARENA_NONE;
+		} else {
+			ec_arena_unref(chunk);
+			chunk = NULL;
+		}
+	}
+	if (chunk == NULL) {
+		pthread_once(&thread_chunk_once, ec_arena_key_init);
+		chunk = thread_chunk = ec_arena_chunk_new();
+		pthread_setspecific(thread_chunk_key, chunk);
+	}
+
+	h = (ec_arena_hdr *) (chunk->data + chunk->used);
+	h->h.below = chunk->last;
+	chunk->last = chunk->used;
+	chunk->used += need;
+	__atomic_add_fetch(&chunk->live, 1, __ATOMIC_RELAXED);
+	h->h.chunk = chunk;
+	h->h.cap = cap;
+	h->h.freed = 0;
+	return h + 1;
+}
+
+static void ec_arena_free(void *p, size_t n) {
+	ec_arena_hdr *h = (ec_arena_hdr *) p - 1;
+	ec_arena_chunk chunk = h->h.chunk;
+
+	ec_arena_memset(p, 0, h->h.cap);
+	if (chunk == NULL) {
+		free(h);
+		return;
+	}
+	if (chunk == thread_chunk) {
+		h->h.freed = 1;
+		ec_arena_pop(chunk);
+	}
+	ec_arena_unref(chunk);
+}
+
+static void *ec_arena_realloc(void *p, size_t old, size_t n) {
+	ec_arena_hdr *h = (ec_arena_hdr *) p - 1;
+	size_t cap = ec_arena_round(n);
+	void *q;
+
+	if (n <= h->h.cap)
+		return p;
+
+	/* grow the last block of the current chunk in place */
+	if (n <= EC_ARENA_MAX_BLOCK && ec_arena_is_last(h)
+			&& thread_chunk->used + (cap - h->h.cap) <= EC_ARENA_CHUNK) {
+		thread_chunk->used += cap - h->h.cap;
+		h->h.cap = cap;
+		return p;
+	}
+
+	q = h->h.chunk == NULL ? ec_arena_malloc(n) : ec_arena_alloc(n);
+	memcpy(q, p, old < n ? old : n);
+	ec_arena_free(p, old);
+	return q;
+}
+
+/** Installs the arena as the allocator of GMP. As required by mp_set_memory_functions, it must
+ *	be called before any other GMP function: the numbers allocated before would be freed by the
+ *	arena. Calling it again has no effect.
+ */
+void ec_arena_enable(void) {
+	if (arena_enabled)
+		return;
+	mp_set_memory_functions(ec_arena_alloc, ec_arena_realloc, ec_arena_free);
+	arena_enabled = 1;
+}
+
+/** Returns 1 if the arena is the allocator of GMP */
+int ec_arena_is_enabled(void) {
+	return arena_enabled;
+}
+
+/** Sets whether the numbers allocated next by the calling thread go to malloc instead of the
+ *	chunks, for numbers that live across operations. They stay there when they grow.
+ *	\param on	1 to allocate out of the chunks, 0 to allocate in the chunks again
+ *	\return		the previous setting
+ */
+int ec_arena_outside(int on) {
+	int old = thread_outside;
+
+	thread_outside = on;
+	return old;
+}
+
+/** Returns the bump offset of the current chunk of the calling thread, 0 without chunk */
+size_t ec_arena_used(void) {
+	return thread_chunk != NULL ? thread_chunk->used : 0;
+}
+
+/** Reset point of the calling thread, at the end of an operation: when all the blocks of the
+ *	current chunk were freed, the next operation bumps again from its beginning.
+ *	No effect if the arena is not enabled.
+ */
+void ec_arena_reset(void) {
+	ec_arena_chunk chunk = thread_chunk;
+
+	if (arena_enabled && chunk != NULL && __atomic_load_n(&chunk->live, __ATOMIC_ACQUIRE) == 1) {
+		chunk->used = 0;
+		chunk->last = EC_ARENA_NONE;
+	}
+}
@@ -34,6 +34,8 @@ int ec_group_cpy(ec_group dest, ec_group src) {
 	mpz_set(dest->B, src->B);
 	mpz_set(dest->order, src->order);
 	mpz_set(dest->cofactor, src->cofactor);
+	dest->red = src->red;
+	ec_group_init_arith(dest);
 
 	return 1;
 }
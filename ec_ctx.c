@@ -0,0 +1,139 @@
+/*
+ * ec_ctx.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+#include "ec.h"
+
+/* Size in bits of the field of the thread contexts created before any curve is known */
+#define EC_CTX_DEFAULT_FIELD_BITS	256
+
+/* Scratch contexts of each thread, for the curve and for the field operations, released at the
+ * exit of the thread */
+static __thread ec_ctx thread_ctx = NULL;
+static __thread ec_ctx thread_field_ctx = NULL;
+static pthread_key_t thread_ctx_key, thread_field_ctx_key;
+static pthread_once_t thread_ctx_once = PTHREAD_ONCE_INIT;
+
+/* Capacity of the temporaries for a field of field_bits bits: a product plus a carry limb each side */
+static mp_bitcnt_t ec_ctx_bits(size_t field_bits) {
+	return 2 * field_bits + 2 * GMP_LIMB_BITS;
+}
+
+/* Grow the temporaries of ctx for the curve ec, if they are too small */
+static void ec_ctx_reserve(ec_ctx ctx, const ec_group ec) {
+	mp_bitcnt_t bits = ec_ctx_bits(mpz_sizeinbase(ec->field, 2));
+	int i;
+
+	if (bits <= ctx->bits)
+		return;
+	for (i = 0; i < EC_CTX_TEMPS; i++)
+		mpz_realloc2(ctx->t[i], bits);
+	ctx->bits = bits;
+}
+
+/** Allocates the scratch context of a curve: temporaries sized for the product of two field
+ *	elements, so that the operations never grow them. The context does not keep ec, the
+ *	operations are given their curve.
+ *	A context is used by a single thread at a time.
+ *	\param ec	pointer to an ec_group structure, or NULL for the size of a 256-bit field
+ *	\return		pointer to an ec_ctx structure
+ */
+ec_ctx ec_ctx_init(const ec_group ec) {
+	ec_ctx ctx;
+	int i, outside;
+
+	ctx = malloc(sizeof(struct ec_ctx_st));
+	assert(ctx != NULL);
+
+	ctx->top = 0;
+	ctx->depth = 0;
+	ctx->bits = ec_ctx_bits(ec != NULL ? mpz_sizeinbase(ec->field, 2) : EC_CTX_DEFAULT_FIELD_BITS);
+	/* the temporaries live as long as the context, out of the arena so as not to pin its chunk */
+	outside = ec_arena_outside(1);
+	for (i = 0; i < EC_CTX_TEMPS; i++)
+		mpz_init2(ctx->t[i], ctx->bits);
+	ec_arena_outside(outside);
+
+	return ctx;
+}
+
+/** Frees a scratch context
+ *	\param ctx	pointer to an ec_ctx structure
+ */
+void ec_ctx_free(ec_ctx ctx) {
+	int i;
+
+	if (ctx == NULL)
+		return;
+
+	for (i = 0; i < EC_CTX_TEMPS; i++)
+		mpz_clear(ctx->t[i]);
+	free(ctx);
+}
+
+static void ec_ctx_thread_free(void *ctx) {
+	ec_ctx_free(ctx);
+}
+
+static void ec_ctx_thread_key_init(void) {
+	pthread_key_create(&thread_ctx_key, ec_ctx_thread_free);
+	pthread_key_create(&thread_field_ctx_key, ec_ctx_thread_free);
+}
+
+/** Returns the scratch context of the point operations of the calling thread, created on first use.
+ *	\param ec	curve of the following operations, grows the temporaries if needed, or NULL
+ *	\return		pointer to an ec_ctx structure, released when the thread exits
+ */
+ec_ctx ec_ctx_thread(const ec_group ec) {
+	if (UNLIKELY(thread_ctx == NULL)) {
+		pthread_once(&thread_ctx_once, ec_ctx_thread_key_init);
+		thread_ctx = ec_ctx_init(ec);
+		pthread_setspecific(thread_ctx_key, thread_ctx);
+	}
+	if (ec != NULL)
+		ec_ctx_reserve(thread_ctx, ec);
+	return thread_ctx;
+}
+
+/** Returns the scratch context of the field operations (field_ops.c) of the calling thread,
+ *	created on first use. It is distinct from the one of ec_ctx_thread, and the temporaries grow
+ *	with the moduli they are used with.
+ *	\return		pointer to an ec_ctx structure, released when the thread exits
+ */
+ec_ctx ec_ctx_field_thread(void) {
+	if (UNLIKELY(thread_field_ctx == NULL)) {
+		pthread_once(&thread_ctx_once, ec_ctx_thread_key_init);
+		thread_field_ctx = ec_ctx_init(NULL);
+		pthread_setspecific(thread_field_ctx_key, thread_field_ctx);
+	}
+	return thread_field_ctx;
+}
+
+/** Opens a frame: the temporaries taken until the matching ec_ctx_end are given back by it
+ *	\param ctx	pointer to an ec_ctx structure
+ */
+void ec_ctx_start(ec_ctx ctx) {
+	assert(ctx->depth < EC_CTX_DEPTH);
+	ctx->frame[ctx->depth++] = ctx->top;
+}
+
+/** Takes a temporary in the current frame. Its value is undefined.
+ *	\param ctx	pointer to an ec_ctx structure
+ *	\return		a temporary of at least ctx->bits bits
+ */
+mpz_ptr ec_ctx_get(ec_ctx ctx) {
+	assert(ctx->depth > 0 && ctx->top < EC_CTX_TEMPS);
+	return ctx->t[ctx->top++];
+}
+
+/** Closes the current frame
+ *	\param ctx	pointer to an ec_ctx structure
+ */
+void ec_ctx_end(ec_ctx ctx) {
+	assert(ctx->depth > 0);
+	ctx->top = ctx->frame[--ctx->depth];
+}
@@ -19,7 +19,7 @@ ec_group ec_group_dup(ec_group src) {
 		return NULL;
 
 	ec_group ret;
-	ret = malloc(sizeof(struct ec_group_st));
+	ret = calloc(1, sizeof(struct ec_group_st));
 	assert(ret != NULL);
 
 	int length = strlen(src->curve_name);
@@ -35,6 +35,8 @@ ec_group ec_group_dup(ec_group src) {
 	mpz_init_set(ret->order, src->order);
 	mpz_init_set(ret->cofactor, src->cofactor);
 	ret->generator = ec_point_dup(src->generator);
+	ret->red = src->red;
+	ec_group_init_arith(ret);
 
 	return ret;
 }
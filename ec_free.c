@@ -6,6 +6,7 @@
  */
 
 #include "ecdsa.h"
+#include "ec.h"
 #include "ec_point.h"
 
 /** frees a ec_group structure
@@ -22,6 +23,7 @@ void ec_group_free(ec_group ec) {
 	ec_point_free((*ec).generator);
 	mpz_clear((*ec).order);
 	mpz_clear((*ec).cofactor);
+	ec_group_clear_arith(ec);
 	free((*ec).curve_name);
 	free(ec);
 
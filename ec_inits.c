@@ -9,11 +9,13 @@
 #include "ec.h"
 #include "ec_point.h"
 #include "utils.h"
+#include "fe_ops.h"
 
 
 struct curve_params {
 	char* name;
 	const char *p, *a, *b, *Gx, *Gy, *order, *cofactor;
+	fe_reduction red;	/* fast reduction method of p */
 };
 
 static const struct curve_params curves_params[] = {
@@ -34,6 +36,8 @@ static const struct curve_params curves_params[] = {
 			"010000000000000000000000000001DCE8D2EC6184CAF0A971769FB1F7",
 			/* cofactor */
 			"01",
+			/* reduction */
+			FE_RED_PSEUDO_MERSENNE,
 	},
 	{
 			/* NIST P-224 */
@@ -52,6 +56,8 @@ static const struct curve_params curves_params[] = {
 			"FFFFFFFFFFFFFFFFFFFFFFFFFFFF16A2E0B8F03E13DD29455C5C2A3D",
 			/* cofactor */
 			"01",
+			/* reduction */
+			FE_RED_NIST_P224,
 	},
 	{
 			/* Certicom 256 bits curve */
@@ -70,6 +76,8 @@ static const struct curve_params curves_params[] = {
 			"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141",
 			/* cofactor */
 			"01",
+			/* reduction */
+			FE_RED_PSEUDO_MERSENNE,
 	},
 	{
 			/* NIST P-256 */
@@ -88,6 +96,8 @@ static const struct curve_params curves_params[] = {
 			"FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551",
 			/* cofactor */
 			"01",
+			/* reduction */
+			FE_RED_NIST_P256,
 	},
 
 };
@@ -99,7 +109,7 @@ static const struct curve_params curves_params[] = {
  */
 ec_group ec_group_init() {
 	ec_group ec;
-	ec = malloc(sizeof(struct ec_group_st));
+	ec = calloc(1, sizeof(struct ec_group_st));
 	assert(ec != NULL);
 
 	mpz_init(ec->A);
@@ -112,6 +122,51 @@ ec_group ec_group_init() {
 	return ec;
 }
 
+/** (Re)computes the fixed-width arithmetic contexts of a group from its parameters.
+ *	Must be called whenever the field, the order or the curve parameters change.
+ *	Groups whose field or order do not fit in FE_BITS keep NULL contexts and use
+ *	the big integer arithmetic only.
+ *  \param  ec  pointer to the ec_group structure
+ */
+void ec_group_init_arith(ec_group ec) {
+	ec_group_clear_arith(ec);
+
+	ec->fp = fe_field_init(ec->field, ec->red);
+	ec->fn = fe_field_init(ec->order, FE_RED_MONTGOMERY);
+	if (ec->fp != NULL) {
+		fe_from_mpz(ec->fe_a, ec->A, ec->fp);
+		fe_from_mpz(ec->fe_b, ec->B, ec->fp);
+	}
+
+	/* select the doubling formulas, A = -3 (NIST curves) or A = 0 (Koblitz curves) */
+	ec->a_form = EC_A_GENERIC;
+	if (mpz_cmp_ui(ec->field, 2) > 0) {
+		mpz_t t;
+		mpz_init(t);
+		mpz_add_ui(t, ec->A, 3);
+		if (mpz_divisible_p(ec->A, ec->field))
+			ec->a_form = EC_A_ZERO;
+		else if (mpz_divisible_p(t, ec->field))
+			ec->a_form = EC_A_MINUS3;
+		mpz_clear(t);
+	}
+
+	/* GLV endomorphism, for the known Koblitz curves */
+	ec->glv = ec_glv_init(ec);
+}
+
+/** Releases the fixed-width arithmetic contexts of a group
+ *  \param  ec  pointer to the ec_group structure
+ */
+void ec_group_clear_arith(ec_group ec) {
+	fe_field_free(ec->fp);
+	fe_field_free(ec->fn);
+	ec_glv_free(ec->glv);
+	ec->fp = NULL;
+	ec->fn = NULL;
+	ec->glv = NULL;
+}
+
 ec_group ec_group_init_by_curve_name(const char* name) {
 	ec_group ret = ec_group_init();
 	int ok = 0;
@@ -120,6 +175,7 @@ ec_group ec_group_init_by_curve_name(const char* name) {
 	int no_curves = sizeof(curves_params) / sizeof(struct curve_params);
 	for (i = 0; i < no_curves; i++) {
 		if (strcmp(curves_params[i].name, name) == 0) {
+			ret->red = curves_params[i].red;
 			ec_group_set_str_hex(ret, name, curves_params[i].p, curves_params[i].a, curves_params[i].b, curves_params[i].Gx,
 					curves_params[i].Gy, curves_params[i].order, curves_params[i].cofactor);
 			ok = 1;
@@ -128,6 +184,7 @@ ec_group ec_group_init_by_curve_name(const char* name) {
 	}
 
 	if (ok == 0) {
+		ec_group_free(ret);
 		return NULL;
 	}
 
@@ -161,6 +218,7 @@ void ec_group_set_mpz(ec_group ret, const char* name, mpz_t field, mpz_t a, mpz_
 	mpz_init_set(ret->order, order);
 	mpz_init_set(ret->cofactor, cofactor);
 	ret->generator = ec_point_init_set_mpz(Gx, Gy);
+	ec_group_init_arith(ret);
 
 	gmp_printf("\n We work on curve E: y^2 = x^3 + %Zd x + %Zd over finite field F_p: %Zd \n", a, b, field);
 	printf("The size of the finite field F_p = %d bits \n", bitlength(field));
@@ -181,7 +239,7 @@ void ec_group_set_mpz(ec_group ret, const char* name, mpz_t field, mpz_t a, mpz_
  */
 ec_group ec_group_init_set_mpz(const char* name, mpz_t field, mpz_t a, mpz_t b, mpz_t Gx, mpz_t Gy, mpz_t order, mpz_t cofactor) {
 	ec_group ret;
-	ret = malloc(sizeof(struct ec_group_st));
+	ret = calloc(1, sizeof(struct ec_group_st));
 	assert(ret != NULL);
 
 	int length = strlen(name);
@@ -197,6 +255,7 @@ ec_group ec_group_init_set_mpz(const char* name, mpz_t field, mpz_t a, mpz_t b,
 	mpz_init_set(ret->order, order);
 	mpz_init_set(ret->cofactor, cofactor);
 	ret->generator = ec_point_init_set_mpz(Gx, Gy);
+	ec_group_init_arith(ret);
 
 	gmp_printf("\n We work on curve E: y^2 = x^3 + %Zd x + %Zd over finite field F_p: %Zd \n", a, b, field);
 	printf("The size of the finite field F_p = %d bits \n", bitlength(field));
@@ -224,7 +283,7 @@ ec_group ec_group_init_set_str(const char* name, const char* field, const char*
 								int base) {
 
 	ec_group ret;
-	ret = malloc(sizeof(struct ec_group_st));
+	ret = calloc(1, sizeof(struct ec_group_st));
 	assert(ret != NULL);
 
 	int len = strlen(name);
@@ -240,6 +299,7 @@ ec_group ec_group_init_set_str(const char* name, const char* field, const char*
 	ret->generator = ec_point_init_set_str(Gx, Gy, base);
 	mpz_init_set_str(ret->order, order, base);
 	mpz_init_set_str(ret->cofactor, cofactor, base);
+	ec_group_init_arith(ret);
 
 	return ret;
 }
@@ -274,6 +334,7 @@ void ec_group_set_str(ec_group ret, const char* name, const char* field, const c
 	ret->generator = ec_point_init_set_str(Gx, Gy, base);
 	mpz_init_set_str(ret->order, order, base);
 	mpz_init_set_str(ret->cofactor, cofactor, base);
+	ec_group_init_arith(ret);
 }
 
 
@@ -8,6 +8,8 @@
 #include "ecdsa.h"
 #include "ec.h"
 #include "ec_point.h"
+#include "field_ops.h"
+#include "fe_ops.h"
 
 /** Get/Set the order of the group of points being used on the elliptic curve
  * 	\param ec		pointer to an ec_group structure
@@ -22,6 +24,7 @@ void ec_group_get_order(ec_group ec, mpz_t order) {
 void ec_group_set_order(ec_group ec, mpz_t order) {
 
 	mpz_set(ec->order, order);
+	ec_group_init_arith(ec);
 }
 
 /** Get/Set the co-factor the elliptic curve
@@ -52,6 +55,7 @@ void ec_group_get_field(ec_group ec, mpz_t field){
 void ec_group_set_field(ec_group ec, mpz_t field){
 
 	mpz_set(ec->field, field);
+	ec_group_init_arith(ec);
 }
 
 /** Get/Set the parameter A the elliptic curve
@@ -67,6 +71,7 @@ void ec_group_get_a(ec_group ec, mpz_t a){
 void ec_group_set_a(ec_group ec, mpz_t a){
 
 	mpz_set(ec->A, a);
+	ec_group_init_arith(ec);
 }
 
 /** Get/Set the parameter B of the elliptic curve
@@ -82,6 +87,7 @@ void ec_group_get_b(ec_group ec, mpz_t b){
 void ec_group_set_b(ec_group ec, mpz_t b){
 
 	mpz_set(ec->B, b);
+	ec_group_init_arith(ec);
 }
 
 
@@ -139,3 +145,41 @@ char* ec_group_get_name(ec_group ec) {
 	return name;
 }
 
+/** Inverts an element of the field of a curve in data-independent time, with the addition
+ *	chain of the field prime when the curve has fixed-width arithmetic, R = A^(p - 2) mod p
+ *	\param R	return value, 0 if A = 0 mod p
+ *	\param A	big number
+ *	\param ec	pointer to an ec_group structure
+ */
+void ec_field_inv(mpz_t R, mpz_t A, ec_group ec) {
+	fe_t a;
+
+	if (ec->fp == NULL) {
+		mod_Fermat_invert(R, A, ec->field);
+		return;
+	}
+	fe_from_mpz(a, A, ec->fp);
+	fe_inv_fermat(a, a, ec->fp);
+	fe_to_mpz(R, a, ec->fp);
+}
+
+/** Computes a square root in the field of a curve. Fields with fixed-width arithmetic and
+ *	p = 3 mod 4 use the addition chain of (p + 1) / 4, the others mod_sqrt.
+ *	\param R	return value, a square root of A mod p if A is a square
+ *	\param A	big number
+ *	\param ec	pointer to an ec_group structure
+ *	\return		1 if A is a square mod p, 0 otherwise
+ */
+int ec_field_sqrt(mpz_t R, mpz_t A, ec_group ec) {
+	fe_t a, r;
+	int ok;
+
+	if (ec->fp != NULL && (ec->fp->p[0] & 3) == 3) {
+		fe_from_mpz(a, A, ec->fp);
+		ok = fe_sqrt(r, a, ec->fp);
+		fe_to_mpz(R, r, ec->fp);
+		return ok;
+	}
+
+	return mod_sqrt(R, A, ec->field);
+}
@@ -6,27 +6,77 @@
  */
 
 #include "ecdsa.h"
+#include "ec.h"
 #include "ec_point.h"
 #include "field_ops.h"
+#include "fe_ops.h"
 
-/* Add two points P and Q in affine coordinates. If P = Q, perform a doubling, but in atomic principle
- *
- * Require:
- *
- * Input: P, Q
- * Output: R = P + Q. If P = Q, R = 2P
- *
- * ec: the elliptic curve
- *
- */
-ec_point ec_point_add_atomic(ec_point P, ec_point Q, ec_group ec) {
-	mpz_t field;
-	mpz_init_set(field, ec->field);
+/* R = -infinity, i.e. the point at infinity */
+static void ec_point_set_infinity_to(ec_point R) {
+	mpz_set_ui(R->x, 0);
+	mpz_set_ui(R->y, 0);
+	R->infinity = true;
+}
+
+/* Set R = (x, y) from the temporaries of the context, R may alias the operands */
+static void ec_point_set_to(ec_point R, const mpz_t x, const mpz_t y) {
+	mpz_set(R->x, x);
+	mpz_set(R->y, y);
+	R->infinity = false;
+}
+
+/* Return 1 if P = -Q, for finite P and Q */
+static int ec_point_is_inverse_to(const ec_point P, const ec_point Q, const ec_group ec, ec_ctx ctx) {
+	mpz_ptr t;
+	int ret;
+
+	if (mpz_cmp(P->x, Q->x))
+		return 0;
+	ec_ctx_start(ctx);
+	t = ec_ctx_get(ctx);
+	mpz_add(t, P->y, Q->y);
+	ret = !mpz_cmp_ui(t, 0) || !mpz_cmp(t, ec->field);
+	ec_ctx_end(ctx);
+	return ret;
+}
+
+/* Compute R = (lambda^2 - Px - Qx, lambda(Px - Rx) - Py), lambda = num / den, the chord or the tangent
+ * through P and Q */
+static void ec_point_chord_to(ec_point R, const ec_point P, const ec_point Q, mpz_t num, mpz_t den,
+		const ec_group ec, ec_ctx ctx) {
+	mpz_ptr field = ec->field;
+	mpz_ptr lambda, inv, x, y;
+
+	ec_ctx_start(ctx);
+	lambda = ec_ctx_get(ctx); inv = ec_ctx_get(ctx); x = ec_ctx_get(ctx); y = ec_ctx_get(ctx);
+
+	mod_sec_invert(inv, den, field);
+	mod_sec_mul(lambda, num, inv, field);
 
-	ec_point R;
-	// Initialize the point R
-	R = ec_point_init();
+	// Rx = lambda^2 - Px - Qx
+	mod_sec_sqr(x, lambda, field);
+	mod_sub(x, x, P->x, field);
+	mod_sub(x, x, Q->x, field);
 
+	// Ry = lambda(Px - Rx) - Py mod p
+	mod_sub(y, P->x, x, field);
+	mod_sec_mul(y, y, lambda, field);
+	mod_sub(y, y, P->y, field);
+
+	ec_point_set_to(R, x, y);
+	ec_ctx_end(ctx);
+}
+
+/** Add two points P and Q in affine coordinates. If P = Q, perform a doubling, but in atomic principle:
+ *	both cases run the same sequence of field operations.
+ *	R may alias P or Q, the temporaries come from ctx.
+ *	\param R	result R = P + Q, or R = 2P if P = Q
+ *	\param ec	curve of P and Q
+ *	\param ctx	scratch context, sized for ec
+ */
+void ec_point_add_atomic_to(ec_point R, const ec_point P, const ec_point Q, const ec_group ec, ec_ctx ctx) {
+	mpz_ptr field = ec->field;
+	mpz_ptr num, den;
 
 	//If Q is at infinity, set R to P
 	if(Q->infinity) {
@@ -36,99 +86,68 @@ ec_point ec_point_add_atomic(ec_point P, ec_point Q, ec_group ec) {
 		if(P->infinity){ //If P is at infinity set R to be Q
 			ec_point_cpy(R, Q);
 		} else
-			if(ec_point_is_inverse(P, Q, field)) { // If P = -Q, return R be the point at infinity
-				ec_point_set_at_infinity(R);
+			if(ec_point_is_inverse_to(P, Q, ec, ctx)) { // If P = -Q, return R be the point at infinity
+				ec_point_set_infinity_to(R);
 			} else {
-				//Initialize slope variable lambda
-				mpz_t lambda; mpz_init(lambda);
-				//Initialize temporary variables
-				mpz_t t1; mpz_init_set_str(t1, "1", 10);
-				mpz_t t2; mpz_init(t2);
-				mpz_t t3; mpz_init(t3);
+				ec_ctx_start(ctx);
+				num = ec_ctx_get(ctx); den = ec_ctx_get(ctx);
+				mpz_set_ui(den, 1);
 
 				// Calculate lambda
-				if (ec_point_cmp(P,Q, field)) { //If the points are the same use point doubling
-					//R = point_doubling(P, ec);
-					mod_sec_sqr(t1, P->x, field);
-					mod_addadd(t2, t1, t1, t1, field);
-					mod_add(t3, t2, ec->A, field);
-					mod_add(t1,P->y,P->y, field);
+				if (!mpz_cmp(P->x, Q->x)) { //If the points are the same use point doubling
+					mod_sec_sqr(den, P->x, field);
+					mod_addadd(num, den, den, den, field);
+					mod_add(num, num, ec->A, field);
+					mod_add(den, P->y, P->y, field);
 				} else {
 				// Calculate lambda: lambda = (Py - Qy)/(Px-Qx) mod p
-					mod_sec_sqr(t1, t1, field); // dummy operation
-					mod_addadd(t2, t1, t1, t1, field); // dummy operation
-					mod_sub(t3, P->y, Q->y, field);
-					mod_sub(t1, P->x, Q->x, field);
+					mod_sec_sqr(den, den, field); // dummy operation
+					mod_addadd(num, den, den, den, field); // dummy operation
+					mod_sub(num, P->y, Q->y, field);
+					mod_sub(den, P->x, Q->x, field);
 				}
 
-				mod_sec_invert(t2, t1, field);
-				mod_sec_mul(lambda, t3, t2, field);
-
-				// Rx = lambda^2 - Px - Qx
-				mod_sec_sqr(t1, lambda, field);
-				mod_subsub(R->x, t1, P->x, Q->x, field);
-
-				// Ry = lambda(Px - Rx) - Py mod p
-				mod_sub(t1, P->x, R->x, field);
-				mod_mulsub(R->y, t1, lambda, P->y, field);
-
-				//Clear variables, release memory
-				mpz_clear(t1); mpz_clear(t2); mpz_clear(t3); mpz_clear(lambda);
+				ec_point_chord_to(R, P, Q, num, den, ec, ctx);
+				ec_ctx_end(ctx);
 			}
-	return R;
 }
 
-ec_point ec_point_dbl(ec_point P, ec_group ec) {
-	mpz_t field;
-	mpz_init_set(field, ec->field);
-
-	ec_point R;
-	// Initialize the point R
-	R = ec_point_init();
-
+/** Double a point in affine coordinates, R may alias P
+ *	\param R	result R = 2P
+ *	\param ec	curve of P
+ *	\param ctx	scratch context, sized for ec
+ */
+void ec_point_dbl_to(ec_point R, const ec_point P, const ec_group ec, ec_ctx ctx) {
+	mpz_ptr field = ec->field;
+	mpz_ptr num, den;
 
-	//If Q is at infinity, set R to P
-	if(P->infinity) {
-		ec_point_set_at_infinity(R);
+	// 2P is the point at infinity when P is, or when P has order 2
+	if(P->infinity || !mpz_sgn(P->y)) {
+		ec_point_set_infinity_to(R);
 
 	} else {
-		//Initialize slope variable lambda
-		mpz_t lambda; mpz_init(lambda);
-		//Initialize temporary variables
-		mpz_t t1; mpz_init_set_ui(t1, 1);
-		mpz_t t2; mpz_init(t2);
-		mpz_t t3; mpz_init(t3);
+		ec_ctx_start(ctx);
+		num = ec_ctx_get(ctx); den = ec_ctx_get(ctx);
 
 		// Calculate lambda = (3Px^2 + a)/2Py
-		mod_sec_sqr(t1, P->x, field);
-		mod_addadd(t2, t1, t1, t1, field);
-		mod_add(t3, t2, ec->A, field);
-		mod_add(t1,P->y,P->y, field);
-
-		mod_sec_invert(t2, t1, field);
-		mod_sec_mul(lambda, t3, t2, field);
+		mod_sec_sqr(den, P->x, field);
+		mod_addadd(num, den, den, den, field);
+		mod_add(num, num, ec->A, field);
+		mod_add(den, P->y, P->y, field);
 
-		// Rx = lambda^2 - 2Px
-		mod_sec_sqr(t1, lambda, field);
-		mod_subsub(R->x, t1, P->x, P->x, field);
-
-		// Ry = lambda(Px - Rx) - Py mod p
-		mod_sub(t1, P->x, R->x, field);
-		mod_mulsub(R->y, t1, lambda, P->y, field);
-
-		//Clear variables, release memory
-		mpz_clear(t1); mpz_clear(t2); mpz_clear(t3); mpz_clear(lambda);
+		ec_point_chord_to(R, P, P, num, den, ec, ctx);
+		ec_ctx_end(ctx);
 	}
-	return R;
 }
 
-ec_point ec_point_add(ec_point P, ec_point Q, ec_group ec) {
-	mpz_t field;
-	mpz_init_set(field, ec->field);
-
-	ec_point R;
-	// Initialize the point R
-	R = ec_point_init();
+/** Add two points P and Q in affine coordinates, R may alias P or Q
+ *	\param R	result R = P + Q
+ *	\param ec	curve of P and Q
+ *	\param ctx	scratch context, sized for ec
+ */
+void ec_point_add_to(ec_point R, const ec_point P, const ec_point Q, const ec_group ec, ec_ctx ctx) {
+	mpz_ptr field = ec->field;
+	mpz_ptr num, den;
 
 	//If Q is at infinity, set R to P
 	if(Q->infinity) {
@@ -138,48 +157,119 @@ ec_point ec_point_add(ec_point P, ec_point Q, ec_group ec) {
 		if(P->infinity){ //If P is at infinity set R to be Q
 			ec_point_cpy(R, Q);
 		} else
-			if(ec_point_is_inverse(P, Q, field)) { // If P = -Q, return R be the point at infinity
-				ec_point_set_at_infinity(R);
-			} else {
-				//Initialize slope variable lambda
-				mpz_t lambda; mpz_init(lambda);
-				//Initialize temporary variables
-				mpz_t t1; mpz_init(t1);
-				mpz_t t2; mpz_init(t2);
+			if(ec_point_is_inverse_to(P, Q, ec, ctx)) { // If P = -Q, return R be the point at infinity
+				ec_point_set_infinity_to(R);
+			} else
+				if(!mpz_cmp(P->x, Q->x)) { // P = Q
+					ec_point_dbl_to(R, P, ec, ctx);
+				} else {
+					ec_ctx_start(ctx);
+					num = ec_ctx_get(ctx); den = ec_ctx_get(ctx);
 
-				// Calculate lambda: lambda = (Py - Qy)/(Px-Qx) mod p
-				mod_sub(t1, P->x, Q->x, field);
-				mod_sec_invert(t2, t1, field);
-				mod_sub(t1, P->y, Q->y, field);
-				mod_sec_mul(lambda, t1, t2, field);
+					// Calculate lambda: lambda = (Py - Qy)/(Px-Qx) mod p
+					mod_sub(num, P->y, Q->y, field);
+					mod_sub(den, P->x, Q->x, field);
 
-				// Rx = lambda^2 - Px - Qx
-				mod_sec_sqr(t1, lambda, field);
-				mod_subsub(R->x, t1, P->x, Q->x, field);
+					ec_point_chord_to(R, P, Q, num, den, ec, ctx);
+					ec_ctx_end(ctx);
+				}
+}
 
-				// Ry = lambda(Px - Rx) - Py mod p
-				mod_sub(t1, P->x, R->x, field);
-				mod_mulsub(R->y, t1, lambda, P->y, field);
+/* Return 1 if the complete formulas of ecp_rcb.c hold on ec: they need fixed-width arithmetic and
+ * a curve of odd order, here of prime order with a cofactor 1 */
+static int ecp_hom_applies(const ec_group ec) {
+	return ec->fp != NULL && mpz_cmp_ui(ec->cofactor, 1) == 0;
+}
+
+/* Add two points P and Q in affine coordinates. If P = Q, perform a doubling, but in atomic principle
+ *
+ * Require:
+ *
+ * Input: P, Q
+ * Output: R = P + Q. If P = Q, R = 2P
+ *
+ * ec: the elliptic curve
+ *
+ */
+ec_point ec_point_add_atomic(ec_point P, ec_point Q, ec_group ec) {
+	ec_point R = ec_point_init();
+
+	if (ecp_hom_applies(ec)) {
+		// complete formulas: the same operations for P = Q, P = -Q and the point at infinity
+		ecp_fe Pa, Qa;
+		ecp_hom Ph, Qh;
+
+		ecp_fe_set_point(&Pa, P, ec);
+		ecp_fe_set_point(&Qa, Q, ec);
+		ecp_hom_set_affine(&Ph, &Pa, ec);
+		ecp_hom_set_affine(&Qh, &Qa, ec);
+		ecp_hom_add(&Ph, &Ph, &Qh, ec);
+		ecp_hom_get_affine(&Pa, &Ph, ec);
+		ecp_fe_get_point(R, &Pa, ec);
+	} else {
+		ec_ctx ctx = ec_ctx_thread(ec);
+		ec_point_add_atomic_to(R, P, Q, ec, ctx);
+	}
+
+	return R;
+}
+
+ec_point ec_point_dbl(ec_point P, ec_group ec) {
+	ec_point R = ec_point_init();
+	ec_ctx ctx = ec_ctx_thread(ec);
+
+	ec_point_dbl_to(R, P, ec, ctx);
+
+	return R;
+}
+
+ec_point ec_point_add(ec_point P, ec_point Q, ec_group ec) {
+	ec_point R = ec_point_init();
+	ec_ctx ctx = ec_ctx_thread(ec);
+
+	ec_point_add_to(R, P, Q, ec, ctx);
 
-				//Clear variables, release memory
-				mpz_clear(t1); mpz_clear(t2); mpz_clear(lambda);
-			}
 	return R;
 }
 
 /** Perform scalar multiplication to P, with the factor scalar on the curve curve EC
  *
  */
-ec_point ecp_mul_atomic(ec_point P, mpz_t scalar, ec_group group) {
+ec_point ecp_mul_atomic(const ec_point P, const mpz_t scalar, ec_group group) {
 
 	ec_point Rop = ec_point_init();
 	// Initialize R as the point at infinity, the neutral element of the group
 	ec_point_set_at_infinity(Rop);
 
-	if(!P->infinity) {
+	if(!P->infinity && ecp_hom_applies(group)) {
+		// Same ladder on fixed-width coordinates with the complete formulas (ecp_rcb.c): the
+		// additions and doublings have neither branch nor inversion, a single one at the end
+		unsigned int b;
+		int i;
+		ecp_fe Pa, Ra;
+		ecp_hom R[2];
+
+		memset(&Ra, 0, sizeof(ecp_fe));
+		Ra.infinity = 1;
+		ecp_hom_set_affine(&R[0], &Ra, group);
+		ecp_fe_set_point(&Pa, P, group);
+		ecp_hom_set_affine(&R[1], &Pa, group);
+
+		i = mpz_sizeinbase(scalar, 2) - 1; b = 0;
+		while (i >= 0) {
+			ecp_hom_add(&R[0], &R[0], &R[b], group);
+
+			b = b ^ mpz_tstbit(scalar, i);
+			i -= (1 - b);
+		}
+
+		ecp_hom_get_affine(&Ra, &R[0], group);
+		ecp_fe_get_point(Rop, &Ra, group);
+	} else if(!P->infinity) {
 		//Initializing variables
 		unsigned int k, b;
 		ec_point R[2];
+		ec_ctx ctx = ec_ctx_thread(group);
 
 		R[0] = ec_point_init(); R[0]->infinity = true;
 		R[1] = ec_point_dup(P);
@@ -189,7 +279,7 @@ ec_point ecp_mul_atomic(ec_point P, mpz_t scalar, ec_group group) {
 
 		while (i >= 0) {
 
-			R[0] = ec_point_add_atomic(R[0], R[b], group);
+			ec_point_add_atomic_to(R[0], R[0], R[b], group, ctx);
 
 			b = b ^ mpz_tstbit(scalar, i);
 			i -= (1 - b);
@@ -206,9 +296,119 @@ ec_point ecp_mul_atomic(ec_point P, mpz_t scalar, ec_group group) {
 
 }
 
+/** Perform scalar multiplication to P with the Montgomery ladder on the complete formulas in
+ *	homogeneous projective coordinates (ecp_hom_ladder): one addition and one doubling per bit,
+ *	without branch nor inversion in the loop, over the bit length of the order.
+ *	Falls back to ecp_mul_proj for groups without fixed-width arithmetic or with a cofactor other
+ *	than 1, on which the complete formulas do not hold.
+ * 	\param P		pointer to an ec_point structure
+ * 	\param scalar	non-negative big number, secret
+ * 	\param ec		pointer to an ec_group structure
+ * 	\return 		pointer to an ec_point structure, scalar * P
+ */
+ec_point ecp_mul_complete(const ec_point P, const mpz_t scalar, ec_group ec) {
+	ec_point Rop;
+	ecp_fe Pa, Ra;
+	ecp_hom R;
+
+	if (!ecp_hom_applies(ec) || mpz_sgn(scalar) < 0)
+		return ecp_mul_proj(P, scalar, ec);
+
+	Rop = ec_point_init();
+	ecp_fe_set_point(&Pa, P, ec);
+	ecp_hom_ladder(&R, &Pa, scalar, ec);
+	ecp_hom_get_affine(&Ra, &R, ec);
+	ecp_fe_get_point(Rop, &Ra, ec);
+	return Rop;
+}
+
+/* Multiply P by scalar with the co-Z ladder of ecp_coz.c, on scalar reduced modulo the order and
+ * with a random common Z if randomize. The ladder runs on k + n or k + 2n, whichever has
+ * bits(n) + 1 bits, so that its number of iterations does not depend on k. The scalars 0, 1,
+ * n - 2, n - 1, for which the ladder would meet the point at infinity or add opposite points,
+ * and the points with x = 0 go to ecp_mul_proj. Returns 1 with *Rop = scalar * P, 0 if the ladder does not apply: no
+ * fixed-width arithmetic, or a cofactor other than 1, where P may not have the order of the group,
+ * and -1 with *Rop = NULL if the random mu cannot be drawn */
+static int ecp_mul_coz(ec_point *Rop, const ec_point P, const mpz_t scalar, int randomize, ec_group ec) {
+	ecp_fe Pa, Ra;
+	mpz_t k;
+	fe_t mu;
+	int rnd = 0;
+
+	*Rop = NULL;
+	if (ec->fp == NULL || mpz_cmp_ui(ec->cofactor, 1) != 0)
+		return 0;
+
+	if (P->infinity) {
+		*Rop = ec_point_init();
+		ec_point_set_at_infinity(*Rop);
+		return 1;
+	}
+
+	mpz_init(k);
+	mpz_mod(k, scalar, ec->order);
+	mpz_add_ui(k, k, 2);
+	ecp_fe_set_point(&Pa, P, ec);
+	if (mpz_cmp_ui(k, 4) < 0 || mpz_cmp(k, ec->order) >= 0 || fe_is_zero(Pa.x)) {
+		mpz_sub_ui(k, k, 2);
+		*Rop = ecp_mul_proj(P, k, ec);
+		mpz_clear(k);
+		return 1;
+	}
+	mpz_sub_ui(k, k, 2);
+
+	/* k + n if it has bits(n) + 1 bits, k + 2n otherwise */
+	mpz_add(k, k, ec->order);
+	mpz_addmul_ui(k, ec->order, mpz_tstbit(k, mpz_sizeinbase(ec->order, 2)) ^ 1);
+
+	/* mu = 1 + (2 * FE_BITS random bits mod p - 1), close to uniform in [1, p - 1] */
+	if (randomize) {
+		unsigned char buf[2 * FE_BITS / 8];
+		FILE *fp = fopen("/dev/urandom", "rb");
+		if (fp != NULL) {
+			rnd = fread(buf, 1, sizeof(buf), fp) == sizeof(buf);
+			fclose(fp);
+		}
+		if (!rnd) {
+			fprintf(stdout, "ECDSA_F_ECP_MUL_RAND_MONTGOMERY, ERR_R_RAND_LIB");
+			memset(buf, 0, sizeof(buf));
+			mpz_clear(k);
+			return -1;
+		}
+		mpz_t m, q;
+		mpz_init(m); mpz_init(q);
+		mpz_import(m, sizeof(buf), 1, 1, 0, 0, buf);
+		mpz_sub_ui(q, ec->field, 1);
+		mpz_mod(m, m, q);
+		mpz_add_ui(m, m, 1);
+		fe_from_mpz(mu, m, ec->fp);
+		mpz_clear(m); mpz_clear(q);
+		memset(buf, 0, sizeof(buf));
+	}
+
+	*Rop = ec_point_init();
+	ecp_coz_ladder(&Ra, &Pa, k, randomize ? mu : NULL, ec);
+	ecp_fe_get_point(*Rop, &Ra, ec);
+	mpz_clear(k);
+	return 1;
+}
+
+/** Perform scalar multiplication to P with the Montgomery ladder.
+ *	With fixed-width arithmetic and a cofactor 1, it runs on the co-Z formulas of ecp_coz.c: an
+ *	XYCZ-ADDC and an XYCZ-ADD per bit, the same for both values of the bit, and a single inversion
+ *	at the end. Otherwise, an addition and a doubling of ec_point per bit.
+ * 	\param P		pointer to an ec_point structure
+ * 	\param scalar	non-negative big number
+ * 	\param group	pointer to an ec_group structure
+ * 	\return 		pointer to an ec_point structure, scalar * P
+ */
 ec_point ecp_mul_montgomery(ec_point P, mpz_t scalar, ec_group group) {
 
-	ec_point Rop = ec_point_init();
+	ec_point Rop;
+	if (ecp_mul_coz(&Rop, P, scalar, 0, group))
+		return Rop;
+
+	Rop = ec_point_init();
 	// Initialize R as the point at infinity, the neutral element of the group
 	ec_point_set_at_infinity(Rop);
 
@@ -216,6 +416,7 @@ ec_point ecp_mul_montgomery(ec_point P, mpz_t scalar, ec_group group) {
 		//Initializing variables
 		int i, bit, ibit;
 		ec_point R[2];
+		ec_ctx ctx = ec_ctx_thread(group);
 
 		R[0] = ec_point_init(); R[0]->infinity = true;
 		R[1] = ec_point_dup(P);
@@ -225,8 +426,8 @@ ec_point ecp_mul_montgomery(ec_point P, mpz_t scalar, ec_group group) {
 		for(i = k - 1; i >= 0; i--) {
 			bit = mpz_tstbit(scalar, i); ibit = bit ^ 0x1;
 
-			R[ibit] = ec_point_add(R[bit], R[ibit], group);
-			R[bit] = ec_point_dbl(R[bit], group);
+			ec_point_add_to(R[ibit], R[bit], R[ibit], group, ctx);
+			ec_point_dbl_to(R[bit], R[bit], group, ctx);
 		}
 
 		ec_point_cpy(Rop, R[0]);
@@ -252,11 +453,18 @@ static int coin_toss() {
  * 	Proposed by Coron at CHES 1999
  *
  * 	@return: rop = base ^ exp mod N. Assume that base, exp, N > 0
+ * 	Returns NULL if the random mu of the co-Z ladder cannot be drawn.
  *
  */
 ec_point ecp_mul_rand_montgomery(ec_point P, mpz_t scalar, ec_group group){
 
-	ec_point Rop = ec_point_init();
+	/* co-Z ladder with the common Z multiplied by a random mu, see ecp_mul_coz. If mu cannot be
+	 * drawn, Rop is NULL: the multiplication is not run without its randomization */
+	ec_point Rop;
+	if (ecp_mul_coz(&Rop, P, scalar, 1, group))
+		return Rop;
+
+	Rop = ec_point_init();
 	// Initialize R as the point at infinity, the neutral element of the group
 	ec_point_set_at_infinity(Rop);
 
@@ -264,6 +472,7 @@ ec_point ecp_mul_rand_montgomery(ec_point P, mpz_t scalar, ec_group group){
 		//Initializing variables
 		int i, k, bit, randbit, irandbit;
 		ec_point R[2];
+		ec_ctx ctx = ec_ctx_thread(group);
 
 		R[0] = ec_point_init(); R[0]->infinity = true;
 		srand(time(NULL)); //     <- srand() here, just ONCE
@@ -285,8 +494,8 @@ ec_point ecp_mul_rand_montgomery(ec_point P, mpz_t scalar, ec_group group){
 				randbit = coin_toss();
 			irandbit = randbit ^ 0x1;
 
-			R[randbit] = ec_point_add_atomic(R[0], R[randbit ^ bit], group);
-			R[irandbit] = ec_point_add_atomic(R[randbit], P, group);
+			ec_point_add_atomic_to(R[randbit], R[0], R[randbit ^ bit], group, ctx);
+			ec_point_add_atomic_to(R[irandbit], R[randbit], P, group, ctx);
 		}
 
 		ec_point_cpy(Rop, R[0]);
@@ -302,36 +511,29 @@ ec_point ecp_mul_rand_montgomery(ec_point P, mpz_t scalar, ec_group group){
 
 /* Perform scalar multiplication to P, with the factor scalar on the curve curve EC
  *
- * Using the window method, but in silence mode to cached-based timing attacks on pre-computed table
- *
+ * Using the signed fixed-window method in Jacobian coordinates (ecp_jac_wmul): every lookup reads
+ * the whole table of precomputed multiples, in silence mode to cache-based timing attacks, and
+ * the sequence of operations does not depend on scalar. Falls back to the double-and-add-always
+ * ecp_mul_proj for groups without fixed-width arithmetic.
  */
-ec_point ec_sec_wmul(ec_point P, mpz_t scalar, ec_group ec) {
-	ec_point Ret = ec_point_init();
+ec_point ec_sec_wmul(const ec_point P, const mpz_t scalar, ec_group ec) {
+	ec_point Ret;
+	ecp_fe Pa, Ra;
+	ecp_jac R;
+
+	if (ec->fp == NULL || mpz_sgn(scalar) < 0
+			|| mpz_sizeinbase(scalar, 2) >= (FE_LIMBS + 1) * GMP_LIMB_BITS)
+		return ecp_mul_proj(P, scalar, ec);
+
+	Ret = ec_point_init();
 	// Initialize R as the point at infinity, the neutral element of the group
 	ec_point_set_at_infinity(Ret);
 
 	if(!P->infinity) {
-		//Initializing variables
-		unsigned int i, k, b;
-		ec_point R[2];
-		R[0] = ec_point_init(); R[0]->infinity = true;
-		R[1] = ec_point_dup(P); 	//point_copy(t, x);
-
-		k = mpz_sizeinbase(scalar, 2);
-		i = k - 1; b = 0;
-
-		while(i >= 0) {
-			R[0] = ec_point_add_atomic(R[0], R[b], ec);
-
-			b = b ^ mpz_tstbit(scalar, i);
-			i -= (1 - b);
-		}
-
-		ec_point_cpy(Ret, R[0]);
-
-		//Release temporary variables
-		ec_point_free(R[0]);
-		ec_point_free(R[1]);
+		ecp_fe_set_point(&Pa, P, ec);
+		ecp_jac_wmul(&R, &Pa, scalar, ec);
+		ecp_jac_get_affine(&Ra, &R, ec);
+		ecp_fe_get_point(Ret, &Ra, ec);
 	}
 	return Ret;
 }
@@ -79,16 +79,23 @@ int ec_point_cmp(ec_point P, ec_point Q, mpz_t mod);
  */
 char* ec_point_compress(ec_point P);
 
-/**	Deompress the point P to a string
+/**	Decompress the point P from a string and check that it is on the curve
  *	\param P	pointer to an ec_point structure
- *	\return 	a string
+ *	\return 	1 on success, 0 if zPoint is not a compressed point of the curve
+ */
+int ec_point_decompress(ec_point P, const char* zPoint, ec_group ec);
+
+/**	Decompress n points of the same curve
+ *	\param results	array of n results, 1 for the valid points, or NULL
+ *	\return 	number of valid points, -1 on error
  */
-void ec_point_decompress(ec_point P, char* zPoint, ec_group ec);
+int ec_point_decompress_batch(ec_point *P, const char **zPoints, int n, ec_group ec, int *results);
 
 /** Release point
  *	\param P	pointer to an ec_point structure
  */
 void ec_point_free(ec_point P);
+void ec_point_proj_free(ec_point_proj P);
 
 
 /************************************************************************/
@@ -142,6 +149,72 @@ void ec_point_proj_set_at_infinity(ec_point_proj P);
 //void affine2proj(pt_point_proj P, pt_point Q, mpz_t mod);
 //void proj2affine(pt_point P, pt_point_proj Q, mpz_t mod);
 
+/** Convert an affine point to/from fixed-width coordinates over the field of ec
+ *	Require: ec->fp != NULL
+ *	\param R	destination point
+ *	\param P	source point
+ *	\param ec	pointer to the ec_group structure
+ */
+void ecp_fe_set_point(ecp_fe *R, const ec_point P, const ec_group ec);
+void ecp_fe_get_point(ec_point R, const ecp_fe *P, const ec_group ec);
+
+/* Table lookup and conditional negation in data-independent time, for secret scalars */
+void ecp_fe_lookup(ecp_fe *R, const ecp_fe *T, int n, unsigned int idx);
+void ecp_fe_cneg(ecp_fe *R, int flag, const ec_group ec);
+
+
+/************************************************************************/
+/*				Point operations in Jacobian coordinates				*/
+/************************************************************************/
+
+/* Doubling and additions on big integers, see ecp_proj.c. R may be equal to the inputs */
+void ec_point_proj_dbl(ec_point_proj R, const ec_point_proj P, const ec_group ec);
+void ec_point_proj_add(ec_point_proj R, const ec_point_proj P, const ec_point_proj Q, const ec_group ec);
+void ec_point_proj_mul(ec_point_proj R, const ec_point_proj P, const mpz_t scalar, const ec_group group);
+
+/* Convert a point from affine coordinates to Jacobian coordinates and vice versa */
+void ec_point_proj_set_point(ec_point_proj R, const ec_point P);
+void ec_point_proj_get_point(ec_point R, const ec_point_proj P, const ec_group ec);
+
+/* Same operations on fixed-width coordinates. Require: ec->fp != NULL */
+void ecp_jac_dbl(ecp_jac *R, const ecp_jac *P, const ec_group ec);
+void ecp_jac_add(ecp_jac *R, const ecp_jac *P, const ecp_jac *Q, const ec_group ec);
+void ecp_jac_add_mixed(ecp_jac *R, const ecp_jac *P, const ecp_fe *Q, const ec_group ec);
+void ecp_jac_mul(ecp_jac *R, const ecp_fe *P, const mpz_t scalar, const ec_group ec);
+void ecp_jac_wmul(ecp_jac *R, const ecp_fe *P, const mpz_t scalar, const ec_group ec);
+
+void ecp_jac_set_infinity(ecp_jac *R, const ec_group ec);
+void ecp_jac_cmov(ecp_jac *R, const ecp_jac *P, int flag);
+void ecp_jac_set_affine(ecp_jac *R, const ecp_fe *P, const ec_group ec);
+void ecp_jac_get_affine(ecp_fe *R, const ecp_jac *P, const ec_group ec);
+void ecp_jac_batch_get_affine(ecp_fe *R, const ecp_jac *P, int n, const ec_group ec);
+
+/* Complete formulas in homogeneous projective coordinates, without branch nor exception, and the
+ * Montgomery ladder on them, see ecp_rcb.c. Require: ec->fp != NULL, the order of the curve is odd */
+void ecp_hom_add(ecp_hom *R, const ecp_hom *P, const ecp_hom *Q, const ec_group ec);
+void ecp_hom_dbl(ecp_hom *R, const ecp_hom *P, const ec_group ec);
+void ecp_hom_set_affine(ecp_hom *R, const ecp_fe *P, const ec_group ec);
+void ecp_hom_get_affine(ecp_fe *R, const ecp_hom *P, const ec_group ec);
+void ecp_hom_cswap(ecp_hom *P, ecp_hom *Q, int flag);
+void ecp_hom_ladder(ecp_hom *R, const ecp_fe *P, const mpz_t scalar, const ec_group ec);
+
+/* Montgomery ladder on the co-Z formulas, see ecp_coz.c. Require: ec->fp != NULL */
+void ecp_coz_ladder(ecp_fe *R, const ecp_fe *P, const mpz_t scalar, const fe_t mu, const ec_group ec);
+
+/* Shared comb table of the generator of ec and fixed-base multiplication, see ecp_comb.c */
+ecp_comb ecp_comb_get(const ec_group ec);
+void ecp_comb_mul(ecp_jac *R, const ecp_comb comb, const mpz_t scalar, const ec_group ec);
+
+/* Image phi(P) = (beta * x, y) = lambda * P of P under the GLV endomorphism, see ecp_glv.c */
+void ecp_glv_endo(ecp_fe *R, const ecp_fe *P, const ec_group ec);
+
+/* Variable-time width-w NAF recoding and multiplications, see ecp_wnaf.c. Only for public scalars */
+int ecp_wnaf_recode(int *naf, const mpz_t k, int w);
+void ecp_wnaf_odd_multiples(ecp_fe *T, const ecp_fe *P, int n, const ec_group ec);
+void ecp_wnaf_mul(ecp_jac *R, const mpz_t k, const ecp_fe *TP, int w, const ec_group ec);
+void ecp_wnaf_mul2(ecp_jac *R, const mpz_t k, const ecp_fe *TP, int wp, const mpz_t l, const ecp_fe *TQ, int wq,
+		const ec_group ec);
+
 
 
 #endif /* EC_POINT_H_ */
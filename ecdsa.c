@@ -279,7 +279,7 @@ int key_generation(const char* c_name, const char* in_fname, const char* o_fname
 	FILE *ifp = NULL;
 	FILE *ofp = NULL;
 	ec_key eckey = NULL;
-	char curve[9];
+	char curve[16];
 	char priv_str[600];
 	int genpub = 0;
 	int ok = 0;
@@ -297,7 +297,8 @@ int key_generation(const char* c_name, const char* in_fname, const char* o_fname
 	}
 
 	if(c_name != NULL) { // Curve provided to generate a private key
-		strcpy(curve, c_name);
+		strncpy(curve, c_name, sizeof(curve) - 1);
+		curve[sizeof(curve) - 1] = '\0';
 		genpub = 0;
 	} else { // A file storing private key need to be provided
 		if (in_fname == NULL ) { // No file name provided to open
@@ -309,11 +310,11 @@ int key_generation(const char* c_name, const char* in_fname, const char* o_fname
 				fprintf(stderr, "Can't open input file %s to read the private key \n", in_fname);
 				return (ok);
 			} else {
-				if (fscanf(ifp, "%s", curve) == EOF) {
+				if (fscanf(ifp, "%15s", curve) == EOF) {
 					fprintf(stderr, "Can't get the curve name from file %s \n", in_fname);
 					exit(EXIT_FAILURE);
 				}
-				if (fscanf(ifp, "%s", priv_str) == EOF) {
+				if (fscanf(ifp, "%599s", priv_str) == EOF) {
 					fprintf(stderr, "Can't get the private key from file %s \n", in_fname);
 					return (ok);
 				}
@@ -326,7 +327,7 @@ int key_generation(const char* c_name, const char* in_fname, const char* o_fname
 	eckey = ec_key_init_by_curve_name(curve);
 
 	if (eckey == NULL) {
-		fprintf(stderr, "Curve %s was not built-in the program \n", c_name);
+		fprintf(stderr, "Curve %s was not built-in the program \n", curve);
 		return (ok);//exit(2);
 	}
 
@@ -384,7 +385,7 @@ int sig_generation(char* key, char* msg, char *signature) {
 	// Declare variables
 	FILE *ifp = NULL;
 	FILE *ofp = NULL;
-	char curve[9];
+	char curve[16];
 	char priv_str[600];
 	int ok = 0;
 
@@ -410,11 +411,11 @@ int sig_generation(char* key, char* msg, char *signature) {
 			fprintf(stderr, "Can't open input file %s to read the private key \n", key);
 			return (ok); //exit(EXIT_FAILURE);
 		} else {
-			if (fscanf(ifp, "%s", curve) == EOF) {
+			if (fscanf(ifp, "%15s", curve) == EOF) {
 				fprintf(stderr, "Can't get the curve name from file %s \n", key);
 				return (ok); //exit(EXIT_FAILURE);
 			}
-			if (fscanf(ifp, "%s", priv_str) == EOF) {
+			if (fscanf(ifp, "%599s", priv_str) == EOF) {
 				fprintf(stderr, "Can't get the private key from file %s \n", key);
 				return (ok); //exit(EXIT_FAILURE);
 			}
@@ -434,7 +435,8 @@ int sig_generation(char* key, char* msg, char *signature) {
 	// printf("\n");
 
 	// Get and hash message
-	char *dgst = get_dgst_224(msg); //malloc(SHA224_DIGEST_STRING_LENGTH);
+	uchar dgst[SHA224_DIGEST_LENGTH];
+	get_dgst_bin_224(dgst, msg);
 	/*
 	output224[SHA224_DIGEST_STRING_LENGTH] = '\0';
 	FILE *msg_fp = NULL;
@@ -460,8 +462,6 @@ int sig_generation(char* key, char* msg, char *signature) {
 	}*/
 
 	// Sign the message with the private key
-	int digst_len = strlen(dgst);
-	// printf("Digest length is %d !\n", digst_len);
 	mpz_t kinv, rp;
 	mpz_init(kinv); mpz_init(rp);
 
@@ -470,7 +470,7 @@ int sig_generation(char* key, char* msg, char *signature) {
 		return (ok);
 	}
 
-	ecdsa_sig sig = ecdsa_sign(dgst, digst_len, kinv, rp, eckey);
+	ecdsa_sig sig = ecdsa_sign_digest(dgst, sizeof(dgst), kinv, rp, eckey);
 
 	if (sig == NULL) {
 		fprintf(stdout, "Error occurred during generating signature !\n");
@@ -488,7 +488,6 @@ int sig_generation(char* key, char* msg, char *signature) {
 	if (ofp != NULL)
 		fclose(ofp);
 
-	free(dgst);
 	mpz_clear(kinv); mpz_clear(rp);
 
 	ec_key_free(eckey);
@@ -513,7 +512,8 @@ int sig_verification(char* pub_fname, char* msg, char *sig_fname) {
 	FILE *sig_fp = NULL;
 
 	// Get and hash message
-	char *dgst = get_dgst_224(msg); // malloc(SHA224_DIGEST_STRING_LENGTH);
+	uchar dgst[SHA224_DIGEST_LENGTH];
+	get_dgst_bin_224(dgst, msg);
 
 	/*
 	output224[SHA224_DIGEST_STRING_LENGTH] = '\0';
@@ -540,8 +540,6 @@ int sig_verification(char* pub_fname, char* msg, char *sig_fname) {
 	}
 	printf("Message digest is signed is %s \n", output224); */
 
-	int digst_len = strlen(dgst);
-
 	// Open the signature file to read
 	if (sig_fname != NULL ) {
 		sig_fp = fopen(sig_fname, "r");
@@ -557,16 +555,16 @@ int sig_verification(char* pub_fname, char* msg, char *sig_fname) {
 	// // Get and analyze the signature (an ecdsa_sig structure)
 	char str[600];
 	mpz_t R, S;
-	if (fscanf(sig_fp, "%s", str) == EOF) {
+	if (fscanf(sig_fp, "%599s", str) == EOF) {
 		fprintf(stderr, "Can't get the curve name from file %s \n", sig_fname);
 		return (ok);
 	}
-	if (fscanf(sig_fp, "%s", str) == EOF) {
+	if (fscanf(sig_fp, "%599s", str) == EOF) {
 		fprintf(stderr, "Can't get the curve name from file %s \n", sig_fname);
 		return (ok);
 	}
 
-	if (fscanf(sig_fp, "%s", str) == EOF) {
+	if (fscanf(sig_fp, "%599s", str) == EOF) {
 		fprintf(stderr, "Can't get the curve name from file %s \n", sig_fname);
 		return (ok);
 	} else {
@@ -575,7 +573,7 @@ int sig_verification(char* pub_fname, char* msg, char *sig_fname) {
 	}
 
 
-	if (fscanf(sig_fp, "%s", str) == EOF) {
+	if (fscanf(sig_fp, "%599s", str) == EOF) {
 		fprintf(stderr, "EOF of file %s \n", sig_fname);
 		return (ok);
 	} else {
@@ -602,16 +600,16 @@ int sig_verification(char* pub_fname, char* msg, char *sig_fname) {
 			return (ok);
 		} else {
 			char str_X[600], str_Y[600];
-			char curve[9];
-			if (fscanf(pub_fp, "%s", curve) == EOF) {
+			char curve[16];
+			if (fscanf(pub_fp, "%15s", curve) == EOF) {
 				fprintf(stderr, "Can't get the curve name from file %s \n", pub_fname);
 				return (ok);
 			}
-			if (fscanf(pub_fp, "%s", str_X) == EOF) {
+			if (fscanf(pub_fp, "%599s", str_X) == EOF) {
 				fprintf(stderr, "Can't get the curve name from file %s \n", pub_fname);
 				return (ok);
 			}
-			if (fscanf(pub_fp, "%s", str_Y) == EOF) {
+			if (fscanf(pub_fp, "%599s", str_Y) == EOF) {
 				fprintf(stderr, "Can't get the private key from file %s \n", pub_fname);
 				return (ok);
 			}
@@ -638,7 +636,7 @@ int sig_verification(char* pub_fname, char* msg, char *sig_fname) {
 	}
 
 	// Verify the signature with the public key
-	if (ecdsa_verify(dgst, digst_len, sig, group, pubkey)) {
+	if (ecdsa_verify_digest(dgst, sizeof(dgst), sig, group, pubkey) == 1) {
 		fprintf(stdout, "Signature is valid.\n");
 
 		printf("Signature is :\n");
@@ -668,7 +666,6 @@ int sig_verification(char* pub_fname, char* msg, char *sig_fname) {
 	if (pub_fp != NULL)
 		fclose(pub_fp);
 
-	free(dgst);
 	ec_group_free(group);
 	ec_point_free(pubkey);
 
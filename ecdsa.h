@@ -16,6 +16,8 @@
 #include<string.h> /* memset */
 #include<unistd.h> /* close */
 #include<time.h>
+#include<pthread.h>
+#include<stdint.h>
 
 #ifndef uchar
 #define uchar unsigned char // 8-bit byte
@@ -76,6 +78,124 @@ typedef unsigned long long uint64;
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
 #endif
 
+/*
+ * Fixed-width field elements: FE_LIMBS limbs of 64 bits, least significant limb first.
+ * Large enough for every modulus of up to 256 bits, i.e. all built-in curves. An fe_t lives
+ * on the stack, hence the arithmetic in fe_ops.c never calls the allocator.
+ * Elements are kept in Montgomery form a*R mod p, unless the modulus has a special form
+ * (see fe_reduction); fe_from_mpz and fe_to_mpz convert.
+ */
+#if GMP_LIMB_BITS != 64
+#error "fe_t arithmetic requires 64-bit GMP limbs"
+#endif
+
+#define FE_LIMBS	4
+#define FE_BITS		(FE_LIMBS * GMP_LIMB_BITS)
+
+typedef mp_limb_t fe_t[FE_LIMBS];
+
+/*
+ * Reduction method of a fixed-width field. The NIST primes keep the Montgomery form, their
+ * sparse limbs turn each reduction row into shifts and additions; pseudo-Mersenne primes
+ * keep the elements in plain representation.
+ */
+typedef enum {
+	FE_RED_MONTGOMERY = 0,		/* any odd modulus */
+	FE_RED_NIST_P224,			/* p = 2^224 - 2^96 + 1, Montgomery form */
+	FE_RED_NIST_P256,			/* p = 2^256 - 2^224 + 2^192 + 2^96 - 1, Montgomery form */
+	FE_RED_PSEUDO_MERSENNE		/* p = 2^k - c, k = 256 and c < 2^64 (secp256k1) or k = 224 and c < 2^62 (secp224k1) */
+} fe_reduction;
+
+/*
+ * Addition chain of the exponents p - 2 (inversion) and (p + 1) / 4 (square root) of a prime
+ * of known form. Other moduli use a fixed-window exponentiation.
+ */
+typedef enum {
+	FE_CHAIN_GENERIC = 0,		/* fixed window of FE_POW_WINDOW bits */
+	FE_CHAIN_P224,				/* p = 2^224 - 2^96 + 1, p - 2 only since p = 1 mod 4 */
+	FE_CHAIN_P256,				/* p = 2^256 - 2^224 + 2^192 + 2^96 - 1 */
+	FE_CHAIN_K256				/* p = 2^256 - 2^32 - 977, secp256k1 */
+} fe_chain;
+
+/*
+ * Modulus together with the constants needed by the fixed-width arithmetic
+ */
+typedef struct fe_field_st* fe_field;
+
+struct fe_field_st {
+	fe_t p;					/* odd modulus */
+	int size;				/* number of non-zero limbs of p */
+	int bits;				/* bit length of p */
+	fe_reduction red;		/* reduction method */
+	int mont;				/* 1 if the elements are kept in Montgomery form */
+	mp_limb_t n0;			/* -p^-1 mod 2^64 */
+	fe_t r2;				/* R^2 mod p, R = 2^FE_BITS */
+	fe_t one;				/* 1 in the representation of the field, R mod p in Montgomery form */
+	mp_limb_t c;			/* c = 2^bits - p, for FE_RED_PSEUDO_MERSENNE */
+	int64_t p62[FE_LIMBS + 1];	/* p in signed 62-bit limbs, for the inversion */
+	uint64_t pinv62;		/* p^-1 mod 2^62 */
+	fe_chain chain;			/* addition chains of p - 2 and (p + 1) / 4 */
+};
+
+/*
+ * Affine point with fixed-width coordinates, used internally by the scalar multiplications
+ */
+typedef struct ecp_fe_st {
+	fe_t x;
+	fe_t y;
+	int infinity;
+} ecp_fe;
+
+/*
+ * Point with fixed-width Jacobian coordinates, (X : Y : Z) represents (X/Z^2, Y/Z^3).
+ * The point at infinity has Z = 0
+ */
+typedef struct ecp_jac_st {
+	fe_t X;
+	fe_t Y;
+	fe_t Z;
+} ecp_jac;
+
+/*
+ * Point with fixed-width homogeneous projective coordinates, (X : Y : Z) represents (X/Z, Y/Z).
+ * The point at infinity is (0 : 1 : 0), see the complete formulas of ecp_rcb.c
+ */
+typedef struct ecp_hom_st {
+	fe_t X;
+	fe_t Y;
+	fe_t Z;
+} ecp_hom;
+
+/*
+ * Precomputed multiples of the generator of a curve: fixed-base comb table and odd multiples
+ * for the wNAF, see ecp_comb.c. One table is shared by all groups with the same field, A
+ * and generator
+ */
+#define ECP_COMB_TEETH	6
+
+/* Width of the NAF of scalars multiplying the generator, resp. any other point, in the
+ * variable-time multiplications of public scalars (see ecp_wnaf.c) */
+#define ECP_WNAF_G_WINDOW	7
+#define ECP_WNAF_WINDOW		5
+#define ECP_WNAF_MAX_WINDOW	12
+
+/* Width of the signed fixed windows of the constant-time multiplication of secret scalars by any
+ * point, see ecp_jac_wmul */
+#define ECP_SEC_WINDOW		5
+
+typedef struct ecp_comb_st* ecp_comb;
+
+struct ecp_comb_st {
+	mpz_t field, A, Gx, Gy;	/* curve and generator of the table */
+	fe_reduction red;		/* reduction of the field, fixes the representation of the entries */
+	int d;					/* spacing of the teeth, scalars have at most ECP_COMB_TEETH * d bits */
+	ecp_fe table[1 << ECP_COMB_TEETH];	/* table[i] = sum of 2^(j*d) * G over the bits j of i */
+	ecp_fe odd[1 << (ECP_WNAF_G_WINDOW - 2)];	/* odd multiples G, 3G, 5G, ... for the wNAF */
+	int dglv;				/* spacing of the teeth for the halves of a GLV split, 0 without endomorphism */
+	ecp_fe glv[1 << ECP_COMB_TEETH];	/* table with the spacing dglv, see ecp_glv.c */
+	ecp_comb next;
+};
+
 /*
  * Define structure of a curve point in projective coordinates
  * Z = 1 when points represented in affine coordinates
@@ -101,6 +221,29 @@ struct ec_point_st{
 	bool infinity;
 };
 
+/*
+ * Form of the parameter A of a curve, selects the doubling formulas in Jacobian coordinates
+ */
+typedef enum {
+	EC_A_GENERIC = 0,
+	EC_A_MINUS3,			/* A = -3 mod p, e.g. secp224r1, secp256r1 */
+	EC_A_ZERO				/* A = 0, e.g. secp224k1, secp256k1 */
+} ec_a_form;
+
+/*
+ * Endomorphism phi(x, y) = (beta * x, y) = lambda * (x, y) of a curve with A = 0, with the
+ * constants splitting a scalar into two halves (GLV), see ecp_glv.c
+ */
+typedef struct ec_glv_st* ec_glv;
+
+struct ec_glv_st {
+	fe_t beta;				/* cube root of unity of the field, element of fp */
+	fe_t lambda;			/* cube root of unity modulo the order, element of fn */
+	fe_t mb1, mb2;			/* -b1 and -b2 mod order, elements of fn */
+	fe_t g1, g2;			/* plain integers round(2^shift * b2 / order), round(2^shift * -b1 / order) */
+	int shift;				/* FE_BITS + FE_BITS / 2 */
+};
+
 /*
  * Define structure of an elliptic curve E of Weierstrass form: y^2 = x^3 + Ax + B (mod p)
  */
@@ -113,6 +256,31 @@ struct ec_group_st {
 	mpz_t field; /* prime characteristic of the finite field on which E is defined */
 	mpz_t order, cofactor; /* order of the largest subgroup of points and the co-factor of the curve E, that is, #E(Fp) = cofactor * order */
 	ec_point generator; /* generator of the largest subgroup of point, G= (Gx, Gy, Gz)s */
+	fe_reduction red; /* reduction method requested for the field, FE_RED_MONTGOMERY by default */
+	fe_field fp, fn; /* fixed-width arithmetic modulo field and order, NULL if they exceed FE_BITS */
+	fe_t fe_a, fe_b; /* A and B as elements of fp */
+	ec_a_form a_form; /* form of A, set with the fixed-width arithmetic */
+	ec_glv glv; /* endomorphism of the curve, NULL if none is known */
+};
+
+/*
+ * Scratch context of the big-number arithmetic: a stack of preallocated temporaries, used by the
+ * field operations (field_ops.c), the point operations (ec_ops.c, ecp_proj.c) and the signature
+ * instead of allocating their own. A function takes temporaries between ec_ctx_start and
+ * ec_ctx_end, so that the callees can take theirs above them. A context holds no curve.
+ * A context must not be shared between threads: ec_ctx_thread returns the one of the point
+ * operations of the calling thread, ec_ctx_field_thread the one of its field operations.
+ */
+#define EC_CTX_TEMPS	32
+#define EC_CTX_DEPTH	16
+
+typedef struct ec_ctx_st* ec_ctx;
+
+struct ec_ctx_st {
+	mp_bitcnt_t bits;			/* capacity of the temporaries, 2 * bits(field) + 2 limbs */
+	int top, depth;				/* first free temporary and number of open frames */
+	int frame[EC_CTX_DEPTH];	/* value of top at each ec_ctx_start */
+	mpz_t t[EC_CTX_TEMPS];
 };
 
 /*
@@ -222,6 +390,22 @@ int ec_key_check_key(const ec_key key);
 
 int ec_key_check_public_key(ec_point Q, ec_group group);
 
+/** Validates n public keys of a curve with nthreads threads, skipping the order check when
+ *  the cofactor is 1.
+ *  \param  results  array of n results, 1 for the valid keys, or NULL
+ *  \return number of valid keys, -1 on error
+ */
+int ec_key_check_public_keys(ec_point *Q, int n, const ec_group group, int nthreads, int *results);
+
+/** Decompresses and validates n compressed public keys of a curve with nthreads threads,
+ *  e.g. to load a key store.
+ *  \param  Q        array of n initialized points, set to the keys
+ *  \param  zPoints  array of n compressed keys, see ec_point_compress
+ *  \param  results  array of n results, 1 for the valid keys, or NULL
+ *  \return number of valid keys, -1 on error
+ */
+int ec_key_load_public_keys(ec_point *Q, const char **zPoints, int n, const ec_group group, int nthreads, int *results);
+
 /** Creates a table of pre-computed multiples of the generator to
  *  accelerate further EC_KEY operations.
  *  \param  key  EC_KEY object
@@ -253,6 +437,26 @@ struct ecdsa_sig_st {
     mpz_t s;
 };
 
+/* Number of bytes of system entropy seeding the random states of key and nonce generation */
+#define ECS_RAND_SEED_BYTES	32
+
+/*
+ * Pool of precomputed signing nonces (kinv, r) of one key, filled by worker threads.
+ * The pairs are kept in a ring, a pair is removed and wiped when handed out, so it is used once.
+ */
+typedef struct ecs_pool_st* ecs_pool;
+
+struct ecs_pool_st {
+	ec_key key;					/* own copy of the signing key */
+	mpz_t *kinv, *r;			/* ring of size precomputed pairs */
+	int size, head, count;		/* capacity, oldest pair and number of pairs available */
+	int nworkers, stop;
+	pthread_t *workers;
+	pthread_mutex_t lock;
+	pthread_cond_t filled;		/* signaled when a pair is added */
+	pthread_cond_t drained;		/* signaled when a pair is removed */
+};
+
 
 /********************************************************************/
 /* 						ECDSA functions								*/
@@ -304,6 +508,48 @@ void ecs_print_fp(FILE *fp, ecdsa_sig sig);
  */
 int ecdsa_sign_setup(const ec_key eckey, mpz_t kinv, mpz_t rp);
 
+/** Initialize a random state seeded from /dev/urandom
+ *  \param  state  random state, released with gmp_randclear
+ *  \return 1 on success and 0 otherwise
+ */
+int ecs_rand_init(gmp_randstate_t state);
+
+/** Converts a hash value to the integer e of the signature: its leftmost bits, as many as the
+ *  bits of the order (FIPS 186-4, 6.4)
+ *  \param  e      big number, initialized
+ *  \param  dgst   hash value, as bytes or in hexadecimal
+ *  \param  len    length of dgst in bytes
+ *  \param  group  curve of the signature
+ *  \return ecdsa_hex_to_mpz returns 1 on success and 0 if dgst is not hexadecimal
+ */
+void ecdsa_dgst_to_mpz(mpz_t e, const uint8_t *dgst, size_t len, const ec_group group);
+int ecdsa_hex_to_mpz(mpz_t e, const char *dgst, const ec_group group);
+
+/** Creates a pool of precomputed (kinv, r) pairs for eckey, filled by background threads
+ *  \param  eckey     EC_KEY object containing a private EC key, copied by the pool
+ *  \param  size      number of pairs kept ready
+ *  \param  nworkers  number of threads running ecdsa_sign_setup, at least 1
+ *  \return pointer to a ecs_pool structure or NULL if an error occurred
+ */
+ecs_pool ecs_pool_init(const ec_key eckey, int size, int nworkers);
+
+/** Stops the threads of a pool, wipes the pairs not used and frees the pool
+ *  \param  pool  pointer to the ecs_pool structure
+ */
+void ecs_pool_free(ecs_pool pool);
+
+/** Removes a precomputed pair from the pool, waiting for one if the pool is empty.
+ *  The pool keeps no copy of the pair, which must be used for a single signature.
+ *  \param  pool  pointer to the ecs_pool structure
+ *  \param  kinv  mpz_t for the inverse of k
+ *  \param  rp    mpz_t for the x coordinate of k * generator
+ *  \return 1 on success and 0 otherwise
+ */
+int ecs_pool_get(ecs_pool pool, mpz_t kinv, mpz_t rp);
+
+/** Returns the number of pairs ready in the pool */
+int ecs_pool_available(ecs_pool pool);
+
 /** Computes the ECDSA signature of the given hash value using
  *  the supplied private key and returns the created signature.
  *  \param  dgst      pointer to the hash value
@@ -315,6 +561,26 @@ int ecdsa_sign_setup(const ec_key eckey, mpz_t kinv, mpz_t rp);
  */
 ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t kinv, const mpz_t rp, const ec_key eckey);
 
+/** Computes the ECDSA signature of a hash value given as bytes, truncated to the bit length of
+ *  the order as in FIPS 186-4.
+ *  \param  dgst      pointer to the hash value
+ *  \param  len       length of the hash value in bytes
+ *  \param  kinv      BIGNUM with a pre-computed inverse k (optional)
+ *  \param  rp        BIGNUM with a pre-computed rp value (optional)
+ *  \param  eckey     EC_KEY object containing a private EC key
+ *  \return pointer to a ECDSA_SIG structure or NULL if an error occurred
+ */
+ecdsa_sig ecdsa_sign_digest(const uint8_t *dgst, size_t len, const mpz_t kinv, const mpz_t rp, const ec_key eckey);
+
+/** Computes the ECDSA signature of the given hash value with the key of pool and a
+ *  precomputed pair taken from it.
+ *  \param  dgst      pointer to the hash value
+ *  \param  dgst_len  length of the hash value
+ *  \param  pool      pool of precomputed pairs, see ecs_pool_init
+ *  \return pointer to a ECDSA_SIG structure or NULL if an error occurred
+ */
+ecdsa_sig ecdsa_sign_pool(const char *dgst, int dgst_len, ecs_pool pool);
+
 /** Verifies that the given signature is valid ECDSA signature
  *  of the supplied hash value using the specified public key.
  *  \param  dgst     pointer to the hash value
@@ -326,6 +592,58 @@ ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t kinv, const mpz
  */
 int ecdsa_verify(const char *dgst, int dgstlen, const ecdsa_sig sig, ec_group group, ec_point pub_key);
 
+/** Verifies a signature of a hash value given as bytes, truncated to the bit length of the order
+ *  as in FIPS 186-4. Like ecdsa_verify, group and pub_key are released.
+ *  \param  dgst     pointer to the hash value
+ *  \param  len      length of the hash value in bytes
+ *  \param  sig      pointer to the ecdsa_sig structure
+ *  \param  group    curve of the public key
+ *  \param  pub_key  public key
+ *  \return 1 if the signature is valid, 0 if the signature is invalid
+ *          and -1 on error
+ */
+int ecdsa_verify_digest(const uint8_t *dgst, size_t len, const ecdsa_sig sig, ec_group group, ec_point pub_key);
+
+/** Verifies a batch of ECDSA signatures on the same curve, sharing the modular inversions and
+ *  the precomputations between them. This is the high-throughput path of the verifier.
+ *  \param  dgst     array of n hash values, in hexadecimal
+ *  \param  sig      array of n ecdsa_sig structures
+ *  \param  group    curve of all public keys
+ *  \param  pub_key  array of n public keys
+ *  \param  n        number of signatures
+ *  \param  results  array of n results, 1 if the signature is valid, 0 if the signature is
+ *                   invalid and -1 on error
+ *  \return number of valid signatures, -1 on error
+ */
+int ecdsa_verify_batch(const char **dgst, const ecdsa_sig *sig, const ec_group group,
+		const ec_point *pub_key, int n, int *results);
+
+/********************************************************************/
+/* 						Memory functions							*/
+/********************************************************************/
+
+/** Installs a thread-local arena as the allocator of GMP, for the small numbers of the curves
+ *  (224 to 521 bits). Blocks are zeroed when they are released. Optional: it must be called
+ *  before any other function of GMP or of this library, see mp_set_memory_functions.
+ */
+void ec_arena_enable(void);
+
+/** Returns 1 if the arena allocator is installed */
+int ec_arena_is_enabled(void);
+
+/** Sets whether the numbers allocated next by the calling thread go to malloc instead of the
+ *  arena, for numbers living across operations (scratch contexts). Returns the previous setting
+ */
+int ec_arena_outside(int on);
+
+/** Returns the bump offset of the arena of the calling thread, 0 if it has no chunk yet */
+size_t ec_arena_used(void);
+
+/** Reset point of the arena of the calling thread, at the end of a signature or a verification.
+ *  No effect if the arena is not installed.
+ */
+void ec_arena_reset(void);
+
 
 
 
@@ -114,6 +114,51 @@ int ec_key_check_key(const ec_key eckey) {
 
 }
 
+/* Return 1 if Q, a point of the curve, has the order of the group. With cofactor 1 every point
+ * of the curve but the infinity has that order, and the multiplication is skipped */
+static int ec_key_has_group_order(const ec_point Q, const ec_group group) {
+	ec_point tmp;
+	int ok;
+
+	if (mpz_cmp_ui(group->cofactor, 1) == 0)
+		return 1;
+
+	/* Q is public, the variable-time multiplication is enough. The order is not reduced by the
+	 * GLV split, see ecp_wnaf_mul, so Q need not be in the subgroup */
+	tmp = ecp_mul_wnaf(Q, group->order, 0, group);
+	ok = tmp->infinity;
+	ec_point_free(tmp);
+	return ok;
+}
+
+/* Return NULL if Q is a valid public key of group, otherwise the reason of the failure */
+static const char* ec_key_public_key_error(const ec_point Q, const ec_group group) {
+
+	if (!group || !Q)
+		return "Point or group provide is NULL !";
+
+	/* Check that Q <> point-at-infinity */
+	if (ec_point_is_at_infinity(Q))
+		return "Q is a POINT_AT_INFINITY !";
+
+	/* Check that Q_x, Q_y are properly represented of F_q, i.e. in [0, p-1] */
+	if (mpz_sgn(Q->x) < 0 || mpz_cmp(Q->x, group->field) >= 0 ||
+			mpz_sgn(Q->y) < 0 || mpz_cmp(Q->y, group->field) >= 0)
+		return "Q is not defined in Fp !";
+
+	/* Check whether Q is on the elliptic curve */
+	if (!ec_point_is_on_curve(Q, group))
+		return "Q is NOT_ON_CURVE";
+
+	/** Check whether the order of the public key is the same the order of group
+	 * 	That is, order * Q = point_at_infinity
+	 */
+	if (!ec_key_has_group_order(Q, group))
+		return "Q has NOT_ORDER_CURVE";
+
+	return NULL;
+}
+
 /**	Check the validation of an ECDSA public key
  * 	\param Q	pointer to an ec point structure
  * 	\param ec	pointer to an ec_group structure
@@ -122,53 +167,124 @@ int ec_key_check_key(const ec_key eckey) {
  */
 
 int ec_key_check_public_key(ec_point Q, ec_group group) {
+	const char* error = ec_key_public_key_error(Q, group);
 
-	int ok = 0;
-
-	if (!group || !Q) {
-		fprintf(stdout, "Public key validation. Point or group provide is NULL !\n");
-		return (ok);
+	if (error != NULL) {
+		fprintf(stdout, "Public key validation. %s\n", error);
+		return 0;
 	}
 
-	/* Check that Q <> point-at-infinity */
-	if (ec_point_is_at_infinity(Q)) {
-		fprintf(stdout, "Public key validation. Q is a POINT_AT_INFINITY !\n");
-		return (ok);
+	return 1;
+}
+
+/* Slice of a set of public keys, handled by one thread */
+typedef struct {
+	ec_point *Q;
+	const char **zPoints;	/* compressed keys, NULL if Q is already set */
+	int n;
+	ec_group group;
+	int *results;
+	int valid;
+} eck_bulk_job;
+
+static void *ec_key_bulk_worker(void *arg) {
+	eck_bulk_job *job = arg;
+	int i;
+
+	/* decompression checks the range of x and that the point is on the curve */
+	if (job->zPoints != NULL)
+		ec_point_decompress_batch(job->Q, job->zPoints, job->n, job->group, job->results);
+
+	job->valid = 0;
+	for (i = 0; i < job->n; i++) {
+		if (job->zPoints == NULL)
+			job->results[i] = (ec_key_public_key_error(job->Q[i], job->group) == NULL);
+		else if (job->results[i])
+			job->results[i] = ec_key_has_group_order(job->Q[i], job->group);
+		job->valid += job->results[i];
 	}
+	return NULL;
+}
 
-	/* Check that Q_x, Q_y are properly represented of F_q */
+/* Split the n keys between nthreads threads, the calling thread takes a slice too */
+static int ec_key_bulk_run(ec_point *Q, const char **zPoints, int n, const ec_group group, int nthreads, int *results) {
+	eck_bulk_job *jobs;
+	pthread_t *threads;
+	int *started, *res;
+	int i, valid = 0;
 
-	mpz_t one; mpz_init(one);
-	mpz_set_ui(one, 1);
-	if(	mpz_cmp(Q->x,one) < 0 && mpz_cmp(group->order, Q->x) <= 0 &&
-			mpz_cmp(Q->y, one) < 0 && mpz_cmp(group->order, Q->y) <= 0) {
-		fprintf(stdout, "Point Q is not defined in Fp !\n");
-		mpz_clear(one);
-		return (ok);
+	if (Q == NULL || group == NULL || n < 0) {
+		fprintf(stdout, "EC_F_EC_KEY_CHECK_PUBLIC_KEYS, ERR_R_PASSED_NULL_PARAMETER");
+		return -1;
 	}
-	mpz_clear(one);
-
-	/* Check whether Q is on the elliptic curve */
-	if (!ec_point_is_on_curve(Q, group)) {
-		fprintf(stdout, "Public key validation. Q is NOT_ON_CURVE \n");
-		return (ok);
+	if (nthreads < 1)
+		nthreads = 1;
+	if (nthreads > n)
+		nthreads = n > 0 ? n : 1;
+
+	jobs = malloc(nthreads * sizeof(eck_bulk_job));
+	threads = malloc(nthreads * sizeof(pthread_t));
+	started = calloc(nthreads, sizeof(int));
+	res = (results != NULL) ? results : malloc((n > 0 ? n : 1) * sizeof(int));
+	assert(jobs != NULL && threads != NULL && started != NULL && res != NULL);
+
+	for (i = 0; i < nthreads; i++) {
+		int lo = (int) ((long) n * i / nthreads), hi = (int) ((long) n * (i + 1) / nthreads);
+		jobs[i].Q = Q + lo;
+		jobs[i].zPoints = (zPoints != NULL) ? zPoints + lo : NULL;
+		jobs[i].n = hi - lo;
+		jobs[i].group = group;
+		jobs[i].results = res + lo;
+		jobs[i].valid = 0;
 	}
 
-	/** Check whether the order of the public key is the same the order of group
-	 * 	That is, order * Q = point_at_infinity
-	 */
-	ec_point tmp = ecp_mul_atomic(Q, group->order, group);
-	if (!tmp->infinity) {
-		fprintf(stdout, "Public key validation. Q has NOT_ORDER_CURVE \n");
-		ec_point_free(tmp);
-		return (ok);
+	/* slices whose thread cannot be created are done by the calling thread */
+	for (i = 1; i < nthreads; i++)
+		started[i] = (pthread_create(&threads[i], NULL, ec_key_bulk_worker, &jobs[i]) == 0);
+	for (i = 0; i < nthreads; i++)
+		if (!started[i])
+			ec_key_bulk_worker(&jobs[i]);
+	for (i = 0; i < nthreads; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		valid += jobs[i].valid;
 	}
 
-	ec_point_free(tmp);
-
-    ok = 1;
-
-	return (ok);
+	if (res != results)
+		free(res);
+	free(jobs); free(threads); free(started);
+	return valid;
 }
 
+/**	Validates a set of public keys of the same curve, as ec_key_check_public_key does, with
+ *	nthreads threads. The order check is skipped when the cofactor is 1.
+ * 	\param Q			array of n pointers to ec_point structures
+ * 	\param n			number of keys
+ * 	\param group		pointer to an ec_group structure
+ * 	\param nthreads		number of threads, 1 to work in the calling thread only
+ * 	\param results		array of n results, 1 for the valid keys and 0 otherwise, or NULL
+ * 	\return 			number of valid keys, -1 on error
+ */
+int ec_key_check_public_keys(ec_point *Q, int n, const ec_group group, int nthreads, int *results) {
+	return ec_key_bulk_run(Q, NULL, n, group, nthreads, results);
+}
 
+/**	Loads a set of compressed public keys of the same curve: decompresses them with
+ *	ec_point_decompress and validates them, with nthreads threads. A key is valid if it
+ *	decompresses to a point of the curve with the order of the group; the order check is
+ *	skipped when the cofactor is 1, as for all built-in curves.
+ * 	\param Q			array of n pointers to initialized ec_point structures, set to the keys
+ * 	\param zPoints		array of n compressed keys, see ec_point_compress
+ * 	\param n			number of keys
+ * 	\param group		pointer to an ec_group structure
+ * 	\param nthreads		number of threads, 1 to work in the calling thread only
+ * 	\param results		array of n results, 1 for the valid keys and 0 otherwise, or NULL
+ * 	\return 			number of valid keys, -1 on error
+ */
+int ec_key_load_public_keys(ec_point *Q, const char **zPoints, int n, const ec_group group, int nthreads, int *results) {
+	if (zPoints == NULL) {
+		fprintf(stdout, "EC_F_EC_KEY_LOAD_PUBLIC_KEYS, ERR_R_PASSED_NULL_PARAMETER");
+		return -1;
+	}
+	return ec_key_bulk_run(Q, zPoints, n, group, nthreads, results);
+}
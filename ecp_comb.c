@@ -0,0 +1,241 @@
+/*
+ * ecp_comb.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include <pthread.h>
+
+#include "ecdsa.h"
+#include "ec.h"
+#include "ec_point.h"
+#include "fe_ops.h"
+
+/*-
+ * Fixed-base comb (Lim-Lee) for multiples of the generator.
+ *
+ * The scalar k of at most ECP_COMB_TEETH * d bits is written as ECP_COMB_TEETH rows of d bits,
+ * column c gathers the bits k_{j*d + c}, j = 0 .. ECP_COMB_TEETH - 1, into the index of the
+ * table entry sum_j k_{j*d + c} * 2^(j*d) * G. Then
+ * k * G = sum_c 2^c * table[column c],
+ * computed with d doublings and d mixed additions instead of about bits doublings and additions.
+ *
+ * The same structure holds the odd multiples of G used by the wNAF multiplications of public
+ * scalars (ecp_wnaf.c) and, on curves with a GLV endomorphism (ecp_glv.c), a second table of
+ * spacing about half of d for the two halves of a split scalar.
+ *
+ * A table only depends on the curve and its generator, so it is built once and shared by all
+ * groups with the same parameters, through a registry protected by a mutex. Tables live until
+ * the end of the process.
+ */
+
+static ecp_comb comb_registry = NULL;
+static pthread_mutex_t comb_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Return 1 if the table comb was built for the curve and generator of ec */
+static int ecp_comb_match(const ecp_comb comb, const ec_group ec) {
+	return comb->red == ec->fp->red && !mpz_cmp(comb->field, ec->field) && !mpz_cmp(comb->A, ec->A)
+			&& !mpz_cmp(comb->Gx, ec->generator->x) && !mpz_cmp(comb->Gy, ec->generator->y);
+}
+
+/* table[i] = sum of 2^(j*d) * P over the bits j of i, i < 2^ECP_COMB_TEETH */
+static void ecp_comb_fill(ecp_fe *table, const ecp_fe *P, int d, const ec_group ec) {
+	ecp_jac G[ECP_COMB_TEETH], T;
+	int i, j;
+
+	/* G[j] = 2^(j*d) * P */
+	ecp_jac_set_affine(&G[0], P, ec);
+	for (j = 1; j < ECP_COMB_TEETH; j++) {
+		G[j] = G[j - 1];
+		for (i = 0; i < d; i++)
+			ecp_jac_dbl(&G[j], &G[j], ec);
+	}
+
+	/* table[i] = table[i - 2^j] + G[j], 2^j being the top bit of i */
+	table[0].infinity = 1;
+	fe_set_zero(table[0].x);
+	fe_set_zero(table[0].y);
+	for (j = 0; j < ECP_COMB_TEETH; j++) {
+		for (i = 1 << j; i < 2 << j; i++) {
+			ecp_jac_set_affine(&T, &table[i - (1 << j)], ec);
+			ecp_jac_add(&T, &T, &G[j], ec);
+			ecp_jac_get_affine(&table[i], &T, ec);
+		}
+	}
+}
+
+/* Build the table of ec, for scalars up to one bit longer than the order */
+static ecp_comb ecp_comb_build(const ec_group ec) {
+	ecp_fe g;
+	ecp_comb comb;
+
+	comb = malloc(sizeof(struct ecp_comb_st));
+	assert(comb != NULL);
+
+	comb->red = ec->fp->red;
+	mpz_init_set(comb->field, ec->field);
+	mpz_init_set(comb->A, ec->A);
+	mpz_init_set(comb->Gx, ec->generator->x);
+	mpz_init_set(comb->Gy, ec->generator->y);
+	comb->d = (mpz_sizeinbase(ec->order, 2) + ECP_COMB_TEETH) / ECP_COMB_TEETH;
+
+	ecp_fe_set_point(&g, ec->generator, ec);
+	ecp_comb_fill(comb->table, &g, comb->d, ec);
+
+	/* with an endomorphism, a second table for the halves of the GLV split, of FE_BITS / 2 bits */
+	comb->dglv = 0;
+	if (ec->glv != NULL) {
+		comb->dglv = (FE_BITS / 2 + ECP_COMB_TEETH - 1) / ECP_COMB_TEETH;
+		ecp_comb_fill(comb->glv, &g, comb->dglv, ec);
+	}
+
+	/* odd multiples of G for the wNAF of public scalars */
+	ecp_wnaf_odd_multiples(comb->odd, &g, 1 << (ECP_WNAF_G_WINDOW - 2), ec);
+
+	comb->next = NULL;
+	return comb;
+}
+
+/** Return the comb table of the generator of ec, building it on first use.
+ *	\param ec	pointer to an ec_group structure
+ *	\return		the shared table or NULL if ec has no fixed-width arithmetic
+ */
+ecp_comb ecp_comb_get(const ec_group ec) {
+	ecp_comb comb;
+
+	if (ec == NULL || ec->fp == NULL || ec->generator == NULL || ec->generator->infinity)
+		return NULL;
+
+	pthread_mutex_lock(&comb_lock);
+	for (comb = comb_registry; comb != NULL; comb = comb->next)
+		if (ecp_comb_match(comb, ec))
+			break;
+	if (comb == NULL) {
+		comb = ecp_comb_build(ec);
+		comb->next = comb_registry;
+		comb_registry = comb;
+	}
+	pthread_mutex_unlock(&comb_lock);
+
+	return comb;
+}
+
+/* Index in the table of the column c of the plain integer k, of spacing d */
+static unsigned int ecp_comb_column(const mp_limb_t *k, int d, int c) {
+	unsigned int idx = 0;
+	int j, b;
+
+	for (j = 0; j < ECP_COMB_TEETH; j++) {
+		b = j * d + c;
+		idx |= (unsigned int) ((k[b / GMP_LIMB_BITS] >> (b % GMP_LIMB_BITS)) & 1) << j;
+	}
+	return idx;
+}
+
+/* R = scalar * G = k1 * G + k2 * phi(G) with the GLV split of scalar: both halves share the
+ * dglv doublings, phi(table[i]) = lambda * table[i] costs a multiplication by beta */
+static void ecp_comb_mul_glv(ecp_jac *R, const ecp_comb comb, const mpz_t scalar, const ec_group ec) {
+	fe_t k1, k2;
+	int neg1, neg2, c;
+	ecp_fe T;
+
+	ec_glv_split(k1, &neg1, k2, &neg2, scalar, ec);
+
+	memset(&T, 0, sizeof(ecp_fe));
+	ecp_jac_set_infinity(R, ec);
+	for (c = comb->dglv - 1; c >= 0; c--) {
+		ecp_jac_dbl(R, R, ec);
+
+		ecp_fe_lookup(&T, comb->glv, 1 << ECP_COMB_TEETH, ecp_comb_column(k1, comb->dglv, c));
+		ecp_fe_cneg(&T, neg1, ec);
+		ecp_jac_add_mixed(R, R, &T, ec);
+
+		ecp_fe_lookup(&T, comb->glv, 1 << ECP_COMB_TEETH, ecp_comb_column(k2, comb->dglv, c));
+		ecp_glv_endo(&T, &T, ec);
+		ecp_fe_cneg(&T, neg2, ec);
+		ecp_jac_add_mixed(R, R, &T, ec);
+	}
+	fe_set_zero(k1);
+	fe_set_zero(k2);
+}
+
+/** Compute R = scalar * G with the comb table of G. The columns are read from scalar copied to
+ *	FE_LIMBS + 1 limbs and the table entries, the point at infinity included, are selected with
+ *	conditional moves: the sequence of operations and of memory accesses only depends on the
+ *	table, apart from the exceptional additions of a point to itself or to its opposite, of
+ *	negligible probability for a random scalar. On curves with a GLV endomorphism, scalar is
+ *	split in halves sharing the doublings of a comb of half the spacing.
+ *	Require: scalar has at most ECP_COMB_TEETH * comb->d bits
+ *	\param R		result in Jacobian coordinates
+ *	\param comb		table returned by ecp_comb_get(ec)
+ *	\param scalar	non-negative big number
+ *	\param ec		pointer to an ec_group structure
+ */
+void ecp_comb_mul(ecp_jac *R, const ecp_comb comb, const mpz_t scalar, const ec_group ec) {
+	mp_limb_t k[FE_LIMBS + 1];
+	ecp_fe T;
+	int c, i;
+
+	if (comb->dglv > 0 && ec->glv != NULL) {
+		ecp_comb_mul_glv(R, comb, scalar, ec);
+		return;
+	}
+
+	for (i = 0; i <= FE_LIMBS; i++)
+		k[i] = mpz_getlimbn(scalar, i);
+
+	memset(&T, 0, sizeof(ecp_fe));
+	ecp_jac_set_infinity(R, ec);
+	for (c = comb->d - 1; c >= 0; c--) {
+		ecp_jac_dbl(R, R, ec);
+
+		ecp_fe_lookup(&T, comb->table, 1 << ECP_COMB_TEETH, ecp_comb_column(k, comb->d, c));
+		ecp_jac_add_mixed(R, R, &T, ec);
+	}
+	memset(k, 0, sizeof(k));
+}
+
+/**	Compute scalar * G, G the generator of ec, with the shared comb table.
+ *	Falls back to the fixed-window ec_sec_wmul for groups without a table and longer scalars.
+ * 	\param scalar	non-negative big number, at most one bit longer than the order
+ * 	\param ec		pointer to an ec_group structure
+ * 	\return 		pointer to an ec_point structure
+ */
+ec_point ecp_mul_base(const mpz_t scalar, ec_group ec) {
+	ecp_comb comb = ecp_comb_get(ec);
+	ec_point Rop;
+	ecp_jac R;
+	ecp_fe Ra;
+
+	if (comb == NULL || mpz_sizeinbase(scalar, 2) > ECP_COMB_TEETH * comb->d)
+		return ec_sec_wmul(ec->generator, scalar, ec);
+
+	Rop = ec_point_init();
+	ecp_comb_mul(&R, comb, scalar, ec);
+	ecp_jac_get_affine(&Ra, &R, ec);
+	ecp_fe_get_point(Rop, &Ra, ec);
+	return Rop;
+}
+
+/**	Compute k * G + l * Q, G the generator of ec, with interleaved wNAF and one inversion.
+ *	The odd multiples of G come from the shared table. Variable time, for public scalars.
+ * 	\return 		pointer to an ec_point structure
+ */
+ec_point ecp_mul2_base(const mpz_t k, const ec_point Q, const mpz_t l, ec_group ec) {
+	ecp_comb comb = ecp_comb_get(ec);
+	ecp_fe Qa, Ra, TQ[1 << (ECP_WNAF_WINDOW - 2)];
+	ec_point Rop;
+	ecp_jac R;
+
+	if (comb == NULL || mpz_sizeinbase(k, 2) > FE_BITS || mpz_sizeinbase(l, 2) > FE_BITS)
+		return ecp_mul2_proj(ec->generator, k, Q, l, ec);
+
+	Rop = ec_point_init();
+	ecp_fe_set_point(&Qa, Q, ec);
+	ecp_wnaf_odd_multiples(TQ, &Qa, 1 << (ECP_WNAF_WINDOW - 2), ec);
+	ecp_wnaf_mul2(&R, k, comb->odd, ECP_WNAF_G_WINDOW, l, TQ, ECP_WNAF_WINDOW, ec);
+	ecp_jac_get_affine(&Ra, &R, ec);
+	ecp_fe_get_point(Rop, &Ra, ec);
+	return Rop;
+}
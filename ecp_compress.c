@@ -10,46 +10,93 @@
 #include "field_ops.h"
 
 
-/** Decompress a point from hex string
- * 	\param P		pointer to an ec_point structure
- * 	\param xP		hex string of compressed point P
- * 	\param group	pointer to an ec_group
- */
-void ec_point_decompress(ec_point P, char* xP, ec_group group) {
-	// Initialize variables
-	mpz_t x, a, b, t1, t2;
-	mpz_init(x); mpz_init(a); mpz_init(b);
-	mpz_init(t1); mpz_init(t2);
+/* Decompress xP into P with the temporaries x, a, b, t. Return 1 if xP is a valid point */
+static int ec_point_decompress_with(ec_point P, const char* xP, ec_group group, mpz_t x, mpz_t a, mpz_t b, mpz_t t) {
+	int odd;
 
-	//Get x coordinate
-	mpz_set_str(x, xP + 2, 16);
+	//Prefix 02 for an even y, 03 for an odd y
+	if (xP == NULL || xP[0] != '0' || (xP[1] != '2' && xP[1] != '3') || xP[2] == '\0')
+		return 0;
+	odd = (xP[1] == '3');
+
+	//Get x coordinate, 0 <= x < p
+	if (mpz_set_str(x, xP + 2, 16) != 0 || mpz_sgn(x) < 0 || mpz_cmp(x, group->field) >= 0)
+		return 0;
 
 	//alpha = x^3+a*x+b mod p
-	//number_theory_exp_modp_ui(t1, x, 3, ec->p);//t1 = x^3 mod p
-	mpz_mul(t1, x, x);
-	mod_mul(t1, t1, x, group->field);
-	mod_mul(t2, x, group->A, group->field);		//t3 = a*x mod p
-	mod_addadd(a, t1, t2, group->B, group->field);
+	mpz_mul(a, x, x);
+	mod_mul(a, a, x, group->field);
+	mod_mul(t, x, group->A, group->field);		//t = a*x mod p
+	mod_addadd(a, a, t, group->B, group->field);
 
-	// b = sqrt(a) mod p
-	mod_sqrt(b, a, group->field);
+	// b = sqrt(alpha) mod p, x is not on the curve if alpha is not a square
+	if (!ec_field_sqrt(b, a, group))
+		return 0;
 
-	//Get y mod 2 from input
-	mpz_set_ui(t2, xP[1] == '2' ? 0 : 1);
+	//y = beta if beta has the parity of the prefix, p - beta otherwise; 0 has no odd root
+	if (mpz_sgn(b) == 0 && odd)
+		return 0;
+	if (mpz_odd_p(b) != odd)
+		mpz_sub(b, group->field, b);
 
-	//Set x
 	mpz_set(P->x, x);
+	mpz_set(P->y, b);
+	P->infinity = 0;
+
+	return ec_point_is_on_curve(P, group);
+}
+
+/** Decompress a point from hex string, 02 or 03 followed by x (SEC 1, 2.3.4),
+ *	and check that the point is on the curve
+ * 	\param P		pointer to an ec_point structure
+ * 	\param xP		hex string of compressed point P
+ * 	\param group	pointer to an ec_group
+ * 	\return 		1 on success, 0 if xP is not a compressed point of the curve
+ */
+int ec_point_decompress(ec_point P, const char* xP, ec_group group) {
+	// Initialize variables
+	mpz_t x, a, b, t;
+	int ok;
+
+	if (P == NULL || group == NULL)
+		return 0;
 
-	//t2 = beta mod p
-	mpz_mod_ui(t1, b, 2);
-	if(mpz_cmp(t1, t2))
-		mpz_set(P->y, b);	//y = beta
-	else
-		mpz_sub(P->y, group->field, b);//y = p -beta
+	mpz_init(x); mpz_init(a); mpz_init(b); mpz_init(t);
+	ok = ec_point_decompress_with(P, xP, group, x, a, b, t);
 
 	// Release variables
-	mpz_clear(x); mpz_clear(a); mpz_clear(b);
-	mpz_clear(t1); mpz_clear(t2);
+	mpz_clear(x); mpz_clear(a); mpz_clear(b); mpz_clear(t);
+	return ok;
+}
+
+/** Decompress n points of the same curve, e.g. a set of public keys. The temporaries are
+ *	shared by all points, and the square roots use the addition chain of the field.
+ * 	\param P		array of n pointers to ec_point structures
+ * 	\param xP		array of n hex strings of compressed points
+ * 	\param n		number of points
+ * 	\param group	pointer to an ec_group
+ * 	\param results	array of n results, 1 if P[i] was decompressed and 0 otherwise, or NULL
+ * 	\return 		number of valid points, -1 on error
+ */
+int ec_point_decompress_batch(ec_point *P, const char **xP, int n, ec_group group, int *results) {
+	mpz_t x, a, b, t;
+	int i, ok, valid = 0;
+
+	if (P == NULL || xP == NULL || group == NULL || n < 0) {
+		fprintf(stdout, "ECDSA_F_EC_POINT_DECOMPRESS_BATCH, ERR_R_PASSED_NULL_PARAMETER");
+		return -1;
+	}
+
+	mpz_init(x); mpz_init(a); mpz_init(b); mpz_init(t);
+	for (i = 0; i < n; i++) {
+		ok = (P[i] != NULL) && ec_point_decompress_with(P[i], xP[i], group, x, a, b, t);
+		if (results != NULL)
+			results[i] = ok;
+		valid += ok;
+	}
+	mpz_clear(x); mpz_clear(a); mpz_clear(b); mpz_clear(t);
+
+	return valid;
 }
 
 /** Compress a point to hex string
@@ -66,19 +113,12 @@ char* ec_point_compress(ec_point P) {
 
 	char* result = (char*)malloc(len + 1);
 	result[len] = '\0';
-	mpz_t t1; mpz_init(t1);
 
 	//Add x coordinate in hex to result
 	mpz_get_str(result + 2, 16, P->x);
 
-	//Determine if it's odd or even
-	mpz_mod_ui(t1, P->y, 2);
-	if(mpz_cmp_ui(t1, 0))
-		strncpy(result, "02", 2);
-	else
-		strncpy(result, "03", 2);
-
-	mpz_clear(t1);
+	//02 if y is even, 03 if y is odd
+	memcpy(result, mpz_odd_p(P->y) ? "03" : "02", 2);
 
 	return result;
 }
@@ -7,7 +7,47 @@
 
 #include "ecdsa.h"
 #include "ec_point.h"
+#include "fe_ops.h"
 
+void ecp_fe_set_point(ecp_fe *R, const ec_point P, const ec_group ec) {
+	R->infinity = P->infinity;
+	if (P->infinity) {
+		fe_set_zero(R->x);
+		fe_set_zero(R->y);
+	} else {
+		fe_from_mpz(R->x, P->x, ec->fp);
+		fe_from_mpz(R->y, P->y, ec->fp);
+	}
+}
 
+void ecp_fe_get_point(ec_point R, const ecp_fe *P, const ec_group ec) {
+	if (P->infinity)
+		ec_point_set_at_infinity(R);
+	else {
+		fe_to_mpz(R->x, P->x, ec->fp);
+		fe_to_mpz(R->y, P->y, ec->fp);
+		R->infinity = false;
+	}
+}
 
+/** Copy T[idx] to R, reading all the n entries so that the access pattern does not depend on idx
+ *	\param T	table of n affine points
+ */
+void ecp_fe_lookup(ecp_fe *R, const ecp_fe *T, int n, unsigned int idx) {
+	unsigned int i, flag;
+
+	for (i = 0; i < (unsigned int) n; i++) {
+		flag = ((i ^ idx) - 1) >> (sizeof(unsigned int) * 8 - 1);
+		fe_cmov(R->x, T[i].x, flag);
+		fe_cmov(R->y, T[i].y, flag);
+		R->infinity ^= (R->infinity ^ T[i].infinity) & (0 - flag);
+	}
+}
+
+/** Negate R if flag = 1, leave it unchanged if flag = 0, in data-independent time */
+void ecp_fe_cneg(ecp_fe *R, int flag, const ec_group ec) {
+	fe_t y;
 
+	fe_neg(y, R->y, ec->fp);
+	fe_cmov(R->y, y, flag);
+}
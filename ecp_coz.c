@@ -0,0 +1,197 @@
+/*
+ * ecp_coz.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+#include "ec_point.h"
+#include "fe_ops.h"
+
+/*-
+ * Montgomery ladder with co-Z addition formulas (Meloni; Goundar, Joye, Miyaji; Rivain,
+ * "Fast and regular algorithms for scalar multiplication over elliptic curves", 2011).
+ *
+ * The two points of the ladder R0 = j * P and R1 = (j + 1) * P are kept in Jacobian coordinates
+ * with the same Z, which is never computed: only X and Y are stored. Two points sharing Z are
+ * added with 5 multiplications and 2 squarings (XYCZ-ADD), which also rescales the first input to
+ * the Z of the sum; XYCZ-ADDC returns both the sum and the difference for 6M + 3S. A bit of the
+ * ladder is one XYCZ-ADDC and one XYCZ-ADD, the same for both values of the bit, which only
+ * selects the operands with conditional swaps.
+ *
+ * At the end, the difference R_b - R_(1-b) = +-P is known both in co-Z coordinates and in affine
+ * coordinates, which gives the common Z: a single inversion recovers the affine result.
+ *
+ * The ladder adds R0 = j * P and R1 = (j + 1) * P for the prefixes j = floor(k / 2^i), i >= 1, of
+ * k, and needs them finite, distinct and not opposite: j, j + 1 and 2j + 1 != 0 mod n for a point P
+ * of prime order n, with x(P) != 0 and k * P != infinity. This holds for 2 <= k < n - 1, where
+ * j < n - 1. It also holds for k + n and k + 2n with 2 <= k < n - 2, below 3n: only the prefixes
+ * of levels 1 and 2 reach n / 2, and none of them is (n - 1) / 2, n - 1, n or (3n - 1) / 2.
+ * ecp_coz_ladder does not check it.
+ */
+
+typedef struct {
+	fe_t X;
+	fe_t Y;
+} ecp_xy;
+
+/* Swap U and V if flag = 1, in data-independent time */
+static void ecp_xy_cswap(ecp_xy *U, ecp_xy *V, int flag) {
+	ecp_xy T = *U;
+
+	fe_cmov(U->X, V->X, flag);
+	fe_cmov(U->Y, V->Y, flag);
+	fe_cmov(V->X, T.X, flag);
+	fe_cmov(V->Y, T.Y, flag);
+}
+
+/* XYCZ-ADD: (U, V) = (P1, P2) co-Z -> (P1, P1 + P2) co-Z, P1 rescaled to the Z of the sum */
+static void ecp_coz_add(ecp_xy *U, ecp_xy *V, const fe_field f) {
+	fe_t t, A, B, C, d, E;
+
+	fe_sub(t, V->X, U->X, f);
+	fe_sqr(A, t, f);
+	fe_mul(B, U->X, A, f);
+	fe_mul(C, V->X, A, f);
+	fe_sub(d, V->Y, U->Y, f);
+	fe_sub(t, C, B, f);
+	fe_mul(E, U->Y, t, f);
+
+	/* X3 = d^2 - B - C, Y3 = d * (B - X3) - E */
+	fe_sqr(V->X, d, f);
+	fe_sub(V->X, V->X, B, f);
+	fe_sub(V->X, V->X, C, f);
+	fe_sub(t, B, V->X, f);
+	fe_mul(t, d, t, f);
+	fe_sub(V->Y, t, E, f);
+
+	fe_copy(U->X, B);
+	fe_copy(U->Y, E);
+}
+
+/* XYCZ-ADDC: (U, V) = (P1, P2) co-Z -> (P1 - P2, P1 + P2) co-Z */
+static void ecp_coz_addc(ecp_xy *U, ecp_xy *V, const fe_field f) {
+	fe_t t, A, B, C, d, s, E, X3, Y3;
+
+	fe_sub(t, V->X, U->X, f);
+	fe_sqr(A, t, f);
+	fe_mul(B, U->X, A, f);
+	fe_mul(C, V->X, A, f);
+	fe_sub(d, V->Y, U->Y, f);
+	fe_add(s, V->Y, U->Y, f);
+	fe_sub(t, C, B, f);
+	fe_mul(E, U->Y, t, f);
+
+	/* sum: X3 = d^2 - B - C, Y3 = d * (B - X3) - E */
+	fe_sqr(X3, d, f);
+	fe_sub(X3, X3, B, f);
+	fe_sub(X3, X3, C, f);
+	fe_sub(t, B, X3, f);
+	fe_mul(t, d, t, f);
+	fe_sub(Y3, t, E, f);
+
+	/* difference: X3' = s^2 - B - C, Y3' = s * (X3' - B) - E */
+	fe_sqr(U->X, s, f);
+	fe_sub(U->X, U->X, B, f);
+	fe_sub(U->X, U->X, C, f);
+	fe_sub(t, U->X, B, f);
+	fe_mul(t, s, t, f);
+	fe_sub(U->Y, t, E, f);
+
+	fe_copy(V->X, X3);
+	fe_copy(V->Y, Y3);
+}
+
+/* XYCZ-IDBL: affine P -> (P, 2P) co-Z, with Z = 2y */
+static void ecp_coz_idbl(ecp_xy *R0, ecp_xy *R1, const ecp_fe *P, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t yy, S, M, t;
+
+	/* S = 4 * x * y^2, M = 3 * x^2 + a */
+	fe_sqr(yy, P->y, f);
+	fe_mul(S, P->x, yy, f);
+	fe_add(S, S, S, f);
+	fe_add(S, S, S, f);
+	fe_sqr(t, P->x, f);
+	fe_add(M, t, t, f);
+	fe_add(M, M, t, f);
+	fe_add(M, M, ec->fe_a, f);
+
+	/* 2P = (M^2 - 2S, M * (S - X) - 8 * y^4) */
+	fe_sqr(R1->X, M, f);
+	fe_sub(R1->X, R1->X, S, f);
+	fe_sub(R1->X, R1->X, S, f);
+	fe_sqr(yy, yy, f);
+	fe_add(yy, yy, yy, f);
+	fe_add(yy, yy, yy, f);
+	fe_add(yy, yy, yy, f);
+	fe_sub(t, S, R1->X, f);
+	fe_mul(t, M, t, f);
+	fe_sub(R1->Y, t, yy, f);
+
+	/* P = (x * (2y)^2, y * (2y)^3) */
+	fe_copy(R0->X, S);
+	fe_copy(R0->Y, yy);
+}
+
+/** Compute R = scalar * P with the co-Z Montgomery ladder, in affine coordinates.
+ *	The ladder runs bits(scalar) - 1 iterations, the same for both values of each bit: callers
+ *	hide the length of a secret scalar by giving it a fixed bit length, as ecp_mul_coz does with
+ *	k + n or k + 2n.
+ *	Require: ec->fp != NULL, scalar meets the conditions above for P of prime order n, x(P) != 0
+ *	\param R		affine result
+ *	\param P		affine point
+ *	\param scalar	big number
+ *	\param mu		non-zero element of fp randomizing the common Z, or NULL
+ *	\param ec		pointer to an ec_group structure
+ */
+void ecp_coz_ladder(ecp_fe *R, const ecp_fe *P, const mpz_t scalar, const fe_t mu, const ec_group ec) {
+	const fe_field f = ec->fp;
+	ecp_xy R0, R1, Rb;
+	fe_t t, u, d;
+	int i, b;
+
+	ecp_coz_idbl(&R0, &R1, P, ec);
+
+	/* (X, Y, Z) ~ (mu^2 * X, mu^3 * Y, mu * Z) */
+	if (mu != NULL) {
+		fe_sqr(t, mu, f);
+		fe_mul(u, t, mu, f);
+		fe_mul(R0.X, R0.X, t, f); fe_mul(R0.Y, R0.Y, u, f);
+		fe_mul(R1.X, R1.X, t, f); fe_mul(R1.Y, R1.Y, u, f);
+	}
+
+	/* R_(1-b) = R_b + R_(1-b), R_b = 2 * R_b; after the swap, R0 holds R_b */
+	for (i = mpz_sizeinbase(scalar, 2) - 2; i > 0; i--) {
+		b = mpz_tstbit(scalar, i);
+		ecp_xy_cswap(&R0, &R1, b);
+		ecp_coz_addc(&R0, &R1, f);
+		ecp_coz_add(&R1, &R0, f);
+		ecp_xy_cswap(&R0, &R1, b);
+	}
+
+	/* last bit: R_b - R_(1-b) = (-1)^(b+1) * P gives the Z of the last addition */
+	b = mpz_tstbit(scalar, 0);
+	ecp_xy_cswap(&R0, &R1, b);
+	ecp_coz_addc(&R0, &R1, f);
+	Rb = R0;
+	fe_sub(d, R1.X, R0.X, f);		// X_(1-b) - X_b
+	fe_neg(t, d, f);
+	fe_cmov(d, t, b);				// X1 - X0 before the swap
+	ecp_coz_add(&R1, &R0, f);
+	ecp_xy_cswap(&R0, &R1, b);
+
+	/* 1 / Z = X_b * y(P) / (Y_b * x(P) * (X1 - X0)) */
+	fe_mul(t, Rb.Y, P->x, f);
+	fe_mul(t, t, d, f);
+	fe_inv(t, t, f);
+	fe_mul(t, t, Rb.X, f);
+	fe_mul(t, t, P->y, f);
+
+	fe_sqr(u, t, f);
+	fe_mul(R->x, R0.X, u, f);
+	fe_mul(u, u, t, f);
+	fe_mul(R->y, R0.Y, u, f);
+	R->infinity = 0;
+}
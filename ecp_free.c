@@ -22,3 +22,17 @@ void ec_point_free(ec_point P) {
 	free(P);
 }
 
+
+/** frees a ec_point_proj structure
+ *  \param  P  pointer to the ec_point_proj structure
+ */
+void ec_point_proj_free(ec_point_proj P) {
+
+	if (P == NULL)
+		return;
+
+	mpz_clear(P->X);
+	mpz_clear(P->Y);
+	mpz_clear(P->Z);
+	free(P);
+}
@@ -0,0 +1,171 @@
+/*
+ * ecp_glv.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+#include "ec.h"
+#include "ec_point.h"
+#include "fe_ops.h"
+
+/*-
+ * GLV endomorphism (Gallant, Lambert, Vanstone) of the Koblitz curve secp256k1.
+ *
+ * On y^2 = x^3 + B over a field with a cube root of unity beta, phi(x, y) = (beta * x, y) is an
+ * endomorphism, acting on the points of order n as the multiplication by a cube root of unity
+ * lambda mod n: phi(P) = lambda * P for one field multiplication. A scalar is split into
+ * k = k1 + k2 * lambda mod n with |k1|, |k2| < 2^128, about half the bits of n, using a short
+ * basis (a1, b1), (a2, b2) of the lattice of the (a, b) with a + b * lambda = 0 mod n:
+ *   c1 = round(b2 * k / n), c2 = round(-b1 * k / n),
+ *   k2 = -c1 * b1 - c2 * b2 mod n, k1 = k - k2 * lambda mod n,
+ * where the divisions by n are products with g1 = round(2^384 * b2 / n), g2 = round(2^384 * -b1 / n)
+ * and a shift, as in libsecp256k1. Then k * P = k1 * P + k2 * phi(P) with half the doublings.
+ *
+ * The split runs in data-independent time: the comb multiplies secret scalars with it
+ * (ecp_comb.c), the interleaved wNAF public ones (ecp_wnaf.c).
+ */
+
+static const struct glv_params {
+	const char *p, *order, *beta, *lambda, *a1, *b1, *a2, *b2;
+} glv_params[] = {
+	{	/* secp256k1 */
+		"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F",
+		"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141",
+		"7AE96A2B657C07106E64479EAC3434E99CF0497512F58995C1396C28719501EE",
+		"5363AD4CC05C30E0A5261C028812645A122E22EA20816678DF02967C1B23BD72",
+		"3086D221A7D46BCDE86C90E49284EB15",
+		"-E4437ED6010E88286F547FA90ABFE4C3",
+		"114CA50F7A8E2F3F657C1108D9D44CFD8",
+		"3086D221A7D46BCDE86C90E49284EB15",
+	},
+};
+
+/* r = round(2^shift * b / n), plain integer of FE_LIMBS limbs. Require: 0 < r < 2^FE_BITS */
+static void ec_glv_round(fe_t r, const mpz_t b, int shift, const mpz_t n) {
+	mpz_t t;
+	int i;
+
+	mpz_init(t);
+	mpz_mul_2exp(t, b, shift + 1);
+	mpz_add(t, t, n);
+	mpz_fdiv_q(t, t, n);
+	mpz_fdiv_q_2exp(t, t, 1);
+	assert(mpz_sgn(t) > 0 && mpz_sizeinbase(t, 2) <= FE_BITS);
+	for (i = 0; i < FE_LIMBS; i++)
+		r[i] = mpz_getlimbn(t, i);
+	mpz_clear(t);
+}
+
+/** Returns the GLV endomorphism of the curve of ec if it is a known one, i.e. secp256k1
+ *	\param ec	pointer to an ec_group structure, with its fixed-width arithmetic
+ *	\return		pointer to an ec_glv structure or NULL
+ */
+ec_glv ec_glv_init(const ec_group ec) {
+	const struct glv_params *c = NULL;
+	mpz_t p, t, b2;
+	ec_glv glv;
+	unsigned int i;
+
+	if (ec->fp == NULL || ec->fn == NULL || ec->a_form != EC_A_ZERO)
+		return NULL;
+
+	mpz_init(p); mpz_init(t);
+	for (i = 0; i < sizeof(glv_params) / sizeof(struct glv_params) && c == NULL; i++) {
+		mpz_set_str(p, glv_params[i].p, 16);
+		mpz_set_str(t, glv_params[i].order, 16);
+		if (!mpz_cmp(p, ec->field) && !mpz_cmp(t, ec->order))
+			c = &glv_params[i];
+	}
+	mpz_clear(p);
+	if (c == NULL) {
+		mpz_clear(t);
+		return NULL;
+	}
+
+	glv = malloc(sizeof(struct ec_glv_st));
+	assert(glv != NULL);
+	glv->shift = FE_BITS + FE_BITS / 2;
+
+	mpz_set_str(t, c->beta, 16);
+	fe_from_mpz(glv->beta, t, ec->fp);
+	mpz_set_str(t, c->lambda, 16);
+	fe_from_mpz(glv->lambda, t, ec->fn);
+
+	mpz_init_set_str(b2, c->b2, 16);
+	ec_glv_round(glv->g1, b2, glv->shift, ec->order);
+	mpz_neg(b2, b2);
+	fe_from_mpz(glv->mb2, b2, ec->fn);
+
+	mpz_set_str(t, c->b1, 16);
+	mpz_neg(t, t);
+	ec_glv_round(glv->g2, t, glv->shift, ec->order);
+	fe_from_mpz(glv->mb1, t, ec->fn);
+
+	mpz_clear(t); mpz_clear(b2);
+	return glv;
+}
+
+/** Frees the endomorphism of a curve
+ *	\param glv	pointer to an ec_glv structure or NULL
+ */
+void ec_glv_free(ec_glv glv) {
+	free(glv);
+}
+
+/* r = |a| as a plain integer and neg = 1 if a < 0, for a in (-2^(FE_BITS/2), 2^(FE_BITS/2)) given
+ * modulo n: of a and n - a, the one with the top half of the limbs zero */
+static void ec_glv_abs(fe_t r, int *neg, const fe_t a, const fe_field fn) {
+	mp_limb_t high = 0;
+	fe_t m;
+	int i;
+
+	fe_neg(m, a, fn);
+	fe_get_limbs(m, m, fn);
+	fe_get_limbs(r, a, fn);
+	for (i = FE_LIMBS / 2; i < FE_LIMBS; i++)
+		high |= r[i];
+	*neg = (int) ((high | (0 - high)) >> (GMP_LIMB_BITS - 1));
+	fe_cmov(r, m, *neg);
+}
+
+/** Split k = (-1)^neg1 * k1 + (-1)^neg2 * k2 * lambda mod order, in data-independent time
+ *	Require: ec->glv != NULL
+ *	\param k1, k2	plain integers smaller than 2^(FE_BITS / 2)
+ *	\param neg1, neg2	signs of the halves, 0 or 1
+ *	\param k		big number, reduced modulo the order
+ */
+void ec_glv_split(fe_t k1, int *neg1, fe_t k2, int *neg2, const mpz_t k, const ec_group ec) {
+	const ec_glv glv = ec->glv;
+	const fe_field fn = ec->fn;
+	fe_t kk, c1, c2, t;
+
+	fe_from_mpz(kk, k, fn);
+	fe_get_limbs(t, kk, fn);
+
+	/* c1 = round(b2 * k / n), c2 = round(-b1 * k / n) */
+	fe_mul_shift(c1, t, glv->g1, glv->shift);
+	fe_mul_shift(c2, t, glv->g2, glv->shift);
+	fe_set_limbs(c1, c1, fn);
+	fe_set_limbs(c2, c2, fn);
+
+	/* k2 = -c1 * b1 - c2 * b2, k1 = k - k2 * lambda */
+	fe_mul(c1, c1, glv->mb1, fn);
+	fe_mul(c2, c2, glv->mb2, fn);
+	fe_add(c2, c1, c2, fn);
+	fe_mul(t, c2, glv->lambda, fn);
+	fe_sub(c1, kk, t, fn);
+
+	ec_glv_abs(k1, neg1, c1, fn);
+	ec_glv_abs(k2, neg2, c2, fn);
+}
+
+/** Compute R = phi(P) = (beta * x, y) = lambda * P. R may be P
+ *	Require: ec->glv != NULL
+ */
+void ecp_glv_endo(ecp_fe *R, const ecp_fe *P, const ec_group ec) {
+	fe_mul(R->x, P->x, ec->glv->beta, ec->fp);
+	fe_copy(R->y, P->y);
+	R->infinity = P->infinity;
+}
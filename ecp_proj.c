@@ -6,40 +6,10 @@
  */
 
 #include "ecdsa.h"
+#include "ec.h"
 #include "ec_point.h"
 #include "field_ops.h"
-
-/*
- * Copy in constant time: if icopy == 1, copy in to out, if icopy == 0, copy
- * out to itself.
- */
-
-void copy_conditional(ec_point_proj dst, const ec_point_proj src, mpz_t icopy) {
-    mpz_t mask1; mpz_init(mask1); mpz_neg(mask1, icopy);
-    mpz_t mask2; mpz_init(mask2); mpz_com(mask2, mask1);
-    mpz_t tmp, tmp2;
-    mpz_init(tmp); mpz_init(tmp2);
-
-    mpz_and(tmp, src->X, mask1);
-    mpz_and(tmp2, src->X, mask2);
-    mpz_xor(dst->X, tmp, tmp2);
-
-    mpz_and(tmp, src->Y, mask1);
-    mpz_and(tmp2, src->Y, mask2);
-    mpz_xor(dst->Y, tmp, tmp2);
-
-    mpz_and(tmp, src->Z, mask1);
-    mpz_and(tmp2, src->Z, mask2);
-    mpz_xor(dst->Z, tmp, tmp2);
-
-}
-
-// Create a mask of only ones if the arguments a and b are equal, else a mask of only zeros
-void eq_makemask(int mask, int a, int b) {
-	mask = 0;
-	mask |= a ^ b;
-	mask--;
-}
+#include "fe_ops.h"
 
 /******************************************************************************/
 /*-
@@ -49,166 +19,717 @@ void eq_makemask(int mask, int a, int b) {
  * (X, Y, Z) corresponds to the affine point (X/Z^2, Y/Z^3),
  * or to the point at infinity if Z == 0.
  *
+ * A scalar multiplication in these coordinates needs a single inversion, to get back
+ * the affine result, instead of one inversion per group operation.
+ * The fixed-width functions ecp_jac_* are used when the group has fixed-width arithmetic
+ * (ec->fp != NULL), the ec_point_proj_* functions on big integers otherwise.
  */
 
+/* R = 2 * A, R = 3 * A, R = 4 * A, R = 8 * A mod p */
+static inline void fe_dbl(fe_t r, const fe_t a, const fe_field f) {
+	fe_add(r, a, a, f);
+}
+
+static inline void fe_tpl(fe_t r, const fe_t a, const fe_field f) {
+	fe_t t;
+	fe_add(t, a, a, f);
+	fe_add(r, t, a, f);
+}
+
+static inline void fe_4mul(fe_t r, const fe_t a, const fe_field f) {
+	fe_add(r, a, a, f);
+	fe_add(r, r, r, f);
+}
+
+static inline void fe_8mul(fe_t r, const fe_t a, const fe_field f) {
+	fe_4mul(r, a, f);
+	fe_add(r, r, r, f);
+}
+
 /*-
- * Double an elliptic curve point:
+ * Double an elliptic curve point, for any a:
  * (X', Y', Z') = 2 * (X, Y, Z), where
- * X' = (3 * (X - Z^2) * (X + Z^2))^2 - 8 * X * Y^2
- * Y' = 3 * (X - Z^2) * (X + Z^2) * (4 * X * Y^2 - X') - 8 * Y^2
- * Z' = (Y + Z)^2 - Y^2 - Z^2 = 2 * Y * Z
- * Outputs can equal corresponding inputs, i.e., x_out == x_in is allowed,
- * while x_out == y_in is not (maybe this works, but it's not tested).
+ * S = 4 * X * Y^2, M = 3 * X^2 + a * Z^4
+ * X' = M^2 - 2 * S
+ * Y' = M * (S - X') - 8 * Y^4
+ * Z' = 2 * Y * Z
  */
-ec_point_proj ec_point_proj_dbl(ec_point_proj P, ec_group ec) {
-	mpz_t field, a;
-	mpz_init_set(field, ec->field);
-	mpz_init_set(a, ec->A);
+static void ecp_jac_dbl_generic(ecp_jac *R, const ecp_jac *P, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t XX, YY, ZZ, S, M, T;
+
+	fe_sqr(XX, P->X, f);			// XX = X1^2
+	fe_sqr(YY, P->Y, f);			// YY = Y1^2
+	fe_sqr(ZZ, P->Z, f);			// ZZ = Z1^2
+
+	fe_mul(S, P->X, YY, f);			// S = 4*X1*YY
+	fe_4mul(S, S, f);
+
+	fe_tpl(M, XX, f);				// M = 3*XX + a*ZZ^2
+	fe_sqr(T, ZZ, f);
+	fe_mul(T, T, ec->fe_a, f);
+	fe_add(M, M, T, f);
+
+	fe_mul(R->Z, P->Y, P->Z, f);	// Z3 = 2*Y1*Z1
+	fe_dbl(R->Z, R->Z, f);
+
+	fe_sqr(T, M, f);				// X3 = M^2 - 2*S
+	fe_sub(T, T, S, f);
+	fe_sub(R->X, T, S, f);
+
+	fe_sub(S, S, R->X, f);			// Y3 = M*(S - X3) - 8*YY^2
+	fe_mul(S, M, S, f);
+	fe_sqr(YY, YY, f);
+	fe_8mul(YY, YY, f);
+	fe_sub(R->Y, S, YY, f);
+}
 
-	ec_point_proj R;
-	// Initialize the point R
-	R = ec_point_proj_init();
-	mpz_t XX, YY, ZZ, S, M, T, tmp, tmp1;
-	mpz_init(XX); mpz_init(YY); mpz_init(ZZ); mpz_init(S); mpz_init(M); mpz_init(T); mpz_init(tmp); mpz_init(tmp1);
+/*-
+ * Double an elliptic curve point with a = -3 (dbl-2001-b), 3M + 5S:
+ * delta = Z^2, gamma = Y^2, beta = X * gamma, alpha = 3 * (X - delta) * (X + delta)
+ * X' = alpha^2 - 8 * beta
+ * Z' = (Y + Z)^2 - gamma - delta
+ * Y' = alpha * (4 * beta - X') - 8 * gamma^2
+ */
+static void ecp_jac_dbl_a3(ecp_jac *R, const ecp_jac *P, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t delta, gamma, beta, alpha, T;
+
+	fe_sqr(delta, P->Z, f);
+	fe_sqr(gamma, P->Y, f);
+	fe_mul(beta, P->X, gamma, f);
+
+	fe_sub(T, P->X, delta, f);		// alpha = 3*(X1 - delta)*(X1 + delta)
+	fe_add(alpha, P->X, delta, f);
+	fe_mul(alpha, T, alpha, f);
+	fe_tpl(alpha, alpha, f);
+
+	fe_add(T, P->Y, P->Z, f);		// Z3 = (Y1 + Z1)^2 - gamma - delta
+	fe_sqr(T, T, f);
+	fe_sub(T, T, gamma, f);
+	fe_sub(R->Z, T, delta, f);
+
+	fe_4mul(beta, beta, f);			// X3 = alpha^2 - 8*beta
+	fe_sqr(T, alpha, f);
+	fe_sub(T, T, beta, f);
+	fe_sub(R->X, T, beta, f);
+
+	fe_sub(beta, beta, R->X, f);	// Y3 = alpha*(4*beta - X3) - 8*gamma^2
+	fe_mul(beta, alpha, beta, f);
+	fe_sqr(gamma, gamma, f);
+	fe_8mul(gamma, gamma, f);
+	fe_sub(R->Y, beta, gamma, f);
+}
 
-	mod_sec_sqr(XX, P->X, field);		// XX = X1^2
-	mod_sec_sqr(YY, P->Y, field);		// YY = Y1^2
-	mod_sec_sqr(ZZ, P->Z, field);		// ZZ = Z1^2
+/*-
+ * Double an elliptic curve point with a = 0 (dbl-2009-l), 2M + 5S:
+ * A = X^2, B = Y^2, C = B^2, D = 2 * ((X + B)^2 - A - C), E = 3 * A
+ * X' = E^2 - 2 * D
+ * Y' = E * (D - X') - 8 * C
+ * Z' = 2 * Y * Z
+ */
+static void ecp_jac_dbl_a0(ecp_jac *R, const ecp_jac *P, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t A, B, C, D, E;
 
-	mod_sec_mul(tmp, P->X, YY, field); 	// S = 4*X1*YY
-	mod_4mul(S, tmp, field);
+	fe_sqr(A, P->X, f);
+	fe_sqr(B, P->Y, f);
+	fe_sqr(C, B, f);
 
-	mod_add_add(M, XX, XX, XX, field);	// M = 3*XX+a*ZZ^2
-	mpz_sqr(tmp, ZZ);
-	mod_mul(tmp1, tmp, a, field);
-	mod_sec_add(M, M, tmp1, field);
+	fe_add(D, P->X, B, f);			// D = 2*((X1 + B)^2 - A - C)
+	fe_sqr(D, D, f);
+	fe_sub(D, D, A, f);
+	fe_sub(D, D, C, f);
+	fe_dbl(D, D, f);
 
-	mpz_sqr(tmp, M);       				// T = M^2-2*S
-	mod_subsub(T, tmp, S, S, field);
+	fe_tpl(E, A, f);
 
-	mpz_set(R->X, T);					// X3 = T
-	mpz_sub(tmp, S, T);	  	  	  	  	// Y3 = M*(S-T)-8*YY^2
-	mod_sec_mul(tmp1, M, tmp, field);
-	mod_sec_sqr(tmp, YY, field);
-	mod_8mul(tmp, tmp, field);
-	mod_sub(R->Y, tmp1, tmp, field);
+	fe_mul(R->Z, P->Y, P->Z, f);	// Z3 = 2*Y1*Z1
+	fe_dbl(R->Z, R->Z, f);
 
-	mpz_mul(tmp, P->Y, P->Z);  	  	  	// Z3 = 2*Y1*Z1
-	mpz_add(tmp1, tmp, tmp);
-	mpz_mod(R->Z, tmp1, field);
+	fe_sqr(A, E, f);				// X3 = E^2 - 2*D
+	fe_sub(A, A, D, f);
+	fe_sub(R->X, A, D, f);
 
-	mpz_clear(a); mpz_clear(field);
-	mpz_clear(XX); mpz_clera(YY); mpz_clear(ZZ); mpz_clear(S); mpz_clear(M); mpz_clear(T); mpz_clear(tmp); mpz_clear(tmp1);
+	fe_sub(D, D, R->X, f);			// Y3 = E*(D - X3) - 8*C
+	fe_mul(D, E, D, f);
+	fe_8mul(C, C, f);
+	fe_sub(R->Y, D, C, f);
+}
 
-	return R;
+/*
+ * Double an elliptic curve point with the formulas selected by the form of a.
+ * The point at infinity (Z = 0) and the points of order 2 (Y = 0) give Z' = 0, so there is
+ * no exceptional case. R may be equal to P.
+ */
+void ecp_jac_dbl(ecp_jac *R, const ecp_jac *P, const ec_group ec) {
+	switch (ec->a_form) {
+	case EC_A_MINUS3:
+		ecp_jac_dbl_a3(R, P, ec);
+		break;
+	case EC_A_ZERO:
+		ecp_jac_dbl_a0(R, P, ec);
+		break;
+	default:
+		ecp_jac_dbl_generic(R, P, ec);
+		break;
+	}
 }
 
+/*
+ * Common tail of the additions. From U1 = X1 * Z2^2, S1 = Y1 * Z2^3, H = U2 - U1, r = S2 - S1:
+ * X3 = r^2 - H^3 - 2 * U1 * H^2
+ * Y3 = r * (U1 * H^2 - X3) - S1 * H^3
+ * Z3 is computed by the caller
+ */
+static void ecp_jac_add_tail(ecp_jac *R, const fe_t U1, const fe_t S1, const fe_t H, const fe_t r,
+		const fe_field f) {
+	fe_t HH, HHH, V, T;
+
+	fe_sqr(HH, H, f);
+	fe_mul(HHH, HH, H, f);
+	fe_mul(V, U1, HH, f);
+
+	fe_sqr(T, r, f);
+	fe_sub(T, T, HHH, f);
+	fe_sub(T, T, V, f);
+	fe_sub(R->X, T, V, f);
+
+	fe_sub(V, V, R->X, f);
+	fe_mul(V, r, V, f);
+	fe_mul(T, S1, HHH, f);
+	fe_sub(R->Y, V, T, f);
+}
 
-/** Add two elliptic curve points:
+/** Add two elliptic curve points, R = P + Q.
  * 	(X_1, Y_1, Z_1) + (X_2, Y_2, Z_2) = (X_3, Y_3, Z_3), where
- * 	X_3 = (Z_1^3 * Y_2 - Z_2^3 * Y_1)^2 - (Z_1^2 * X_2 - Z_2^2 * X_1)^3 -
- * 	2 * Z_2^2 * X_1 * (Z_1^2 * X_2 - Z_2^2 * X_1)^2
- * 	Y_3 = (Z_1^3 * Y_2 - Z_2^3 * Y_1) * (Z_2^2 * X_1 * (Z_1^2 * X_2 - Z_2^2 * X_1)^2 - X_3) -
- *        Z_2^3 * Y_1 * (Z_1^2 * X_2 - Z_2^2 * X_1)^3
- * 	Z_3 = (Z_1^2 * X_2 - Z_2^2 * X_1) * (Z_1 * Z_2)
+ * 	U_1 = X_1 * Z_2^2, U_2 = X_2 * Z_1^2, S_1 = Y_1 * Z_2^3, S_2 = Y_2 * Z_1^3
+ * 	H = U_2 - U_1, r = S_2 - S_1, Z_3 = Z_1 * Z_2 * H
  *
- * 	This runs faster if 'mixed' is set, which requires Z_2 = 1 or Z_2 = 0.
+ * 	The points at infinity are handled in constant time. The function is not entirely
+ * 	constant-time: it includes a branch for the case P = Q or P = -Q (while not equal to the
+ * 	point at infinity). This case never happens during a single point multiplication with a
+ * 	scalar less than the order, so there is no timing leak for ECDSA signing.
+ * 	R may be equal to P or Q.
  */
+void ecp_jac_add(ecp_jac *R, const ecp_jac *P, const ecp_jac *Q, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t Z1Z1, Z2Z2, U1, U2, S1, S2, H, r;
+	int p_inf, q_inf;
+	ecp_jac T;
+
+	p_inf = fe_is_zero(P->Z);
+	q_inf = fe_is_zero(Q->Z);
+
+	fe_sqr(Z1Z1, P->Z, f);
+	fe_sqr(Z2Z2, Q->Z, f);
+	fe_mul(U1, P->X, Z2Z2, f);
+	fe_mul(U2, Q->X, Z1Z1, f);
+	fe_mul(S1, P->Y, Q->Z, f);
+	fe_mul(S1, S1, Z2Z2, f);
+	fe_mul(S2, Q->Y, P->Z, f);
+	fe_mul(S2, S2, Z1Z1, f);
+
+	fe_sub(H, U2, U1, f);
+	fe_sub(r, S2, S1, f);
+
+	if (fe_is_zero(H) & !p_inf & !q_inf) {
+		if (fe_is_zero(r))
+			ecp_jac_dbl(R, P, ec);
+		else
+			ecp_jac_set_infinity(R, ec);
+		return;
+	}
+
+	ecp_jac_add_tail(&T, U1, S1, H, r, f);
+	fe_mul(T.Z, P->Z, Q->Z, f);
+	fe_mul(T.Z, T.Z, H, f);
+
+	ecp_jac_cmov(&T, Q, p_inf);
+	ecp_jac_cmov(&T, P, q_inf);
+	*R = T;
+}
 
-/** This function is not entirely constant-time: it includes a branch for
- * 	checking whether the two input points are equal, (while not equal to the
- * 	point at infinity). This case never happens during single point
- * 	multiplication, so there is no timing leak for ECDH or ECDSA signing.
+/** Add an affine point to a Jacobian point (mixed addition, Z_2 = 1), R = P + Q.
+ *	U_1 = X_1, S_1 = Y_1, Z_3 = Z_1 * H, otherwise as ecp_jac_add.
+ *	Same handling of the special cases as ecp_jac_add. R may be equal to P
  */
-ec_point_proj ec_point_proj_add(ec_point_proj P, ec_point_proj Q, ec_group ec) {
-	mpz_t field, a;
-	mpz_init_set(field, ec->field);
-	mpz_init_set(a, ec->A);
+void ecp_jac_add_mixed(ecp_jac *R, const ecp_jac *P, const ecp_fe *Q, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t Z1Z1, U2, S2, H, r;
+	int p_inf, q_inf = Q->infinity;
+	ecp_jac T, Qj;
+
+	p_inf = fe_is_zero(P->Z);
+
+	fe_sqr(Z1Z1, P->Z, f);
+	fe_mul(U2, Q->x, Z1Z1, f);
+	fe_mul(S2, Q->y, P->Z, f);
+	fe_mul(S2, S2, Z1Z1, f);
+
+	fe_sub(H, U2, P->X, f);
+	fe_sub(r, S2, P->Y, f);
+
+	if (fe_is_zero(H) & !p_inf & !q_inf) {
+		if (fe_is_zero(r))
+			ecp_jac_dbl(R, P, ec);
+		else
+			ecp_jac_set_infinity(R, ec);
+		return;
+	}
 
-	ec_point_proj R;
-	// Initialize the point R
-	R = ec_point_proj_init();
-	mpz_t A, B, C, D, E, F, EEE, tmp, tmp1;
-	mpz_init(A); mpz_init(B); mpz_init(C); mpz_init(D); mpz_init(E); mpz_init(F);
-	mpz_init(EEE); mpz_init(tmp); mpz_init(tmp1);
+	ecp_jac_add_tail(&T, P->X, P->Y, H, r, f);
+	fe_mul(T.Z, P->Z, H, f);
 
-	mpz_sqr(tmp, Q->Z);				// Z2^2
-	mpz_mul(tmp1, P->X, tmp);		// A = X1 Z2^2
-	mpz_mod(A, tmp1, field);
+	ecp_jac_set_affine(&Qj, Q, ec);
+	ecp_jac_cmov(&T, &Qj, p_inf);
+	ecp_jac_cmov(&T, P, q_inf);
+	*R = T;
+}
 
-	mpz_mul(tmp1, tmp, Q->Z); 		// Z2^3
-	mpz_mul(tmp, P->Y, tmp1);		// C = Y1 Z2^3
-	mpz_mod(C, tmp, field);
+/* Set R to the point at infinity (1 : 1 : 0) */
+void ecp_jac_set_infinity(ecp_jac *R, const ec_group ec) {
+	fe_set_one(R->X, ec->fp);
+	fe_set_one(R->Y, ec->fp);
+	fe_set_zero(R->Z);
+}
 
-	mpz_sqr(tmp, P->Z);				// Z1^2
-	mpz_mul(tmp1, Q->X, tmp);		// B = X2 Z1^2
-	mpz_mod(B, tmp1, field);
+/* Copy P to R if flag = 1, leave R unchanged if flag = 0, in data-independent time */
+void ecp_jac_cmov(ecp_jac *R, const ecp_jac *P, int flag) {
+	fe_cmov(R->X, P->X, flag);
+	fe_cmov(R->Y, P->Y, flag);
+	fe_cmov(R->Z, P->Z, flag);
+}
 
-	mpz_mul(tmp1, tmp, P->Z); 		// Z1^3
-	mpz_mul(tmp, Q->Y, tmp1);		// D = Y2 Z1^3
-	mpz_mod(D, tmp, field);
+/* Convert an affine point to Jacobian coordinates, (x, y) -> (x : y : 1), the point at infinity
+ * being selected with a conditional move */
+void ecp_jac_set_affine(ecp_jac *R, const ecp_fe *P, const ec_group ec) {
+	ecp_jac inf;
 
-	mod_sub(E, B, A, field);
-	mod_sub(F, D, C, field);
+	ecp_jac_set_infinity(&inf, ec);
+	fe_copy(R->X, P->x);
+	fe_copy(R->Y, P->y);
+	fe_set_one(R->Z, ec->fp);
+	ecp_jac_cmov(R, &inf, P->infinity);
+}
 
-	// B, D no longer use, so B = E^2, D = F2
-	mpz_sqr(B, E, E); mpz_sqr(D, F, F);
+/* Convert a Jacobian point to affine coordinates, with one inversion */
+void ecp_jac_get_affine(ecp_fe *R, const ecp_jac *P, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t zinv, zinv2;
+
+	R->infinity = fe_is_zero(P->Z);
+	fe_inv(zinv, P->Z, f);
+	fe_sqr(zinv2, zinv, f);
+	fe_mul(R->x, P->X, zinv2, f);
+	fe_mul(zinv2, zinv2, zinv, f);
+	fe_mul(R->y, P->Y, zinv2, f);
+}
 
-	mpz_mul(EEE, E, B); 			// E^3
-	mpz_mul(tmp, A, B);				// tmp = AE^2
+/** Convert n Jacobian points to affine coordinates with a single inversion (Montgomery's trick,
+ *	fe_batch_inv): the inverse of Z_0 * ... * Z_{n-1} gives every Z_i^-1 with 3 multiplications each.
+ *	The points at infinity are skipped in the product.
+ *	\param R		array of n affine points
+ *	\param P		array of n Jacobian points, may not overlap R
+ */
+void ecp_jac_batch_get_affine(ecp_fe *R, const ecp_jac *P, int n, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t *zinv, z;
+	int i;
+
+	if (n <= 0)
+		return;
+	zinv = malloc(n * sizeof(fe_t));
+	assert(zinv != NULL);
+
+	for (i = 0; i < n; i++)
+		fe_copy(zinv[i], P[i].Z);
+	fe_batch_inv(zinv, (const fe_t *) zinv, n, f);
+
+	for (i = 0; i < n; i++) {
+		R[i].infinity = fe_is_zero(P[i].Z);
+		fe_sqr(z, zinv[i], f);
+		fe_mul(R[i].x, P[i].X, z, f);
+		fe_mul(z, z, zinv[i], f);
+		fe_mul(R[i].y, P[i].Y, z, f);
+	}
 
-	mpz_sub(tmp1, D, EEE);			// X3 = F^2 - E^3 - 2*AE^2
-	mpz_sub(D, tmp1, tmp);
-	mpz_sub(tmp1, D, tmp);
-	mpz_mod(R->X, tmp1, field);
+	free(zinv);
+}
 
-	mpz_sub(tmp1, tmp - R->X); 		// AE^2 - X3
-	mpz_mul(tmp, F, tmp1);			// tmp = F(AE^2 - X3)
-	mpz_mul(tmp1, C, EEE);
-	mod_sub(R->Y, tmp, tmp1);
+/** Compute R = scalar * P with left-to-right double-and-add-always, in Jacobian coordinates.
+ *	The mixed addition is always performed and its result kept with a conditional move, so the
+ *	sequence of operations depends only on the bit length of scalar.
+ *	\param R		result in Jacobian coordinates
+ *	\param P		affine point
+ *	\param scalar	non-negative big number
+ *	\param ec		pointer to an ec_group structure with fixed-width arithmetic
+ */
+void ecp_jac_mul(ecp_jac *R, const ecp_fe *P, const mpz_t scalar, const ec_group ec) {
+	ecp_jac T;
+	int i;
+
+	ecp_jac_set_infinity(R, ec);
+	if (!mpz_sgn(scalar))
+		return;
+
+	ecp_jac_set_affine(R, P, ec);
+	for (i = mpz_sizeinbase(scalar, 2) - 2; i >= 0; i--) {
+		ecp_jac_dbl(R, R, ec);
+		ecp_jac_add_mixed(&T, R, P, ec);
+		ecp_jac_cmov(R, &T, mpz_tstbit(scalar, i));
+	}
+}
+
+/* Bits [b, b + n) of the plain integer k of FE_LIMBS + 1 limbs, the bits outside k being 0 */
+static unsigned int ecp_jac_window(const mp_limb_t *k, int b, int n) {
+	unsigned int r = 0;
+	int j, i;
 
-	mpz_mul(tmp, P->Z, Q->Z);
-	mod_mul(R->Z, tmp, E, field);
+	for (j = 0; j < n; j++) {
+		i = b + j;
+		if (i >= 0 && i < (FE_LIMBS + 1) * GMP_LIMB_BITS)
+			r |= (unsigned int) ((k[i / GMP_LIMB_BITS] >> (i % GMP_LIMB_BITS)) & 1) << j;
+	}
+	return r;
+}
 
-	mpz_clear(a); mpz_clear(field);
-	mpz_clear(A); mpz_clera(B); mpz_clear(C); mpz_clear(D); mpz_clear(E); mpz_clear(F);
-	mpz_clear(EEE); mpz_clear(tmp); mpz_clear(tmp1);
+/* Signed digit of a window of w + 1 bits, the top bit of the window below being its lowest one
+ * (Booth recoding): returns |digit| <= 2^(w-1) and sets sign to 1 for a negative digit. No branch */
+static unsigned int ecp_jac_recode(unsigned int in, int w, int *sign) {
+	unsigned int s = 0 - ((in >> w) & 1), d;
 
-	return R;
+	d = (1u << (w + 1)) - in - 1;
+	d = (d & s) | (in & ~s);
+	*sign = (int) (s & 1);
+	return (d >> 1) + (d & 1);
 }
 
-/**	Compute point multiplication
- * 	\param scalar	big number
- * 	\param P		pointer to an ec_point_proj structure
- * 	\param group	pointer to an ec_group structre
- * 	\return 		pointer to an ec_point_proj structure
- *
+/* R = sum_j (-1)^neg[j] * k[j] * P_j for n <= 2 plain scalars k[j] < 2^bits, with P_0 = P and
+ * P_1 = phi(P), table holding 0, P, 2P, ..., 2^(w-1) * P. The windows of all scalars share the
+ * doublings */
+static void ecp_jac_wmul_n(ecp_jac *R, const ecp_fe *table, const mp_limb_t (*k)[FE_LIMBS + 1],
+		const int *neg, int n, int bits, const ec_group ec) {
+	const int w = ECP_SEC_WINDOW;
+	int i, j, d, sign, nwin = (bits + w) / w;
+	unsigned int digit;
+	ecp_fe T;
+
+	memset(&T, 0, sizeof(ecp_fe));
+	ecp_jac_set_infinity(R, ec);
+	for (i = nwin - 1; i >= 0; i--) {
+		if (i < nwin - 1)
+			for (d = 0; d < w; d++)
+				ecp_jac_dbl(R, R, ec);
+
+		for (j = 0; j < n; j++) {
+			digit = ecp_jac_recode(ecp_jac_window(k[j], i * w - 1, w + 1), w, &sign);
+			ecp_fe_lookup(&T, table, (1 << (w - 1)) + 1, digit);
+			if (j == 1)
+				ecp_glv_endo(&T, &T, ec);
+			ecp_fe_cneg(&T, sign ^ neg[j], ec);
+			ecp_jac_add_mixed(R, R, &T, ec);
+		}
+	}
+}
+
+/** Compute R = scalar * P with signed fixed windows of ECP_SEC_WINDOW bits, in Jacobian
+ *	coordinates. The digits of the windows, in [-2^(w-1), 2^(w-1)], select a multiple of P in a
+ *	table of 2^(w-1) + 1 affine points read entirely at every lookup, then negated with a
+ *	conditional move: each window costs w doublings and one mixed addition, and the sequence of
+ *	operations and of memory accesses only depends on the bit length of the order. On curves
+ *	with a GLV endomorphism, the two halves of scalar share the doublings.
+ *	Require: P has the order of ec if ec->glv != NULL,
+ *	scalar has less than (FE_LIMBS + 1) * GMP_LIMB_BITS bits
+ *	\param R		result in Jacobian coordinates
+ *	\param P		affine point
+ *	\param scalar	non-negative big number, secret
+ *	\param ec		pointer to an ec_group structure with fixed-width arithmetic
  */
+void ecp_jac_wmul(ecp_jac *R, const ecp_fe *P, const mpz_t scalar, const ec_group ec) {
+	const int n = (1 << (ECP_SEC_WINDOW - 1)) + 1;
+	mp_limb_t k[2][FE_LIMBS + 1];
+	ecp_jac J[(1 << (ECP_SEC_WINDOW - 1)) + 1];
+	ecp_fe table[(1 << (ECP_SEC_WINDOW - 1)) + 1];
+	int neg[2] = { 0, 0 }, i, bits;
+
+	assert(mpz_sizeinbase(scalar, 2) < (FE_LIMBS + 1) * GMP_LIMB_BITS);
+
+	/* table[i] = i * P, normalized with one inversion */
+	ecp_jac_set_infinity(&J[0], ec);
+	ecp_jac_set_affine(&J[1], P, ec);
+	ecp_jac_dbl(&J[2], &J[1], ec);
+	for (i = 3; i < n; i++)
+		ecp_jac_add_mixed(&J[i], &J[i - 1], P, ec);
+	ecp_jac_batch_get_affine(table, J, n, ec);
+
+	memset(k, 0, sizeof(k));
+	if (ec->glv != NULL) {
+		ec_glv_split(k[0], &neg[0], k[1], &neg[1], scalar, ec);
+		ecp_jac_wmul_n(R, table, (const mp_limb_t (*)[FE_LIMBS + 1]) k, neg, 2, FE_BITS / 2, ec);
+	} else {
+		/* at least one bit more than the order, as the k + order of the signature */
+		bits = mpz_sizeinbase(ec->order, 2) + 1;
+		if ((int) mpz_sizeinbase(scalar, 2) > bits)
+			bits = mpz_sizeinbase(scalar, 2);
+		for (i = 0; i <= FE_LIMBS; i++)
+			k[0][i] = mpz_getlimbn(scalar, i);
+		ecp_jac_wmul_n(R, table, (const mp_limb_t (*)[FE_LIMBS + 1]) k, neg, 1, bits, ec);
+	}
+	memset(k, 0, sizeof(k));
+}
 
-/** This function is implemented by using Montgomery ladder, constant-time/power side channel
- *
+/*-
+ * Double an elliptic curve point on big integers, with the same formulas as ecp_jac_dbl:
+ * X' = M^2 - 2 * S
+ * Y' = M * (S - X') - 8 * Y^4
+ * Z' = 2 * Y * Z
+ * where S = 4 * X * Y^2 and M = 3 * X^2 + a * Z^4, which is 3 * (X - Z^2) * (X + Z^2) if a = -3
+ * and 3 * X^2 if a = 0. R may be equal to P.
+ */
+void ec_point_proj_dbl(ec_point_proj R, const ec_point_proj P, const ec_group ec) {
+	ec_ctx ctx = ec_ctx_thread(ec);
+	mpz_ptr XX, YY, ZZ, S, M, T;
+
+	ec_ctx_start(ctx);
+	XX = ec_ctx_get(ctx); YY = ec_ctx_get(ctx); ZZ = ec_ctx_get(ctx);
+	S = ec_ctx_get(ctx); M = ec_ctx_get(ctx); T = ec_ctx_get(ctx);
+
+	mod_sqr(YY, P->Y, ec->field);		// YY = Y1^2
+
+	mpz_mul(T, P->X, YY);				// S = 4*X1*YY
+	mpz_mul_2exp(T, T, 2);
+	mpz_mod(S, T, ec->field);
+
+	switch (ec->a_form) {				// M = 3*XX + a*ZZ^2
+	case EC_A_MINUS3:
+		mod_sqr(ZZ, P->Z, ec->field);
+		mpz_sub(T, P->X, ZZ);
+		mpz_add(XX, P->X, ZZ);
+		mpz_mul(M, T, XX);
+		mpz_mul_ui(M, M, 3);
+		break;
+	case EC_A_ZERO:
+		mpz_mul(M, P->X, P->X);
+		mpz_mul_ui(M, M, 3);
+		break;
+	default:
+		mod_sqr(ZZ, P->Z, ec->field);
+		mod_sqr(T, ZZ, ec->field);
+		mpz_mul(M, P->X, P->X);
+		mpz_mul_ui(M, M, 3);
+		mpz_addmul(M, T, ec->A);
+		break;
+	}
+	mpz_mod(M, M, ec->field);
+
+	mpz_mul(T, P->Y, P->Z);				// Z3 = 2*Y1*Z1
+	mpz_mul_2exp(T, T, 1);
+	mpz_mod(R->Z, T, ec->field);
+
+	mpz_mul(T, M, M);					// X3 = M^2 - 2*S
+	mpz_submul_ui(T, S, 2);
+	mpz_mod(R->X, T, ec->field);
+
+	mod_sub(T, S, R->X, ec->field);		// Y3 = M*(S - X3) - 8*YY^2
+	mpz_mul(T, M, T);
+	mod_sqr(YY, YY, ec->field);
+	mpz_submul_ui(T, YY, 8);
+	mpz_mod(R->Y, T, ec->field);
+
+	ec_ctx_end(ctx);
+}
+
+/** Add two elliptic curve points on big integers, R = P + Q, with the same formulas as
+ * 	ecp_jac_add. Runs faster if Q->Z = 1 (mixed addition).
+ * 	R may be equal to P or Q.
+ */
+void ec_point_proj_add(ec_point_proj R, const ec_point_proj P, const ec_point_proj Q, const ec_group ec) {
+	ec_ctx ctx;
+	mpz_ptr U1, U2, S1, S2, H, r, HH, HHH, V;
+	int mixed = (mpz_cmp_ui(Q->Z, 1) == 0);
+
+	if (!mpz_sgn(P->Z)) {
+		mpz_set(R->X, Q->X); mpz_set(R->Y, Q->Y); mpz_set(R->Z, Q->Z);
+		return;
+	}
+	if (!mpz_sgn(Q->Z)) {
+		mpz_set(R->X, P->X); mpz_set(R->Y, P->Y); mpz_set(R->Z, P->Z);
+		return;
+	}
+
+	ctx = ec_ctx_thread(ec);
+	ec_ctx_start(ctx);
+	U1 = ec_ctx_get(ctx); U2 = ec_ctx_get(ctx); S1 = ec_ctx_get(ctx); S2 = ec_ctx_get(ctx);
+	H = ec_ctx_get(ctx); r = ec_ctx_get(ctx); HH = ec_ctx_get(ctx); HHH = ec_ctx_get(ctx);
+	V = ec_ctx_get(ctx);
+
+	mod_sqr(HH, P->Z, ec->field);			// Z1^2, Z1^3
+	mod_mul(HHH, HH, P->Z, ec->field);
+	mod_mul(U2, Q->X, HH, ec->field);		// U2 = X2*Z1^2
+	mod_mul(S2, Q->Y, HHH, ec->field);		// S2 = Y2*Z1^3
+	if (mixed) {
+		mpz_set(U1, P->X);
+		mpz_set(S1, P->Y);
+	} else {
+		mod_sqr(HH, Q->Z, ec->field);		// Z2^2, Z2^3
+		mod_mul(HHH, HH, Q->Z, ec->field);
+		mod_mul(U1, P->X, HH, ec->field);	// U1 = X1*Z2^2
+		mod_mul(S1, P->Y, HHH, ec->field);	// S1 = Y1*Z2^3
+	}
+
+	mod_sub(H, U2, U1, ec->field);
+	mod_sub(r, S2, S1, ec->field);
+
+	if (!mpz_sgn(H)) {
+		if (!mpz_sgn(r))
+			ec_point_proj_dbl(R, P, ec);
+		else
+			ec_point_proj_set_at_infinity(R);
+		goto end;
+	}
+
+	mod_sqr(HH, H, ec->field);
+	mod_mul(HHH, HH, H, ec->field);
+	mod_mul(V, U1, HH, ec->field);
+
+	mpz_mul(U2, P->Z, H);						// Z3 = Z1*Z2*H
+	if (!mixed)
+		mpz_mul(U2, U2, Q->Z);
+	mpz_mod(R->Z, U2, ec->field);
+
+	mpz_mul(U2, r, r);							// X3 = r^2 - H^3 - 2*U1*H^2
+	mpz_sub(U2, U2, HHH);
+	mpz_submul_ui(U2, V, 2);
+	mpz_mod(R->X, U2, ec->field);
+
+	mod_sub(V, V, R->X, ec->field);				// Y3 = r*(U1*H^2 - X3) - S1*H^3
+	mpz_mul(U2, r, V);
+	mpz_submul(U2, S1, HHH);
+	mpz_mod(R->Y, U2, ec->field);
+
+end:
+	ec_ctx_end(ctx);
+}
+
+/**	Compute point multiplication R = scalar * P on big integers, using left-to-right
+ *	double-and-add-always with mixed additions, as ecp_jac_mul.
+ * 	\param R		pointer to an ec_point_proj structure
+ * 	\param P		pointer to an ec_point_proj structure with Z = 1
+ * 	\param scalar	non-negative big number
+ * 	\param group	pointer to an ec_group structure
  */
-ec_point_proj ec_point_proj_mul(ec_point_proj P, mpz_t scalar, ec_group group) {
-	mpz_t field, a;
-	mpz_init_set(field, group->field);
-	mpz_init_set(a, group->A);
+void ec_point_proj_mul(ec_point_proj R, const ec_point_proj P, const mpz_t scalar, const ec_group group) {
+	ec_point_proj T[2];
+	int i;
+
+	ec_point_proj_set_at_infinity(R);
+	if (!mpz_sgn(scalar))
+		return;
+
+	T[0] = ec_point_proj_init_set_mpz(P->X, P->Y, P->Z);
+	T[1] = ec_point_proj_init();
+
+	for (i = mpz_sizeinbase(scalar, 2) - 2; i >= 0; i--) {
+		ec_point_proj_dbl(T[0], T[0], group);
+		ec_point_proj_add(T[1], T[0], P, group);
+		mpz_swap(T[0]->X, T[mpz_tstbit(scalar, i)]->X);
+		mpz_swap(T[0]->Y, T[mpz_tstbit(scalar, i)]->Y);
+		mpz_swap(T[0]->Z, T[mpz_tstbit(scalar, i)]->Z);
+	}
 
-	ec_point_proj R[2];
-	// Initialize the point R
-	R[0] = ec_point_proj_init();
-	R[1] = ec_point_proj_init_set_mpz(P->X, P->Y, P->Z);
+	mpz_set(R->X, T[0]->X); mpz_set(R->Y, T[0]->Y); mpz_set(R->Z, T[0]->Z);
+	ec_point_proj_free(T[0]); ec_point_proj_free(T[1]);
+}
 
-	int k = mpz_sizeinbase(scalar, 2); //Set k = bit length of the exponent
+/* Convert an affine point to Jacobian coordinates, (x, y) -> (x : y : 1) */
+void ec_point_proj_set_point(ec_point_proj R, const ec_point P) {
+	if (P->infinity) {
+		mpz_set_ui(R->X, 1); mpz_set_ui(R->Y, 1);
+		ec_point_proj_set_at_infinity(R);
+	} else {
+		mpz_set(R->X, P->x); mpz_set(R->Y, P->y); mpz_set_ui(R->Z, 1);
+	}
+}
 
-	int b, nb;
-	for(int i = k - 1; i >= 0; i--) {
-		b = mpz_tstbit(scalar, i);
-		nb = 1 - b;
+/* Convert a Jacobian point to affine coordinates, with one inversion */
+void ec_point_proj_get_point(ec_point R, const ec_point_proj P, const ec_group ec) {
+	ec_ctx ctx;
+	mpz_ptr zinv, zinv2;
 
-		ec_point_proj_add(R[nb], R[nb], R[b], group);
-		ec_point_proj_dbl(R[b], R[b], group);
+	if (!mpz_sgn(P->Z)) {
+		ec_point_set_at_infinity(R);
+		return;
 	}
 
+	ctx = ec_ctx_thread(ec);
+	ec_ctx_start(ctx);
+	zinv = ec_ctx_get(ctx); zinv2 = ec_ctx_get(ctx);
+	mpz_invert(zinv, P->Z, ec->field);
+	mod_sqr(zinv2, zinv, ec->field);
+	mod_mul(R->x, P->X, zinv2, ec->field);
+	mod_mul(zinv2, zinv2, zinv, ec->field);
+	mod_mul(R->y, P->Y, zinv2, ec->field);
+	R->infinity = false;
+	ec_ctx_end(ctx);
+}
 
-	return R[0];
+/**	Compute point multiplication in Jacobian coordinates, one inversion at the end.
+ *	Uses the fixed-width engine when the group has one.
+ * 	\param P		pointer to an ec_point structure
+ * 	\param scalar	non-negative big number
+ * 	\param ec		pointer to an ec_group structure
+ * 	\return 		pointer to an ec_point structure, scalar * P
+ */
+ec_point ecp_mul_proj(const ec_point P, const mpz_t scalar, ec_group ec) {
+	ec_point Rop = ec_point_init();
+
+	if (ec->fp != NULL) {
+		ecp_fe Pa, Ra;
+		ecp_jac R;
+
+		ecp_fe_set_point(&Pa, P, ec);
+		ecp_jac_mul(&R, &Pa, scalar, ec);
+		ecp_jac_get_affine(&Ra, &R, ec);
+		ecp_fe_get_point(Rop, &Ra, ec);
+	} else {
+		ec_point_proj Pj = ec_point_proj_init(), R = ec_point_proj_init();
+
+		ec_point_proj_set_point(Pj, P);
+		ec_point_proj_mul(R, Pj, scalar, ec);
+		ec_point_proj_get_point(Rop, R, ec);
+		ec_point_proj_free(Pj); ec_point_proj_free(R);
+	}
+	return Rop;
+}
+
+/**	Compute k * P + l * Q in Jacobian coordinates, one inversion at the end
+ * 	\return 		pointer to an ec_point structure
+ */
+ec_point ecp_mul2_proj(const ec_point P, const mpz_t k, const ec_point Q, const mpz_t l, ec_group ec) {
+	ec_point Rop = ec_point_init();
+
+	if (ec->fp != NULL) {
+		ecp_fe Pa, Qa, Ra;
+		ecp_jac R, T;
+
+		ecp_fe_set_point(&Pa, P, ec);
+		ecp_fe_set_point(&Qa, Q, ec);
+		ecp_jac_mul(&R, &Pa, k, ec);
+		ecp_jac_mul(&T, &Qa, l, ec);
+		ecp_jac_add(&R, &R, &T, ec);
+		ecp_jac_get_affine(&Ra, &R, ec);
+		ecp_fe_get_point(Rop, &Ra, ec);
+	} else {
+		ec_point_proj Pj = ec_point_proj_init(), R = ec_point_proj_init(), T = ec_point_proj_init();
+
+		ec_point_proj_set_point(Pj, P);
+		ec_point_proj_mul(R, Pj, k, ec);
+		ec_point_proj_set_point(Pj, Q);
+		ec_point_proj_mul(T, Pj, l, ec);
+		ec_point_proj_add(R, R, T, ec);
+		ec_point_proj_get_point(Rop, R, ec);
+		ec_point_proj_free(Pj); ec_point_proj_free(R); ec_point_proj_free(T);
+	}
+	return Rop;
 }
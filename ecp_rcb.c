@@ -0,0 +1,345 @@
+/*
+ * ecp_rcb.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+#include "ec_point.h"
+#include "fe_ops.h"
+
+/*-
+ * Complete addition formulas of Renes, Costello and Batina ("Complete addition formulas for prime
+ * order elliptic curves", 2016) in homogeneous projective coordinates, (X : Y : Z) representing
+ * (X/Z, Y/Z) and (0 : 1 : 0) the point at infinity.
+ *
+ * On a curve of odd order, the same formulas compute P + Q for all inputs: P = Q, P = -Q and
+ * the point at infinity need no special case, so there is no branch and no inversion. Each form
+ * of A has its own sequences: Algorithm 1 for any A, which also doubles, 4 and 6 for A = -3,
+ * 7 and 9 for A = 0, with b3 = 3 * B. An addition costs 12 multiplications, 15 for any A.
+ */
+
+/* b3 = 3 * B */
+static void ecp_hom_b3(fe_t b3, const ec_group ec) {
+	fe_add(b3, ec->fe_b, ec->fe_b, ec->fp);
+	fe_add(b3, b3, ec->fe_b, ec->fp);
+}
+
+/* Algorithm 1, any A */
+static void ecp_hom_add_generic(ecp_hom *R, const ecp_hom *P, const ecp_hom *Q, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t t0, t1, t2, t3, t4, t5, X3, Y3, Z3, b3;
+
+	ecp_hom_b3(b3, ec);
+	fe_mul(t0, P->X, Q->X, f);
+	fe_mul(t1, P->Y, Q->Y, f);
+	fe_mul(t2, P->Z, Q->Z, f);
+	fe_add(t3, P->X, P->Y, f);
+	fe_add(t4, Q->X, Q->Y, f);
+	fe_mul(t3, t3, t4, f);
+	fe_add(t4, t0, t1, f);
+	fe_sub(t3, t3, t4, f);
+	fe_add(t4, P->X, P->Z, f);
+	fe_add(t5, Q->X, Q->Z, f);
+	fe_mul(t4, t4, t5, f);
+	fe_add(t5, t0, t2, f);
+	fe_sub(t4, t4, t5, f);
+	fe_add(t5, P->Y, P->Z, f);
+	fe_add(X3, Q->Y, Q->Z, f);
+	fe_mul(t5, t5, X3, f);
+	fe_add(X3, t1, t2, f);
+	fe_sub(t5, t5, X3, f);
+	fe_mul(Z3, ec->fe_a, t4, f);
+	fe_mul(X3, b3, t2, f);
+	fe_add(Z3, X3, Z3, f);
+	fe_sub(X3, t1, Z3, f);
+	fe_add(Z3, t1, Z3, f);
+	fe_mul(Y3, X3, Z3, f);
+	fe_add(t1, t0, t0, f);
+	fe_add(t1, t1, t0, f);
+	fe_mul(t2, ec->fe_a, t2, f);
+	fe_mul(t4, b3, t4, f);
+	fe_add(t1, t1, t2, f);
+	fe_sub(t2, t0, t2, f);
+	fe_mul(t2, ec->fe_a, t2, f);
+	fe_add(t4, t4, t2, f);
+	fe_mul(t0, t1, t4, f);
+	fe_add(Y3, Y3, t0, f);
+	fe_mul(t0, t5, t4, f);
+	fe_mul(X3, t3, X3, f);
+	fe_sub(X3, X3, t0, f);
+	fe_mul(t0, t3, t1, f);
+	fe_mul(Z3, t5, Z3, f);
+	fe_add(Z3, Z3, t0, f);
+
+	fe_copy(R->X, X3); fe_copy(R->Y, Y3); fe_copy(R->Z, Z3);
+}
+
+/* Algorithm 4, A = -3 */
+static void ecp_hom_add_minus3(ecp_hom *R, const ecp_hom *P, const ecp_hom *Q, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t t0, t1, t2, t3, t4, X3, Y3, Z3;
+
+	fe_mul(t0, P->X, Q->X, f);
+	fe_mul(t1, P->Y, Q->Y, f);
+	fe_mul(t2, P->Z, Q->Z, f);
+	fe_add(t3, P->X, P->Y, f);
+	fe_add(t4, Q->X, Q->Y, f);
+	fe_mul(t3, t3, t4, f);
+	fe_add(t4, t0, t1, f);
+	fe_sub(t3, t3, t4, f);
+	fe_add(t4, P->Y, P->Z, f);
+	fe_add(X3, Q->Y, Q->Z, f);
+	fe_mul(t4, t4, X3, f);
+	fe_add(X3, t1, t2, f);
+	fe_sub(t4, t4, X3, f);
+	fe_add(X3, P->X, P->Z, f);
+	fe_add(Y3, Q->X, Q->Z, f);
+	fe_mul(X3, X3, Y3, f);
+	fe_add(Y3, t0, t2, f);
+	fe_sub(Y3, X3, Y3, f);
+	fe_mul(Z3, ec->fe_b, t2, f);
+	fe_sub(X3, Y3, Z3, f);
+	fe_add(Z3, X3, X3, f);
+	fe_add(X3, X3, Z3, f);
+	fe_sub(Z3, t1, X3, f);
+	fe_add(X3, t1, X3, f);
+	fe_mul(Y3, ec->fe_b, Y3, f);
+	fe_add(t1, t2, t2, f);
+	fe_add(t2, t1, t2, f);
+	fe_sub(Y3, Y3, t2, f);
+	fe_sub(Y3, Y3, t0, f);
+	fe_add(t1, Y3, Y3, f);
+	fe_add(Y3, t1, Y3, f);
+	fe_add(t1, t0, t0, f);
+	fe_add(t0, t1, t0, f);
+	fe_sub(t0, t0, t2, f);
+	fe_mul(t1, t4, Y3, f);
+	fe_mul(t2, t0, Y3, f);
+	fe_mul(Y3, X3, Z3, f);
+	fe_add(Y3, Y3, t2, f);
+	fe_mul(X3, t3, X3, f);
+	fe_sub(X3, X3, t1, f);
+	fe_mul(Z3, t4, Z3, f);
+	fe_mul(t1, t3, t0, f);
+	fe_add(Z3, Z3, t1, f);
+
+	fe_copy(R->X, X3); fe_copy(R->Y, Y3); fe_copy(R->Z, Z3);
+}
+
+/* Algorithm 7, A = 0 */
+static void ecp_hom_add_zero(ecp_hom *R, const ecp_hom *P, const ecp_hom *Q, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t t0, t1, t2, t3, t4, X3, Y3, Z3, b3;
+
+	ecp_hom_b3(b3, ec);
+	fe_mul(t0, P->X, Q->X, f);
+	fe_mul(t1, P->Y, Q->Y, f);
+	fe_mul(t2, P->Z, Q->Z, f);
+	fe_add(t3, P->X, P->Y, f);
+	fe_add(t4, Q->X, Q->Y, f);
+	fe_mul(t3, t3, t4, f);
+	fe_add(t4, t0, t1, f);
+	fe_sub(t3, t3, t4, f);
+	fe_add(t4, P->Y, P->Z, f);
+	fe_add(X3, Q->Y, Q->Z, f);
+	fe_mul(t4, t4, X3, f);
+	fe_add(X3, t1, t2, f);
+	fe_sub(t4, t4, X3, f);
+	fe_add(X3, P->X, P->Z, f);
+	fe_add(Y3, Q->X, Q->Z, f);
+	fe_mul(X3, X3, Y3, f);
+	fe_add(Y3, t0, t2, f);
+	fe_sub(Y3, X3, Y3, f);
+	fe_add(X3, t0, t0, f);
+	fe_add(t0, X3, t0, f);
+	fe_mul(t2, b3, t2, f);
+	fe_add(Z3, t1, t2, f);
+	fe_sub(t1, t1, t2, f);
+	fe_mul(Y3, b3, Y3, f);
+	fe_mul(X3, t4, Y3, f);
+	fe_mul(t2, t3, t1, f);
+	fe_sub(X3, t2, X3, f);
+	fe_mul(Y3, Y3, t0, f);
+	fe_mul(t1, t1, Z3, f);
+	fe_add(Y3, t1, Y3, f);
+	fe_mul(t0, t0, t3, f);
+	fe_mul(Z3, Z3, t4, f);
+	fe_add(Z3, Z3, t0, f);
+
+	fe_copy(R->X, X3); fe_copy(R->Y, Y3); fe_copy(R->Z, Z3);
+}
+
+/* Algorithm 6, A = -3 */
+static void ecp_hom_dbl_minus3(ecp_hom *R, const ecp_hom *P, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t t0, t1, t2, t3, X3, Y3, Z3;
+
+	fe_sqr(t0, P->X, f);
+	fe_sqr(t1, P->Y, f);
+	fe_sqr(t2, P->Z, f);
+	fe_mul(t3, P->X, P->Y, f);
+	fe_add(t3, t3, t3, f);
+	fe_mul(Z3, P->X, P->Z, f);
+	fe_add(Z3, Z3, Z3, f);
+	fe_mul(Y3, ec->fe_b, t2, f);
+	fe_sub(Y3, Y3, Z3, f);
+	fe_add(X3, Y3, Y3, f);
+	fe_add(Y3, X3, Y3, f);
+	fe_sub(X3, t1, Y3, f);
+	fe_add(Y3, t1, Y3, f);
+	fe_mul(Y3, X3, Y3, f);
+	fe_mul(X3, X3, t3, f);
+	fe_add(t3, t2, t2, f);
+	fe_add(t2, t2, t3, f);
+	fe_mul(Z3, ec->fe_b, Z3, f);
+	fe_sub(Z3, Z3, t2, f);
+	fe_sub(Z3, Z3, t0, f);
+	fe_add(t3, Z3, Z3, f);
+	fe_add(Z3, Z3, t3, f);
+	fe_add(t3, t0, t0, f);
+	fe_add(t0, t3, t0, f);
+	fe_sub(t0, t0, t2, f);
+	fe_mul(t0, t0, Z3, f);
+	fe_add(Y3, Y3, t0, f);
+	fe_mul(t0, P->Y, P->Z, f);
+	fe_add(t0, t0, t0, f);
+	fe_mul(Z3, t0, Z3, f);
+	fe_sub(X3, X3, Z3, f);
+	fe_mul(Z3, t0, t1, f);
+	fe_add(Z3, Z3, Z3, f);
+	fe_add(Z3, Z3, Z3, f);
+
+	fe_copy(R->X, X3); fe_copy(R->Y, Y3); fe_copy(R->Z, Z3);
+}
+
+/* Algorithm 9, A = 0 */
+static void ecp_hom_dbl_zero(ecp_hom *R, const ecp_hom *P, const ec_group ec) {
+	const fe_field f = ec->fp;
+	fe_t t0, t1, t2, X3, Y3, Z3, b3;
+
+	ecp_hom_b3(b3, ec);
+	fe_sqr(t0, P->Y, f);
+	fe_add(Z3, t0, t0, f);
+	fe_add(Z3, Z3, Z3, f);
+	fe_add(Z3, Z3, Z3, f);
+	fe_mul(t1, P->Y, P->Z, f);
+	fe_sqr(t2, P->Z, f);
+	fe_mul(t2, b3, t2, f);
+	fe_mul(X3, t2, Z3, f);
+	fe_add(Y3, t0, t2, f);
+	fe_mul(Z3, t1, Z3, f);
+	fe_add(t1, t2, t2, f);
+	fe_add(t2, t1, t2, f);
+	fe_sub(t0, t0, t2, f);
+	fe_mul(Y3, t0, Y3, f);
+	fe_add(Y3, X3, Y3, f);
+	fe_mul(t1, P->X, P->Y, f);
+	fe_mul(X3, t0, t1, f);
+	fe_add(X3, X3, X3, f);
+
+	fe_copy(R->X, X3); fe_copy(R->Y, Y3); fe_copy(R->Z, Z3);
+}
+
+/** Compute R = P + Q with the complete formulas of the form of A, for all P and Q. R may alias
+ *	P or Q. Require: ec->fp != NULL, the order of the curve is odd
+ */
+void ecp_hom_add(ecp_hom *R, const ecp_hom *P, const ecp_hom *Q, const ec_group ec) {
+	switch (ec->a_form) {
+	case EC_A_MINUS3:
+		ecp_hom_add_minus3(R, P, Q, ec);
+		break;
+	case EC_A_ZERO:
+		ecp_hom_add_zero(R, P, Q, ec);
+		break;
+	default:
+		ecp_hom_add_generic(R, P, Q, ec);
+		break;
+	}
+}
+
+/** Compute R = 2P, with the dedicated formulas for A = -3 and A = 0 and the addition otherwise.
+ *	R may alias P
+ */
+void ecp_hom_dbl(ecp_hom *R, const ecp_hom *P, const ec_group ec) {
+	switch (ec->a_form) {
+	case EC_A_MINUS3:
+		ecp_hom_dbl_minus3(R, P, ec);
+		break;
+	case EC_A_ZERO:
+		ecp_hom_dbl_zero(R, P, ec);
+		break;
+	default:
+		ecp_hom_add_generic(R, P, P, ec);
+		break;
+	}
+}
+
+/* Convert an affine point to (x : y : 1), or (0 : 1 : 0) for the point at infinity, without branch */
+void ecp_hom_set_affine(ecp_hom *R, const ecp_fe *P, const ec_group ec) {
+	fe_t zero, one;
+
+	fe_set_zero(zero);
+	fe_set_one(one, ec->fp);
+	fe_copy(R->X, P->x);
+	fe_copy(R->Y, P->y);
+	fe_copy(R->Z, one);
+	fe_cmov(R->X, zero, P->infinity);
+	fe_cmov(R->Y, one, P->infinity);
+	fe_cmov(R->Z, zero, P->infinity);
+}
+
+/* Convert to affine coordinates (X/Z, Y/Z) with one inversion, Z = 0 giving the point at infinity */
+void ecp_hom_get_affine(ecp_fe *R, const ecp_hom *P, const ec_group ec) {
+	fe_t zinv;
+
+	R->infinity = fe_is_zero(P->Z);
+	fe_inv(zinv, P->Z, ec->fp);
+	fe_mul(R->x, P->X, zinv, ec->fp);
+	fe_mul(R->y, P->Y, zinv, ec->fp);
+}
+
+/* Swap P and Q if flag = 1, leave them unchanged if flag = 0, in data-independent time */
+void ecp_hom_cswap(ecp_hom *P, ecp_hom *Q, int flag) {
+	ecp_hom T = *P;
+
+	fe_cmov(P->X, Q->X, flag);
+	fe_cmov(P->Y, Q->Y, flag);
+	fe_cmov(P->Z, Q->Z, flag);
+	fe_cmov(Q->X, T.X, flag);
+	fe_cmov(Q->Y, T.Y, flag);
+	fe_cmov(Q->Z, T.Z, flag);
+}
+
+/** Compute R = scalar * P with the Montgomery ladder on the complete formulas: every bit costs
+ *	one addition, one doubling and two conditional swaps, with neither branch nor inversion.
+ *	The number of steps is the bit length of the order, or of scalar if it is longer.
+ *	\param R		result in homogeneous projective coordinates
+ *	\param P		affine point
+ *	\param scalar	non-negative big number, secret
+ *	\param ec		pointer to an ec_group structure with fixed-width arithmetic
+ */
+void ecp_hom_ladder(ecp_hom *R, const ecp_fe *P, const mpz_t scalar, const ec_group ec) {
+	ecp_hom R1;
+	int i, bit, bits;
+	ecp_fe O;
+
+	bits = mpz_sizeinbase(ec->order, 2);
+	if ((int) mpz_sizeinbase(scalar, 2) > bits)
+		bits = mpz_sizeinbase(scalar, 2);
+
+	memset(&O, 0, sizeof(ecp_fe));
+	O.infinity = 1;
+	ecp_hom_set_affine(R, &O, ec);
+	ecp_hom_set_affine(&R1, P, ec);
+
+	/* invariant R1 = R + P */
+	for (i = bits - 1; i >= 0; i--) {
+		bit = mpz_tstbit(scalar, i);
+		ecp_hom_cswap(R, &R1, bit);
+		ecp_hom_add(&R1, R, &R1, ec);
+		ecp_hom_dbl(R, R, ec);
+		ecp_hom_cswap(R, &R1, bit);
+	}
+}
@@ -0,0 +1,249 @@
+/*
+ * ecp_wnaf.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+#include "ec.h"
+#include "ec_point.h"
+#include "fe_ops.h"
+
+/*-
+ * Variable-time multiplications with the width-w non-adjacent form (wNAF) of the scalars.
+ * The scalar k = sum_i naf[i] * 2^i where every non-zero digit is odd, |naf[i]| < 2^(w-1), and
+ * any w consecutive digits contain at most one non-zero digit. The odd multiples P, 3P, ...,
+ * (2^(w-1) - 1)P are precomputed in affine coordinates, a negative digit uses -P = (x, -y).
+ *
+ * The running time depends on the scalars: only for public inputs, such as the verification
+ * of signatures.
+ */
+
+/* Return the integer of the bits [i, i + count) of k */
+static int ecp_wnaf_bits(const mpz_t k, int i, int count) {
+	int j, r = 0;
+
+	for (j = 0; j < count; j++)
+		r |= mpz_tstbit(k, i + j) << j;
+	return r;
+}
+
+/** Compute the width-w NAF of k >= 0
+ *	\param naf	array of at least mpz_sizeinbase(k, 2) + 1 digits
+ *	\param k	non-negative big number
+ *	\param w	width, 2 <= w <= 16
+ *	\return		number of digits, i.e. the index of the top non-zero digit plus one
+ */
+int ecp_wnaf_recode(int *naf, const mpz_t k, int w) {
+	int len = mpz_sizeinbase(k, 2) + 1, last = 0, carry = 0, i = 0, now, word;
+
+	memset(naf, 0, len * sizeof(int));
+	if (!mpz_sgn(k))
+		return 0;
+
+	while (i < len) {
+		if (mpz_tstbit(k, i) == carry) {
+			i++;
+			continue;
+		}
+
+		now = w;
+		if (now > len - i)
+			now = len - i;
+		word = ecp_wnaf_bits(k, i, now) + carry;
+
+		/* digits above 2^(w-1) become negative, the difference carries to the next window */
+		carry = (word >> (w - 1)) & 1;
+		word -= carry << w;
+
+		naf[i] = word;
+		last = i;
+		i += now;
+	}
+
+	return last + 1;
+}
+
+/** Compute the odd multiples T[i] = (2i + 1) * P, i = 0 .. n - 1, in affine coordinates,
+ *	with a single inversion
+ *	\param T	array of n affine points
+ *	\param P	affine point
+ */
+void ecp_wnaf_odd_multiples(ecp_fe *T, const ecp_fe *P, int n, const ec_group ec) {
+	ecp_jac *J, P2;
+	int i;
+
+	J = malloc(n * sizeof(ecp_jac));
+	assert(J != NULL);
+
+	ecp_jac_set_affine(&J[0], P, ec);
+	ecp_jac_dbl(&P2, &J[0], ec);
+	for (i = 1; i < n; i++)
+		ecp_jac_add(&J[i], &J[i - 1], &P2, ec);
+	ecp_jac_batch_get_affine(T, J, n, ec);
+
+	free(J);
+}
+
+/* R = R + digit * P, digit odd or 0, T the odd multiples of P */
+static void ecp_wnaf_add_digit(ecp_jac *R, const ecp_fe *T, int digit, const ec_group ec) {
+	ecp_fe Q;
+
+	if (digit > 0) {
+		ecp_jac_add_mixed(R, R, &T[digit >> 1], ec);
+	} else if (digit < 0) {
+		Q = T[(-digit) >> 1];
+		fe_neg(Q.y, Q.y, ec->fp);
+		ecp_jac_add_mixed(R, R, &Q, ec);
+	}
+}
+
+/* R = sum_i (-1)^neg[i] * k_i * P_i, naf[i] the len[i] digits of k_i and T[i] the odd multiples of
+ * P_i: the doublings are shared by the n scalars */
+static void ecp_wnaf_interleave(ecp_jac *R, int n, int (*naf)[FE_BITS + 2], const int *len,
+		const ecp_fe *const *T, const int *neg, const ec_group ec) {
+	int i, j, top = 0;
+
+	for (j = 0; j < n; j++)
+		if (len[j] > top)
+			top = len[j];
+
+	ecp_jac_set_infinity(R, ec);
+	for (i = top - 1; i >= 0; i--) {
+		if (!fe_is_zero(R->Z))
+			ecp_jac_dbl(R, R, ec);
+		for (j = 0; j < n; j++)
+			if (i < len[j])
+				ecp_wnaf_add_digit(R, T[j], neg[j] ? -naf[j][i] : naf[j][i], ec);
+	}
+}
+
+/** Compute R = k * P with the width-w NAF of k: about bits / (w + 1) mixed additions with the
+ *	odd multiples of P. On curves with a GLV endomorphism (ec->glv), k < order is split in halves
+ *	multiplying P and phi(P), with half the doublings. The split reduces k modulo the order and
+ *	uses phi(P) = lambda * P, so k >= order, e.g. the order itself when a key is validated, is
+ *	multiplied without it. Variable time.
+ *	Require: k has at most FE_BITS bits, P in the subgroup of prime order when ec->glv != NULL
+ *	\param TP	odd multiples of P, 2^(w-2) entries, see ecp_wnaf_odd_multiples
+ *	\param w	width of the NAF of k
+ */
+void ecp_wnaf_mul(ecp_jac *R, const mpz_t k, const ecp_fe *TP, int w, const ec_group ec) {
+	int naf[2][FE_BITS + 2], len[2], neg[2] = { 0, 0 };
+	const ecp_fe *T[2] = { TP, NULL };
+	ecp_fe *TE = NULL;
+	fe_t h[2];
+	mpz_t z;
+	int i, n = 1 << (w - 2);
+
+	if (ec->glv == NULL || mpz_cmp(k, ec->order) >= 0) {
+		len[0] = ecp_wnaf_recode(naf[0], k, w);
+		ecp_wnaf_interleave(R, 1, naf, len, T, neg, ec);
+		return;
+	}
+
+	TE = malloc(n * sizeof(ecp_fe));
+	assert(TE != NULL);
+	for (i = 0; i < n; i++)
+		ecp_glv_endo(&TE[i], &TP[i], ec);
+	T[1] = TE;
+
+	ec_glv_split(h[0], &neg[0], h[1], &neg[1], k, ec);
+	for (i = 0; i < 2; i++)
+		len[i] = ecp_wnaf_recode(naf[i], mpz_roinit_n(z, h[i], FE_LIMBS), w);
+	ecp_wnaf_interleave(R, 2, naf, len, T, neg, ec);
+	free(TE);
+}
+
+/* R = k * P + l * Q on a curve with an endomorphism: both scalars are split in halves, the four
+ * half-length scalars multiply P, phi(P), Q and phi(Q) */
+static void ecp_wnaf_mul2_glv(ecp_jac *R, const mpz_t k, const ecp_fe *TP, int wp, const mpz_t l,
+		const ecp_fe *TQ, int wq, const ec_group ec) {
+	int naf[4][FE_BITS + 2], len[4], neg[4], w[4] = { wp, wp, wq, wq };
+	int np = 1 << (wp - 2), nq = 1 << (wq - 2), i;
+	const ecp_fe *T[4];
+	ecp_fe *TE;
+	fe_t h[4];
+	mpz_t z;
+
+	/* odd multiples of phi(P) and phi(Q) */
+	TE = malloc((np + nq) * sizeof(ecp_fe));
+	assert(TE != NULL);
+	for (i = 0; i < np; i++)
+		ecp_glv_endo(&TE[i], &TP[i], ec);
+	for (i = 0; i < nq; i++)
+		ecp_glv_endo(&TE[np + i], &TQ[i], ec);
+	T[0] = TP; T[1] = TE; T[2] = TQ; T[3] = TE + np;
+
+	ec_glv_split(h[0], &neg[0], h[1], &neg[1], k, ec);
+	ec_glv_split(h[2], &neg[2], h[3], &neg[3], l, ec);
+	for (i = 0; i < 4; i++)
+		len[i] = ecp_wnaf_recode(naf[i], mpz_roinit_n(z, h[i], FE_LIMBS), w[i]);
+
+	ecp_wnaf_interleave(R, 4, naf, len, T, neg, ec);
+	free(TE);
+}
+
+/** Compute R = k * P + l * Q with interleaved wNAF (Shamir/Strauss): the doublings are shared by
+ *	both scalars. On curves with a GLV endomorphism (ec->glv), the scalars are split in halves and
+ *	four scalars of half the length are interleaved, with half the doublings, unless k or l is
+ *	at least the order (see ecp_wnaf_mul). Variable time.
+ *	Require: k, l have at most FE_BITS bits, P and Q of order dividing the order of ec when
+ *	ec->glv != NULL
+ *	\param TP, TQ	odd multiples of P and Q, 2^(wp-2) and 2^(wq-2) entries
+ *	\param wp, wq	widths of the NAF of k and l
+ */
+void ecp_wnaf_mul2(ecp_jac *R, const mpz_t k, const ecp_fe *TP, int wp, const mpz_t l, const ecp_fe *TQ, int wq,
+		const ec_group ec) {
+	int naf[2][FE_BITS + 2], len[2], neg[2] = { 0, 0 };
+	const ecp_fe *T[2] = { TP, TQ };
+
+	if (ec->glv != NULL && mpz_cmp(k, ec->order) < 0 && mpz_cmp(l, ec->order) < 0) {
+		ecp_wnaf_mul2_glv(R, k, TP, wp, l, TQ, wq, ec);
+		return;
+	}
+
+	len[0] = ecp_wnaf_recode(naf[0], k, wp);
+	len[1] = ecp_wnaf_recode(naf[1], l, wq);
+	ecp_wnaf_interleave(R, 2, naf, len, T, neg, ec);
+}
+
+/**	Compute scalar * P with the width-w NAF of scalar and a table of 2^(w-2) odd multiples of P,
+ *	normalized with a single inversion. Variable time: only for public scalars, such as the
+ *	verification of signatures and the validation of keys, never for private keys or nonces.
+ *	Falls back to ecp_mul_proj for groups without fixed-width arithmetic.
+ *	On curves with a GLV endomorphism, the result for scalar < order is only defined for P in the
+ *	subgroup of prime order; scalar >= order skips the endomorphism and is valid for any P.
+ *	\param P		pointer to an ec_point structure, on the curve
+ *	\param scalar	non-negative big number
+ *	\param w		width of the NAF, 2 <= w <= ECP_WNAF_MAX_WINDOW, or 0 for ECP_WNAF_WINDOW
+ *	\param ec		pointer to an ec_group structure
+ *	\return 		pointer to an ec_point structure
+ */
+ec_point ecp_mul_wnaf(const ec_point P, const mpz_t scalar, int w, ec_group ec) {
+	ec_point Rop;
+	ecp_fe Pa, Ra, *T;
+	ecp_jac R;
+
+	if (w == 0)
+		w = ECP_WNAF_WINDOW;
+	assert(w >= 2 && w <= ECP_WNAF_MAX_WINDOW);
+	if (ec->fp == NULL || mpz_sgn(scalar) < 0 || mpz_sizeinbase(scalar, 2) > FE_BITS)
+		return ecp_mul_proj(P, scalar, ec);
+
+	Rop = ec_point_init();
+	if (P->infinity || !mpz_sgn(scalar)) {
+		ec_point_set_at_infinity(Rop);
+		return Rop;
+	}
+
+	T = malloc((1 << (w - 2)) * sizeof(ecp_fe));
+	assert(T != NULL);
+	ecp_fe_set_point(&Pa, P, ec);
+	ecp_wnaf_odd_multiples(T, &Pa, 1 << (w - 2), ec);
+	ecp_wnaf_mul(&R, scalar, T, w, ec);
+	ecp_jac_get_affine(&Ra, &R, ec);
+	ecp_fe_get_point(Rop, &Ra, ec);
+	free(T);
+	return Rop;
+}
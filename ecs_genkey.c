@@ -31,7 +31,12 @@ int ec_key_generate_key(ec_key eckey, int genpub){
 		mpz_init(c); mpz_init(tmp); mpz_init(order);
 		ec_group_get_order(eckey->group, order);
 		gmp_randstate_t state;
-		gmp_randinit_mt(state);
+		if (!ecs_rand_init(state)) {
+			fprintf(stdout, "EC_F_EC_KEY_GENERATE_KEY, ERR_R_RAND_LIB");
+			gmp_randclear(state);
+			mpz_clear(c); mpz_clear(tmp); mpz_clear(order); mpz_clear(priv_key);
+			return (ok);
+		}
 
 		int N = mpz_sizeinbase(order, 2);	/* Get the size in bits of the order of the group of points */
 
@@ -53,12 +58,13 @@ int ec_key_generate_key(ec_key eckey, int genpub){
 		mpz_add_ui(priv_key, c, 1);	// priv_key = c + 1
 
 		mpz_set(eckey->priv_key, priv_key);
+		gmp_randclear(state);
 		mpz_clear(c); mpz_clear(tmp); mpz_clear(order);
 
 	} else { // Given private key, generate the public key
 		ec_group group = ec_key_get_group(eckey);
 		mpz_set(priv_key, eckey->priv_key);
-		ec_point pub_key = ecp_mul_atomic(group->generator, priv_key, group);
+		ec_point pub_key = ecp_mul_base(priv_key, group);
 
 		//Print compressed public key
 		char* pub_str = ec_point_compress(pub_key);
@@ -92,5 +98,16 @@ int ec_key_generate_key(ec_key eckey, int genpub){
  */
 int ec_key_precompute_mult(ec_key key) {
 
+	if (key == NULL || key->group == NULL) {
+		fprintf(stdout, "EC_F_EC_KEY_PRECOMPUTE_MULT, ERR_R_PASSED_NULL_PARAMETER");
+		return 0;
+	}
+
+	/* the table is built once per curve and shared, see ecp_comb.c */
+	if (ecp_comb_get(key->group) == NULL) {
+		fprintf(stdout, "EC_F_EC_KEY_PRECOMPUTE_MULT, EC_R_NOT_IMPLEMENTED");
+		return 0;
+	}
+
 	return 1;
 }
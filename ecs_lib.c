@@ -43,3 +43,64 @@ void ecs_set_s(ecdsa_sig sig, mpz_t S) {
 
 	mpz_set(sig->s, S);
 }
+
+/** Initialize a random state seeded from the system entropy source.
+ *	gmp_randinit_mt alone always starts from the same default seed, which would give the same
+ *	nonces and private keys in every process.
+ *	\param state	random state to initialize, released with gmp_randclear
+ *	\return 		1 on success and 0 if no entropy could be read
+ */
+int ecs_rand_init(gmp_randstate_t state) {
+	unsigned char buf[ECS_RAND_SEED_BYTES];
+	size_t len = 0;
+	mpz_t seed;
+	FILE *fp;
+
+	gmp_randinit_mt(state);
+
+	fp = fopen("/dev/urandom", "rb");
+	if (fp != NULL) {
+		len = fread(buf, 1, sizeof(buf), fp);
+		fclose(fp);
+	}
+	if (len != sizeof(buf)) {
+		fprintf(stdout, "ECDSA_F_ECS_RAND_INIT, ERR_R_RAND_LIB");
+		return 0;
+	}
+
+	mpz_init(seed);
+	mpz_import(seed, sizeof(buf), 1, 1, 0, 0, buf);
+	gmp_randseed(state, seed);
+	memset(buf, 0, sizeof(buf));
+	mpz_clear(seed);
+
+	return 1;
+}
+
+/** Converts a hash value to the integer e of the signature as in FIPS 186-4, 6.4: the leftmost
+ *	min(bit length of the order, 8 * len) bits of dgst, read as a big-endian integer.
+ *	\param e		big number, initialized
+ *	\param dgst		hash value
+ *	\param len		length of dgst in bytes
+ *	\param group	curve of the signature
+ */
+void ecdsa_dgst_to_mpz(mpz_t e, const uint8_t *dgst, size_t len, const ec_group group) {
+	size_t bits = mpz_sizeinbase(group->order, 2);
+
+	mpz_import(e, len, 1, 1, 0, 0, dgst);
+	if (8 * len > bits)
+		mpz_fdiv_q_2exp(e, e, 8 * len - bits);
+}
+
+/** Same as ecdsa_dgst_to_mpz for a hash value written in hexadecimal, each digit giving 4 bits
+ *	\return 1 on success and 0 if dgst is not a hexadecimal string
+ */
+int ecdsa_hex_to_mpz(mpz_t e, const char *dgst, const ec_group group) {
+	size_t bits = mpz_sizeinbase(group->order, 2), len = strlen(dgst);
+
+	if (mpz_set_str(e, dgst, 16) != 0)
+		return 0;
+	if (4 * len > bits)
+		mpz_fdiv_q_2exp(e, e, 4 * len - bits);
+	return 1;
+}
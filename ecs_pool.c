@@ -0,0 +1,220 @@
+/*
+ * ecs_pool.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+#include "ec.h"
+
+/*-
+ * Pool of signing nonces. ecdsa_sign_setup does all the expensive work of a signature, the
+ * multiplication k * G and the inversion of k, without the message. Worker threads run it
+ * ahead of time and keep up to size pairs (kinv, r) in a ring; ecdsa_sign_pool takes one and
+ * only computes s = kinv * (e + d * r) mod n on the request path.
+ *
+ * Reusing a nonce for two messages discloses the private key, so a pair leaves the pool when
+ * it is handed out: the slot is wiped under the lock and the pair exists only in the caller.
+ */
+
+/* Overwrite the limbs of x before setting it to 0 */
+static void ecs_pool_wipe(mpz_t x) {
+	mp_size_t n = mpz_size(x);
+
+	if (n > 0)
+		memset(mpz_limbs_modify(x, n), 0, n * sizeof(mp_limb_t));
+	mpz_set_ui(x, 0);
+}
+
+/* Worker thread: compute pairs while the pool is not full */
+static void *ecs_pool_worker(void *arg) {
+	ecs_pool pool = arg;
+	mpz_t kinv, r;
+	int slot;
+
+	mpz_init(kinv); mpz_init(r);
+
+	pthread_mutex_lock(&pool->lock);
+	while (!pool->stop) {
+		if (pool->count == pool->size) {
+			pthread_cond_wait(&pool->drained, &pool->lock);
+			continue;
+		}
+		pthread_mutex_unlock(&pool->lock);
+
+		if (!ecdsa_sign_setup(pool->key, kinv, r)) {
+			/* no more pairs can be produced: the pool is closed, ecs_pool_get fails once empty */
+			pthread_mutex_lock(&pool->lock);
+			pool->stop = 1;
+			pthread_cond_broadcast(&pool->filled);
+			break;
+		}
+
+		pthread_mutex_lock(&pool->lock);
+		/* other workers may have filled the pool meanwhile, the pair is then dropped */
+		if (!pool->stop && pool->count < pool->size) {
+			slot = (pool->head + pool->count) % pool->size;
+			mpz_swap(pool->kinv[slot], kinv);
+			mpz_swap(pool->r[slot], r);
+			pool->count++;
+			pthread_cond_signal(&pool->filled);
+		}
+		ecs_pool_wipe(kinv);
+		ecs_pool_wipe(r);
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	ecs_pool_wipe(kinv);
+	mpz_clear(kinv); mpz_clear(r);
+	return NULL;
+}
+
+/** Creates a pool of precomputed (kinv, r) pairs for eckey, filled by background threads
+ *  \param  eckey     EC_KEY object containing a private EC key, copied by the pool
+ *  \param  size      number of pairs kept ready
+ *  \param  nworkers  number of threads running ecdsa_sign_setup, at least 1
+ *  \return pointer to a ecs_pool structure or NULL if an error occurred
+ */
+ecs_pool ecs_pool_init(const ec_key eckey, int size, int nworkers) {
+	ecs_pool pool;
+	int i;
+
+	if (eckey == NULL || eckey->group == NULL || size <= 0 || nworkers <= 0) {
+		fprintf(stdout, "ECDSA_F_ECS_POOL_INIT, ERR_R_PASSED_NULL_PARAMETER");
+		return NULL;
+	}
+
+	pool = calloc(1, sizeof(struct ecs_pool_st));
+	assert(pool != NULL);
+
+	pool->key = ec_key_dup(eckey);
+	pool->size = size;
+	pool->kinv = malloc(size * sizeof(mpz_t));
+	pool->r = malloc(size * sizeof(mpz_t));
+	pool->workers = malloc(nworkers * sizeof(pthread_t));
+	assert(pool->key != NULL && pool->kinv != NULL && pool->r != NULL && pool->workers != NULL);
+	for (i = 0; i < size; i++) {
+		mpz_init(pool->kinv[i]);
+		mpz_init(pool->r[i]);
+	}
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->filled, NULL);
+	pthread_cond_init(&pool->drained, NULL);
+
+	for (i = 0; i < nworkers; i++) {
+		if (pthread_create(&pool->workers[i], NULL, ecs_pool_worker, pool) != 0)
+			break;
+		pool->nworkers++;
+	}
+	if (pool->nworkers == 0) {
+		fprintf(stdout, "ECDSA_F_ECS_POOL_INIT, ERR_R_THREAD_LIB");
+		ecs_pool_free(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+/** Stops the threads of a pool, wipes the pairs not used and frees the pool
+ *  \param  pool  pointer to the ecs_pool structure
+ */
+void ecs_pool_free(ecs_pool pool) {
+	int i;
+
+	if (pool == NULL)
+		return;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->drained);
+	pthread_cond_broadcast(&pool->filled);
+	pthread_mutex_unlock(&pool->lock);
+	for (i = 0; i < pool->nworkers; i++)
+		pthread_join(pool->workers[i], NULL);
+
+	for (i = 0; i < pool->size; i++) {
+		ecs_pool_wipe(pool->kinv[i]);
+		mpz_clear(pool->kinv[i]);
+		mpz_clear(pool->r[i]);
+	}
+	pthread_cond_destroy(&pool->filled);
+	pthread_cond_destroy(&pool->drained);
+	pthread_mutex_destroy(&pool->lock);
+
+	ec_key_free(pool->key);
+	free(pool->kinv); free(pool->r); free(pool->workers);
+	free(pool);
+}
+
+/** Removes a precomputed pair from the pool, waiting for one if the pool is empty.
+ *  The pool keeps no copy of the pair, which must be used for a single signature.
+ *  \param  pool  pointer to the ecs_pool structure
+ *  \param  kinv  mpz_t for the inverse of k
+ *  \param  rp    mpz_t for the x coordinate of k * generator
+ *  \return 1 on success and 0 otherwise
+ */
+int ecs_pool_get(ecs_pool pool, mpz_t kinv, mpz_t rp) {
+	int ok = 0;
+
+	if (pool == NULL) {
+		fprintf(stdout, "ECDSA_F_ECS_POOL_GET, ERR_R_PASSED_NULL_PARAMETER");
+		return 0;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->count == 0 && !pool->stop)
+		pthread_cond_wait(&pool->filled, &pool->lock);
+
+	if (pool->count > 0) {
+		mpz_set(kinv, pool->kinv[pool->head]);
+		mpz_set(rp, pool->r[pool->head]);
+		ecs_pool_wipe(pool->kinv[pool->head]);
+		ecs_pool_wipe(pool->r[pool->head]);
+		pool->head = (pool->head + 1) % pool->size;
+		pool->count--;
+		pthread_cond_signal(&pool->drained);
+		ok = 1;
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return ok;
+}
+
+/** Returns the number of pairs ready in the pool */
+int ecs_pool_available(ecs_pool pool) {
+	int count;
+
+	pthread_mutex_lock(&pool->lock);
+	count = pool->count;
+	pthread_mutex_unlock(&pool->lock);
+	return count;
+}
+
+/** Computes the ECDSA signature of the given hash value with the key of pool and a
+ *  precomputed pair taken from it.
+ *  \param  dgst      pointer to the hash value
+ *  \param  dgst_len  length of the hash value
+ *  \param  pool      pool of precomputed pairs, see ecs_pool_init
+ *  \return pointer to a ECDSA_SIG structure or NULL if an error occurred
+ */
+ecdsa_sig ecdsa_sign_pool(const char *dgst, int dgst_len, ecs_pool pool) {
+	ecdsa_sig sig = NULL;
+	mpz_t kinv, rp;
+
+	mpz_init(kinv); mpz_init(rp);
+
+	/* s = 0 happens with negligible probability, the pair is then dropped for a new one */
+	while (ecs_pool_get(pool, kinv, rp)) {
+		sig = ecdsa_sign(dgst, dgst_len, kinv, rp, pool->key);
+		ecs_pool_wipe(kinv);
+		if (sig == NULL || mpz_sgn(sig->s))
+			break;
+		ecs_free(sig);
+		sig = NULL;
+	}
+
+	mpz_clear(kinv); mpz_clear(rp);
+	return sig;
+}
@@ -9,6 +9,7 @@
 #include "ec.h"
 #include "ec_point.h"
 #include "field_ops.h"
+#include "fe_ops.h"
 
 /* This time-constant implementation returns a value 0x00 if x equal to 0, otherwise it returns 0xFF */
 int iszero(mpz_t x) {
@@ -37,10 +38,9 @@ int iszero(mpz_t x) {
 int ecdsa_sign_setup(const ec_key eckey, mpz_t kinv, mpz_t rp) {
 	int ok = 0;
 
-	mpz_t order, X, k, r;
-	mpz_init(order); mpz_init(X); mpz_init(k); mpz_init(r);
-
+	mpz_ptr order, X, k, r;
 	ec_group group;
+	ec_ctx ctx;
 
 
 	if (eckey == NULL || (group = ec_key_get_group(eckey)) == NULL) {
@@ -48,10 +48,20 @@ int ecdsa_sign_setup(const ec_key eckey, mpz_t kinv, mpz_t rp) {
 		return 0;
 	}
 
+	/* temporaries from the scratch context of the thread */
+	ctx = ec_ctx_thread(group);
+	ec_ctx_start(ctx);
+	order = ec_ctx_get(ctx); X = ec_ctx_get(ctx); k = ec_ctx_get(ctx); r = ec_ctx_get(ctx);
+
 
 	ec_group_get_order(group, order);
 	gmp_randstate_t state;
-	gmp_randinit_mt(state);
+	if (!ecs_rand_init(state)) {
+		fprintf(stdout, "ECDSA_F_ECDSA_SIGN_SETUP, ERR_R_RAND_LIB");
+		gmp_randclear(state);
+		ec_ctx_end(ctx);
+		return 0;
+	}
 	ec_point tmp_point;
 
 	do {
@@ -70,18 +80,22 @@ int ecdsa_sign_setup(const ec_key eckey, mpz_t kinv, mpz_t rp) {
 		mpz_add(k, k, order);
 
 		/* compute r the x-coordinate of k*G */
-		tmp_point = ecp_mul_atomic(group->generator, k, group);
+		tmp_point = ecp_mul_base(k, group);
 
 		mpz_mod(r, tmp_point->x, order);
+		ec_point_free(tmp_point);
 
 	} while (!mpz_sgn(r)); // until r <> 0
+	gmp_randclear(state);
 
 	/* Compute the inverse of k
-	 * We want inverse in constant time, therefore we utilize the fact
-	 * order must be prime and use Fermats Little Theorem instead.
+	 * We want inverse in constant time: mod_sec_invert reduces k mod order
+	 * and runs the safegcd inversion on fixed-width limbs (fe_modinv) for
+	 * orders of up to FE_BITS bits.
 	 */
-	if (!mod_invert(X, k, order)) {
+	if (!mod_sec_invert(X, k, order)) {
 		fprintf(stdout, "ECDSA_F_ECDSA_SIGN_SETUP, ERR_R_BN_LIB");
+		ec_ctx_end(ctx);
 		return 0;
 	}
 
@@ -89,40 +103,30 @@ int ecdsa_sign_setup(const ec_key eckey, mpz_t kinv, mpz_t rp) {
 	mpz_set(rp, r);
 	mpz_set(kinv, X);
 
-	/* clear variables used */
-	mpz_clear(order); mpz_clear(X); mpz_clear(k); mpz_clear(r);
-	ec_point_free(tmp_point); //ec_group_free(group);
+	/* give the temporaries back */
+	ec_ctx_end(ctx);
+	//ec_group_free(group);
+	ec_arena_reset();
 
 	ok = 1;
 
 	return (ok);
 }
 
-/** Computes ECDSA signature of a given hash value using the supplied
- *  private key (note: sig must point to ECDSA_size(eckey) bytes of memory).
- *  \param  dgst     pointer to the hash value to sign
- *  \param  dgstlen  length of the hash value
- *  \param  kinv     big number with a pre-computed inverse k (optional)
- *  \param  rp       big number with a pre-computed rp value (optioanl),
- *                   see ECDSA_sign_setup
- *  \param  eckey    ec_key object containing a private EC key
- *  \return 1 on success and 0 otherwise
- */
-ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t in_kinv, const mpz_t in_rp, const ec_key eckey) {
+/* Signature of the integer e of the hash value, see ecdsa_sign. Require: eckey != NULL */
+static ecdsa_sig ecdsa_do_sign(mpz_t e, const mpz_t in_kinv, const mpz_t in_rp, const ec_key eckey) {
 
-	if (eckey == NULL) {
-		fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ERR_R_PASSED_NULL_PARAMETER");
-		return NULL;
-	}
+	/* temporaries from the scratch context of the thread */
+	ec_ctx ctx = ec_ctx_thread(eckey->group);
+	ec_ctx_start(ctx);
 
-	mpz_t priv_key;
-	mpz_init(priv_key);
+	mpz_ptr priv_key = ec_ctx_get(ctx);
 
 	ec_key_get_private_key(priv_key, eckey);
 
 	if (!mpz_sgn(priv_key)) {
 		fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ERR_R_PASSED_NULL_PARAMETER");
-		mpz_clear(priv_key);
+		ec_ctx_end(ctx);
 		return NULL;
 	}
 
@@ -130,27 +134,24 @@ ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t in_kinv, const
 
 	if (!ret) {
 		fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ERR_R_MALLOC_FAILURE");
+		ec_ctx_end(ctx);
 		return NULL;
 	}
 
-	mpz_t e, order;
-	mpz_init(e); mpz_init(order);
+	mpz_ptr order = ec_ctx_get(ctx);
 
 	ec_group_get_order(eckey->group, order);
 
-	// Convert message digest dgst to an integer e
-	mpz_set_str(e, dgst, 16);
-
-	/*
-	printf("The length of message in bits is %d\n", n);
-	printf("Value of bit string is: ");
-	mpz_out_str(stdout, 16, m);
-	printf("\n");*/
+	mpz_ptr kinv = ec_ctx_get(ctx), s = ec_ctx_get(ctx), ckinv = ec_ctx_get(ctx);
+	mpz_ptr tmp1 = ec_ctx_get(ctx), tmp2 = ec_ctx_get(ctx);
 
-	assert(mpz_sizeinbase(e, 2) <= mpz_sizeinbase(order, 2));
-
-	mpz_t kinv, s, tmp1, tmp2, ckinv;
-	mpz_init(kinv); mpz_init(s); mpz_init(ckinv); mpz_init(tmp1); mpz_init(tmp2);
+	/* fixed-width copies of the operands when the order fits, see fe_ops.c */
+	fe_field fn = eckey->group->fn;
+	fe_t fm, fd, fr, fk, fs;
+	if (fn != NULL) {
+		fe_from_mpz(fm, e, fn);
+		fe_from_mpz(fd, priv_key, fn);
+	}
 
 	//gmp_printf("Initiate s = %Zd, mpz_sgn(s) = %d", s, mpz_sgn(s));
 	do {
@@ -158,6 +159,7 @@ ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t in_kinv, const
 			if (! ecdsa_sign_setup(eckey, kinv, ret->r)) {
 				fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ERR_R_ECDSA_LIB");
 				ecs_free(ret);
+				ec_ctx_end(ctx);
 				return NULL;
 			}
 			mpz_set(ckinv, kinv);
@@ -169,11 +171,22 @@ ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t in_kinv, const
 		/** Calculate s
 		 * s = k^{-1} * (m + d * r) mod order = (k^{-1} mod n) * ((e+d*r) mod n) mod n
 		 */
-		mpz_mul(tmp1, priv_key, ret->r); 	// tmp1 = d * r
+		if (fn != NULL) {
+			fe_from_mpz(fr, ret->r, fn);
+			fe_from_mpz(fk, ckinv, fn);
 
-		mod_add(tmp2, e, tmp1, order);		// tmp2 = m + tmp1 mod order
+			fe_mul(fs, fd, fr, fn);			// fs = d * r
+			fe_add(fs, fm, fs, fn);			// fs = m + d * r
+			fe_mul(fs, fs, fk, fn);			// fs = k^{-1} (m + d * r)
+
+			fe_to_mpz(s, fs, fn);
+		} else {
+			mpz_mul(tmp1, priv_key, ret->r); 	// tmp1 = d * r
 
-		mod_mul(s, tmp2, ckinv, order);		// s = k^{-1} tmp2 mod order
+			mod_add(tmp2, e, tmp1, order);		// tmp2 = m + tmp1 mod order
+
+			mod_mul(s, tmp2, ckinv, order);		// s = k^{-1} tmp2 mod order
+		}
 
 		//gmp_printf("s = %Zd, mpz_sgn(s) = %d", s, mpz_sgn(s));
 
@@ -201,9 +214,74 @@ ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t in_kinv, const
 	gmp_printf("e * s^{-1} = %Zd \n", u1);
 	mpz_clear(w); mpz_clear(u1); */
 
-	mpz_clear(priv_key); mpz_clear(e); mpz_clear(order);
-	mpz_clear(tmp1); mpz_clear(tmp2);mpz_clear(s); mpz_clear(kinv); mpz_clear(ckinv);
+	if (fn != NULL) {
+		memset(fd, 0, sizeof(fe_t));
+		memset(fk, 0, sizeof(fe_t));
+	}
+	ec_ctx_end(ctx);
+	ec_arena_reset();
+
+	return ret;
+
+}
+
+/** Computes ECDSA signature of a given hash value using the supplied
+ *  private key. The hash value is truncated to the bit length of the order (FIPS 186-4).
+ *  \param  dgst     pointer to the hash value to sign, in hexadecimal
+ *  \param  dgstlen  length of the hash value
+ *  \param  kinv     big number with a pre-computed inverse k (optional)
+ *  \param  rp       big number with a pre-computed rp value (optioanl),
+ *                   see ECDSA_sign_setup
+ *  \param  eckey    ec_key object containing a private EC key
+ *  \return pointer to a ECDSA_SIG structure or NULL if an error occurred
+ */
+ecdsa_sig ecdsa_sign(const char *dgst, int dgst_len, const mpz_t in_kinv, const mpz_t in_rp, const ec_key eckey) {
+	ecdsa_sig ret = NULL;
+
+	if (eckey == NULL || dgst == NULL) {
+		fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ERR_R_PASSED_NULL_PARAMETER");
+		return NULL;
+	}
+
+	ec_ctx ctx = ec_ctx_thread(eckey->group);
+	ec_ctx_start(ctx);
+	mpz_ptr e = ec_ctx_get(ctx);
+
+	// Convert message digest dgst to an integer e
+	if (ecdsa_hex_to_mpz(e, dgst, eckey->group))
+		ret = ecdsa_do_sign(e, in_kinv, in_rp, eckey);
+	else
+		fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ECDSA_R_INVALID_DIGEST");
 
+	ec_ctx_end(ctx);
 	return ret;
+}
+
+/** Computes ECDSA signature of a hash value given as bytes, without going through its
+ *  hexadecimal form. The hash value is truncated to the bit length of the order (FIPS 186-4).
+ *  \param  dgst     pointer to the hash value to sign
+ *  \param  len      length of the hash value in bytes
+ *  \param  kinv     big number with a pre-computed inverse k (optional)
+ *  \param  rp       big number with a pre-computed rp value (optional)
+ *  \param  eckey    ec_key object containing a private EC key
+ *  \return pointer to a ECDSA_SIG structure or NULL if an error occurred
+ */
+ecdsa_sig ecdsa_sign_digest(const uint8_t *dgst, size_t len, const mpz_t in_kinv, const mpz_t in_rp,
+		const ec_key eckey) {
+	ecdsa_sig ret;
 
+	if (eckey == NULL || dgst == NULL) {
+		fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ERR_R_PASSED_NULL_PARAMETER");
+		return NULL;
+	}
+
+	ec_ctx ctx = ec_ctx_thread(eckey->group);
+	ec_ctx_start(ctx);
+	mpz_ptr e = ec_ctx_get(ctx);
+
+	ecdsa_dgst_to_mpz(e, dgst, len, eckey->group);
+	ret = ecdsa_do_sign(e, in_kinv, in_rp, eckey);
+
+	ec_ctx_end(ctx);
+	return ret;
 }
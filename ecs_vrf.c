@@ -9,40 +9,17 @@
 #include "ec.h"
 #include "ec_point.h"
 #include "field_ops.h"
+#include "fe_ops.h"
 
-/** Verifies that the given signature is valid ECDSA signature
- *  of the supplied hash value using the specified public key.
- *  \param  dgst     pointer to the hash value
- *  \param  dgstlen  length of the hash value
- *  \param  sig      pointer to the ecdsa_sig structure
- *  \param  eckey    EC_KEY object containing a public EC key
- *  \return 1 if the signature is valid, 0 if the signature is invalid
- *          and -1 on error
- */
-int ecdsa_verify(const char *dgst, int dgstlen, const ecdsa_sig sig, const ec_group group, ec_point pub_key) {
+/* Verification of the signature sig of the integer e of the hash value, see ecdsa_verify.
+ * group and pub_key are not released */
+static int ecdsa_do_verify(mpz_t e, const ecdsa_sig sig, const ec_group group, const ec_point pub_key) {
 	int ok = 0;
 
-	if (group == NULL || pub_key == NULL) {
-		fprintf(stdout, "ECDSA_F_ECDSA_DO_SIGN, ERR_R_PASSED_NULL_PARAMETER");
-		return -1;
-	}
-
-	mpz_t order, e; mpz_init(order);
-
-	ec_group_get_order(group, order);
-
 	//verify that r and s are integers within [1, n-1]
-	mpz_t one; mpz_init(one);
-	mpz_set_ui(one, 1);
-	if(	mpz_cmp(sig->r,one) < 0 && mpz_cmp(order, sig->r) <= 0 &&
-			mpz_cmp(sig->s, one) < 0 && mpz_cmp(order,sig->s) <= 0) {
-		ok = 0;
-		goto err;
-	}
-
-	/* Convert bit string of hash digest to an integer e */
-	mpz_init_set_str(e, dgst, 16);
-	assert(mpz_sizeinbase(e, 2) <= mpz_sizeinbase(order, 2));
+	if (mpz_sgn(sig->r) <= 0 || mpz_cmp(sig->r, group->order) >= 0 ||
+			mpz_sgn(sig->s) <= 0 || mpz_cmp(sig->s, group->order) >= 0)
+		return 0;
 
 	//Initialize variables
 	mpz_t w, u1, u2;
@@ -52,25 +29,23 @@ int ecdsa_verify(const char *dgst, int dgstlen, const ecdsa_sig sig, const ec_gr
 	 * We want inverse in constant time, therefore we utilize the fact
 	 * order must be prime and use Fermats Little Theorem instead.
 	 */
-	if (!mod_invert(w, sig->s, order)) {
+	if (!mod_invert(w, sig->s, group->order)) {
 		fprintf(stdout, "ECDSA_F_ECDSA_SIGN_SETUP, ERR_R_BN_LIB");
-		ok = -1;
-		goto err;
+		mpz_clear(w); mpz_clear(u1); mpz_clear(u2);
+		return -1;
 	}
 
 	//u1 = e * w mod order
-	mod_mul(u1, e, w, order);
+	mod_mul(u1, e, w, group->order);
 
 	//u2 = r * w mod n
-	mod_mul(u2, sig->r, w, order);
+	mod_mul(u2, sig->r, w, group->order);
 
 	//x = u1*G + u2*Q
-	ec_point pt_tmp1 = ecp_mul_atomic(group->generator, u1, group);
-	ec_point pt_tmp2 = ecp_mul_atomic(pub_key, u2, group);
-	ec_point X = ec_point_add_atomic(pt_tmp1, pt_tmp2, group);
+	ec_point X = ecp_mul2_base(u1, pub_key, u2, group);
 
 	mpz_t x1; mpz_init(x1);
-	mpz_mod(x1, X->x, order);
+	mpz_mod(x1, X->x, group->order);
 	//Get the result, by comparing x value with r and verifying that x is NOT at infinity
 
 	if ((mpz_cmp(sig->r, x1) == 0) && !X->infinity)
@@ -79,12 +54,234 @@ int ecdsa_verify(const char *dgst, int dgstlen, const ecdsa_sig sig, const ec_gr
 		ok = 0;
 
 	mpz_clear(w); mpz_clear(u1); mpz_clear(u2); mpz_clear(x1);
-	ec_point_free(X); ec_point_free(pt_tmp1); ec_point_free(pt_tmp2);
+	ec_point_free(X);
+
+	return (ok);
+}
+
+/** Verifies that the given signature is valid ECDSA signature
+ *  of the supplied hash value using the specified public key.
+ *  The hash value is truncated to the bit length of the order (FIPS 186-4).
+ *  group and pub_key are released.
+ *  \param  dgst     pointer to the hash value, in hexadecimal
+ *  \param  dgstlen  length of the hash value
+ *  \param  sig      pointer to the ecdsa_sig structure
+ *  \param  group    curve of the public key
+ *  \param  pub_key  public key
+ *  \return 1 if the signature is valid, 0 if the signature is invalid
+ *          and -1 on error
+ */
+int ecdsa_verify(const char *dgst, int dgstlen, const ecdsa_sig sig, const ec_group group, ec_point pub_key) {
+	int ok;
+	mpz_t e;
 
-err:
-	mpz_clear(one); mpz_clear(order); mpz_clear(e);
+	if (group == NULL || pub_key == NULL || sig == NULL || dgst == NULL) {
+		fprintf(stdout, "ECDSA_F_ECDSA_DO_VERIFY, ERR_R_PASSED_NULL_PARAMETER");
+		return -1;
+	}
+
+	/* Convert bit string of hash digest to an integer e */
+	mpz_init(e);
+	if (ecdsa_hex_to_mpz(e, dgst, group))
+		ok = ecdsa_do_verify(e, sig, group, pub_key);
+	else
+		ok = -1;
+
+	mpz_clear(e);
 	ec_group_free(group); ec_point_free(pub_key);
+	ec_arena_reset();
 
 	return (ok);
+}
+
+/** Verifies a signature of a hash value given as bytes, without going through its hexadecimal
+ *  form. The hash value is truncated to the bit length of the order (FIPS 186-4).
+ *  Like ecdsa_verify, group and pub_key are released.
+ *  \param  dgst     pointer to the hash value
+ *  \param  len      length of the hash value in bytes
+ *  \param  sig      pointer to the ecdsa_sig structure
+ *  \param  group    curve of the public key
+ *  \param  pub_key  public key
+ *  \return 1 if the signature is valid, 0 if the signature is invalid
+ *          and -1 on error
+ */
+int ecdsa_verify_digest(const uint8_t *dgst, size_t len, const ecdsa_sig sig, const ec_group group,
+		ec_point pub_key) {
+	int ok;
+	mpz_t e;
+
+	if (group == NULL || pub_key == NULL || sig == NULL || dgst == NULL) {
+		fprintf(stdout, "ECDSA_F_ECDSA_DO_VERIFY, ERR_R_PASSED_NULL_PARAMETER");
+		return -1;
+	}
+
+	mpz_init(e);
+	ecdsa_dgst_to_mpz(e, dgst, len, group);
+	ok = ecdsa_do_verify(e, sig, group, pub_key);
+
+	mpz_clear(e);
+	ec_group_free(group); ec_point_free(pub_key);
+	ec_arena_reset();
+
+	return (ok);
+}
+
+/* Return 1 if the affine x-coordinate of R, reduced modulo the order, is equal to r.
+ * Compares X with c * Z^2 for the candidates c = r, r + order, ... below the field
+ * characteristic, which avoids the inversion of Z
+ */
+static int ecdsa_check_x(const ecp_jac *R, const mpz_t r, const ec_group group) {
+	fe_t zz, t;
+	mpz_t c;
+	int ok = 0;
+
+	if (fe_is_zero(R->Z))
+		return 0;
+
+	fe_sqr(zz, R->Z, group->fp);
+	for (mpz_init_set(c, r); !ok && mpz_cmp(c, group->field) < 0; mpz_add(c, c, group->order)) {
+		fe_from_mpz(t, c, group->fp);
+		fe_mul(t, t, zz, group->fp);
+		ok = fe_equal(t, R->X);
+	}
+	mpz_clear(c);
+	return ok;
+}
+
+/** Verifies a batch of ECDSA signatures with public keys on the same curve.
+ *  The work is shared between the signatures: the values s are inverted together with a single
+ *  modular inversion, the tables of odd multiples of all public keys are normalized with a single
+ *  inversion, the odd multiples of the generator come from the shared table of the curve, and each
+ *  u1 * G + u2 * Q is computed with interleaved wNAF and checked without going back to affine
+ *  coordinates. Unlike ecdsa_verify, group and the public keys are not released.
+ *  \param  dgst     array of n hash values, in hexadecimal
+ *  \param  sig      array of n pointers to ecdsa_sig structures
+ *  \param  group    curve of the public keys
+ *  \param  pub_key  array of n public keys
+ *  \param  n        number of signatures
+ *  \param  results  array of n results: 1 if the signature is valid, 0 if it is invalid
+ *                   and -1 on error
+ *  \return number of valid signatures, -1 on error
+ */
+int ecdsa_verify_batch(const char **dgst, const ecdsa_sig *sig, const ec_group group,
+		const ec_point *pub_key, int n, int *results) {
+	const int tq = 1 << (ECP_WNAF_WINDOW - 2);
+	ecp_comb comb;
+	ecp_jac *J, R, P2;
+	ecp_fe *TQ, Q;
+	fe_t *fs, fe, fr;
+	mpz_t *e, u1, u2;
+	int i, j, valid = 0;
+
+	if (group == NULL || dgst == NULL || sig == NULL || pub_key == NULL || results == NULL || n < 0) {
+		fprintf(stdout, "ECDSA_F_ECDSA_VERIFY_BATCH, ERR_R_PASSED_NULL_PARAMETER");
+		return -1;
+	}
+	if (n == 0)
+		return 0;
+
+	e = malloc(n * sizeof(mpz_t));
+	assert(e != NULL);
+	mpz_init(u1); mpz_init(u2);
+
+	/* check r and s within [1, n-1] and parse the digests once */
+	for (i = 0; i < n; i++) {
+		results[i] = 1;
+		mpz_init(e[i]);
+		if (sig[i] == NULL || pub_key[i] == NULL || dgst[i] == NULL
+				|| !ecdsa_hex_to_mpz(e[i], dgst[i], group)) {
+			results[i] = -1;
+			continue;
+		}
+		if (mpz_sgn(sig[i]->r) <= 0 || mpz_cmp(sig[i]->r, group->order) >= 0
+				|| mpz_sgn(sig[i]->s) <= 0 || mpz_cmp(sig[i]->s, group->order) >= 0
+				|| pub_key[i]->infinity)
+			results[i] = 0;
+	}
+
+	comb = ecp_comb_get(group);
+	if (comb == NULL || group->fn == NULL) {
+		/* no fixed-width arithmetic for this curve: the inverses are still shared, the
+		 * multiplications are done one signature at a time */
+		mpz_t *w = malloc(n * sizeof(mpz_t));
+		assert(w != NULL);
+		for (i = 0; i < n; i++)
+			mpz_init_set_ui(w[i], 0);
+		for (i = 0; i < n; i++)
+			if (results[i] == 1)
+				mpz_set(w[i], sig[i]->s);
+		mod_batch_invert(w, w, n, group->order);
+
+		for (i = 0; i < n; i++) {
+			if (results[i] != 1)
+				continue;
+			mod_mul(u1, e[i], w[i], group->order);
+			mod_mul(u2, sig[i]->r, w[i], group->order);
+			ec_point X = ecp_mul2_base(u1, pub_key[i], u2, group);
+			mpz_mod(u1, X->x, group->order);
+			results[i] = !X->infinity && !mpz_cmp(u1, sig[i]->r);
+			valid += results[i];
+			ec_point_free(X);
+		}
+		for (i = 0; i < n; i++) {
+			mpz_clear(w[i]);
+			mpz_clear(e[i]);
+		}
+		free(w); free(e);
+		mpz_clear(u1); mpz_clear(u2);
+		ec_arena_reset();
+		return valid;
+	}
+
+	fs = malloc(n * sizeof(fe_t));
+	J = malloc(n * tq * sizeof(ecp_jac));
+	TQ = malloc(n * tq * sizeof(ecp_fe));
+	assert(fs != NULL && J != NULL && TQ != NULL);
+
+	/* w_i = s_i^-1 with a single inversion, the rejected signatures contribute 0 */
+	for (i = 0; i < n; i++) {
+		if (results[i] == 1)
+			fe_from_mpz(fs[i], sig[i]->s, group->fn);
+		else
+			fe_set_zero(fs[i]);
+	}
+	fe_batch_inv(fs, (const fe_t *) fs, n, group->fn);
+
+	/* odd multiples of all public keys, normalized together */
+	for (i = 0; i < n; i++) {
+		if (results[i] == 1)
+			ecp_fe_set_point(&Q, pub_key[i], group);
+		else
+			memcpy(&Q, &comb->odd[0], sizeof(ecp_fe));
+		ecp_jac_set_affine(&J[i * tq], &Q, group);
+		ecp_jac_dbl(&P2, &J[i * tq], group);
+		for (j = 1; j < tq; j++)
+			ecp_jac_add(&J[i * tq + j], &J[i * tq + j - 1], &P2, group);
+	}
+	ecp_jac_batch_get_affine(TQ, J, n * tq, group);
+
+	for (i = 0; i < n; i++) {
+		if (results[i] != 1)
+			continue;
+
+		/* u1 = e * w mod n, u2 = r * w mod n */
+		fe_from_mpz(fe, e[i], group->fn);
+		fe_from_mpz(fr, sig[i]->r, group->fn);
+		fe_mul(fe, fe, fs[i], group->fn);
+		fe_mul(fr, fr, fs[i], group->fn);
+		fe_to_mpz(u1, fe, group->fn);
+		fe_to_mpz(u2, fr, group->fn);
+
+		ecp_wnaf_mul2(&R, u1, comb->odd, ECP_WNAF_G_WINDOW, u2, &TQ[i * tq], ECP_WNAF_WINDOW, group);
+		results[i] = ecdsa_check_x(&R, sig[i]->r, group);
+		valid += results[i];
+	}
+
+	for (i = 0; i < n; i++)
+		mpz_clear(e[i]);
+	free(fs); free(J); free(TQ); free(e);
+	mpz_clear(u1); mpz_clear(u2);
+	ec_arena_reset();
 
+	return valid;
 }
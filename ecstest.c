@@ -216,6 +216,236 @@ static int ecs_keygen_test(ec_point G, ec_point Q, mpz_t d, ec_group ec) {
 	return (ok);
 }
 
+/* Batch verification of copies of a valid signature mixed with invalid ones */
+static void ecdsa_batch_test(char *dgst, ecdsa_sig sig, ec_point Q, ec_group group) {
+	fprintf(stdout, "\nVerifying batch signature verification ...\n");
+	const int expected[6] = {1, 1, 0, 0, 0, 1};
+	const char *dgsts[6];
+	int results[6];
+	ecdsa_sig sigs[6];
+	ec_point keys[6];
+	int i, ok, valid;
+
+	char *other = strdup(dgst);
+	other[0] = (other[0] == '1') ? '2' : '1';	// another digest
+
+	for (i = 0; i < 6; i++) {
+		dgsts[i] = dgst;
+		sigs[i] = ecs_dup(sig);
+		keys[i] = Q;
+	}
+	mpz_add_ui(sigs[2]->s, sigs[2]->s, 1);
+	mpz_set_ui(sigs[3]->r, 0);
+	dgsts[4] = other;
+
+	valid = ecdsa_verify_batch(dgsts, sigs, group, keys, 6, results);
+	ok = (valid == 3);
+	for (i = 0; i < 6; i++)
+		ok &= (results[i] == expected[i]);
+
+	if (ok)
+		fprintf(stdout, "Batch signature verification : passed !\n");
+	else
+		fprintf(stdout, "Batch signature verification : failed !\n");
+
+	for (i = 0; i < 6; i++)
+		ecs_free(sigs[i]);
+	free(other);
+}
+
+
+/* Signatures with nonces from a pool: each pair is used once, and independent setups differ */
+static void ecdsa_pool_test(char *dgst, ec_key eckey, ec_point Q, ec_group group) {
+	fprintf(stdout, "\nVerifying the pool of precomputed nonces ...\n");
+	const int n = 8;
+	ecdsa_sig sigs[n];
+	mpz_t k1, r1, k2, r2;
+	int i, j, ok = 1;
+
+	mpz_init(k1); mpz_init(r1); mpz_init(k2); mpz_init(r2);
+	ok &= ecdsa_sign_setup(eckey, k1, r1) && ecdsa_sign_setup(eckey, k2, r2);
+	ok &= (mpz_cmp(r1, r2) != 0);
+
+	ecs_pool pool = ecs_pool_init(eckey, 4, 2);
+	ok &= (pool != NULL);
+	for (i = 0; ok && i < n; i++) {
+		sigs[i] = ecdsa_sign_pool(dgst, strlen(dgst), pool);
+		ok &= (sigs[i] != NULL) && ecdsa_verify(dgst, strlen(dgst), sigs[i], ec_group_dup(group), ec_point_dup(Q)) == 1;
+		for (j = 0; ok && j < i; j++)
+			ok &= (mpz_cmp(sigs[i]->r, sigs[j]->r) != 0);
+	}
+	ok &= (ecs_pool_available(pool) <= 4);
+	ecs_pool_free(pool);
+
+	if (ok)
+		fprintf(stdout, "Signature with pooled nonces : passed !\n");
+	else
+		fprintf(stdout, "Signature with pooled nonces : failed !\n");
+
+	for (j = 0; j < i; j++)
+		ecs_free(sigs[j]);
+	mpz_clear(k1); mpz_clear(r1); mpz_clear(k2); mpz_clear(r2);
+}
+
+/* Bulk loading of compressed public keys with several threads, with invalid keys mixed in,
+ * then validation of the loaded points with and without the order check */
+static void ecs_load_keys_test(ec_group group) {
+	fprintf(stdout, "\nVerifying the bulk loading of public keys ...\n");
+	const int n = 64;
+	ec_point P[n], Q[n];
+	char *z[n];
+	int results[n];
+	gmp_randstate_t state;
+	mpz_t k; mpz_init(k);
+	int i, ok = 1;
+
+	gmp_randinit_default(state);
+	for (i = 0; i < n; i++) {
+		mpz_urandomm(k, state, group->order);
+		mpz_add_ui(k, k, 1);
+		P[i] = ecp_mul_base(k, group);
+		Q[i] = ec_point_init();
+		z[i] = ec_point_compress(P[i]);
+	}
+	z[7][1] = '5';								// not a compressed point
+	free(z[40]);
+	z[40] = malloc(mpz_sizeinbase(group->field, 16) + 3);
+	strcpy(z[40], "02");
+	mpz_get_str(z[40] + 2, 16, group->field);	// x = p
+
+	ok &= (ec_key_load_public_keys(Q, (const char **) z, n, group, 4, results) == n - 2);
+	for (i = 0; i < n; i++) {
+		ok &= (results[i] == (i != 7 && i != 40));
+		if (results[i])
+			ok &= ec_point_cmp(P[i], Q[i], group->field);
+	}
+
+	/* the order check of a cofactor other than 1 accepts the points of the group */
+	mpz_add_ui(P[3]->y, P[3]->y, 1);
+	ok &= (ec_key_check_public_keys(P, n, group, 3, results) == n - 1) && !results[3];
+	mpz_set_ui(group->cofactor, 2);
+	ok &= (ec_key_check_public_keys(P, n, group, 1, NULL) == n - 1);
+	mpz_set_ui(group->cofactor, 1);
+
+	if (ok)
+		fprintf(stdout, "Bulk loading of public keys : passed !\n");
+	else
+		fprintf(stdout, "Bulk loading of public keys : failed !\n");
+
+	for (i = 0; i < n; i++) {
+		ec_point_free(P[i]); ec_point_free(Q[i]);
+		free(z[i]);
+	}
+	gmp_randclear(state);
+	mpz_clear(k);
+}
+
+/* Signatures with the arena allocator of GMP, the bump offset coming back to its value once the
+ * signature is freed, and wiping of the released numbers.
+ * The limbs are read after mpz_clear: the arena keeps the chunk while the numbers of the test live */
+static void ecdsa_arena_test(char *dgst, ec_key eckey, ec_point Q, ec_group group) {
+	fprintf(stdout, "\nVerifying the arena allocator ...\n");
+	const volatile mp_limb_t *p;
+	ecdsa_sig sig;
+	mp_size_t j, n;
+	mpz_t x, kinv, r;
+	size_t used;
+	int i, ok = ec_arena_is_enabled();
+
+	mpz_init(kinv); mpz_init(r);
+	for (i = 0; ok && i < 4; i++) {
+		ok &= ecdsa_sign_setup(eckey, kinv, r);
+		sig = ecdsa_sign(dgst, strlen(dgst), kinv, r, eckey);
+		ok &= (sig != NULL) && ecdsa_verify(dgst, strlen(dgst), sig, ec_group_dup(group), ec_point_dup(Q)) == 1;
+		if (sig != NULL)
+			ecs_free(sig);
+	}
+
+	// the first signatures built the tables and contexts, the others give back all they take
+	for (i = 0; ok && i < 4; i++) {
+		ok &= ecdsa_sign_setup(eckey, kinv, r);
+		used = ec_arena_used();
+		sig = ecdsa_sign(dgst, strlen(dgst), kinv, r, eckey);
+		ok &= (sig != NULL);
+		if (sig != NULL)
+			ecs_free(sig);
+		ok &= (ec_arena_used() == used);
+	}
+	mpz_clear(kinv); mpz_clear(r);
+
+	mpz_init_set(x, eckey->priv_key);
+	p = mpz_limbs_read(x);
+	n = mpz_size(x);
+	mpz_clear(x);
+	for (j = 0; j < n; j++)
+		ok &= (p[j] == 0);
+
+	if (ok)
+		fprintf(stdout, "Arena allocator : passed !\n");
+	else
+		fprintf(stdout, "Arena allocator : failed !\n");
+}
+
+/* Signatures of hash values given as bytes: longer than the order (SHA-384), truncated to its
+ * leftmost bits, and shorter (SHA-224). The hexadecimal interface must accept the same signatures.
+ * Values r, s out of [1, n - 1] and a modified hash value are rejected */
+static void ecdsa_digest_test(const char *msg, ec_key eckey, ec_point Q, ec_group group) {
+	fprintf(stdout, "\nVerifying signatures of binary hash values ...\n");
+	uchar d384[SHA384_DIGEST_LENGTH], d224[SHA224_DIGEST_LENGTH];
+	char hex[SHA384_DIGEST_STRING_LENGTH];
+	SHA384_Context c384;
+	SHA224_Context c224;
+	mpz_t kinv, r, t;
+	ecdsa_sig sig;
+	int i, ok = 1;
+
+	sha384_init(&c384);
+	sha384_update(&c384, (uchar *) msg, strlen(msg));
+	sha384_final(&c384, d384);
+	sha224_init(&c224);
+	sha224_update(&c224, (uchar *) msg, strlen(msg));
+	sha224_final(&c224, d224);
+	for (i = 0; i < SHA384_DIGEST_LENGTH; i++)
+		sprintf(hex + 2 * i, "%02x", d384[i]);
+
+	mpz_init(kinv); mpz_init(r); mpz_init(t);
+	ok &= ecdsa_sign_setup(eckey, kinv, r);
+	sig = ecdsa_sign_digest(d384, sizeof(d384), kinv, r, eckey);
+	ok &= (sig != NULL);
+	if (ok) {
+		ok &= ecdsa_verify_digest(d384, sizeof(d384), sig, ec_group_dup(group), ec_point_dup(Q)) == 1;
+		ok &= ecdsa_verify(hex, strlen(hex), sig, ec_group_dup(group), ec_point_dup(Q)) == 1;
+		d384[0] ^= 0x80;
+		ok &= ecdsa_verify_digest(d384, sizeof(d384), sig, ec_group_dup(group), ec_point_dup(Q)) == 0;
+		d384[0] ^= 0x80;
+
+		// r = 0, r = n, s = n
+		mpz_set(t, sig->r);
+		mpz_set_ui(sig->r, 0);
+		ok &= ecdsa_verify_digest(d384, sizeof(d384), sig, ec_group_dup(group), ec_point_dup(Q)) == 0;
+		mpz_set(sig->r, group->order);
+		ok &= ecdsa_verify_digest(d384, sizeof(d384), sig, ec_group_dup(group), ec_point_dup(Q)) == 0;
+		mpz_set(sig->r, t);
+		mpz_set(t, sig->s);
+		mpz_set(sig->s, group->order);
+		ok &= ecdsa_verify_digest(d384, sizeof(d384), sig, ec_group_dup(group), ec_point_dup(Q)) == 0;
+		mpz_add(sig->s, t, group->order);
+		ok &= ecdsa_verify_digest(d384, sizeof(d384), sig, ec_group_dup(group), ec_point_dup(Q)) == 0;
+		ecs_free(sig);
+	}
+
+	sig = ecdsa_sign_digest(d224, sizeof(d224), kinv, r, eckey);
+	ok &= (sig != NULL) && ecdsa_verify_digest(d224, sizeof(d224), sig, ec_group_dup(group), ec_point_dup(Q)) == 1;
+	if (sig != NULL)
+		ecs_free(sig);
+
+	if (ok)
+		fprintf(stdout, "Binary hash values : passed !\n");
+	else
+		fprintf(stdout, "Binary hash values : failed !\n");
+
+	mpz_clear(kinv); mpz_clear(r); mpz_clear(t);
+}
 
 static void ecdsa_single_test(const struct ecdsa_params *test) {
 
@@ -391,6 +621,12 @@ static void ecdsa_single_test(const struct ecdsa_params *test) {
 
 	ec_point_free(tmp_X); mpz_clear(x1);
 
+	ecdsa_batch_test(dgst, sig, Q, group);
+	ecdsa_pool_test(dgst, eckey, Q, group);
+	ecdsa_arena_test(dgst, eckey, Q, group);
+	ecdsa_digest_test(msg, eckey, Q, group);
+	ecs_load_keys_test(group);
+
 	/* Release memory for struct/variables allocated */
 	free(msg); free(dgst); free(hash_dgst);
 	mpz_clear(d); mpz_clear(order);
@@ -405,6 +641,9 @@ int main(int argc, char* argv[]) {
 
 	unsigned i;
 
+	/* all signature tests run on the arena allocator, installed before the first use of GMP */
+	ec_arena_enable();
+
 	for (i = 0;
 			i < sizeof(ecs_params) / sizeof(struct ecdsa_params);
 			i++) {
@@ -8,6 +8,8 @@
 #include "ecdsa.h"
 #include "ec.h"
 #include "ec_point.h"
+#include "field_ops.h"
+#include "fe_ops.h"
 
 struct nistp_params {
 	const char* name;
@@ -240,6 +242,502 @@ static void ec_dbl_mul_test(ec_point X, ec_point P, ec_point T, mpz_t d, mpz_t e
 
 }
 
+/* In-place operations with a scratch context, the result overwriting an operand, and the ladder built on them */
+static void ec_inplace_test(ec_point P, ec_point T, ec_point R, ec_point D, ec_point X, mpz_t x, ec_group ec) {
+	fprintf(stdout, "\nverifying in-place point operations ...\n");
+	ec_ctx ctx = ec_ctx_init(ec);
+	ec_point A = ec_point_dup(P), B = ec_point_dup(P), C = ec_point_dup(T);
+	int ok = 1;
+
+	ec_point_add_to(A, A, T, ec, ctx);
+	ok &= ec_point_cmp(A, R, ec->field);
+	ec_point_dbl_to(B, B, ec, ctx);
+	ok &= ec_point_cmp(B, D, ec->field);
+	ec_point_add_atomic_to(C, P, C, ec, ctx);
+	ok &= ec_point_cmp(C, R, ec->field);
+	ec_point_add_atomic_to(C, P, P, ec, ctx);
+	ok &= ec_point_cmp(C, D, ec->field);
+
+	ec_point_free(A);
+	A = ecp_mul_montgomery(P, x, ec);
+	ok &= ec_point_cmp(A, X, ec->field);
+
+	// every temporary was given back to the contexts
+	ok &= (ctx->top == 0 && ctx->depth == 0);
+	ok &= (ec_ctx_thread(NULL)->top == 0 && ec_ctx_thread(NULL)->depth == 0);
+	ok &= (ec_ctx_field_thread()->top == 0 && ec_ctx_field_thread()->depth == 0);
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+
+	ec_point_free(A); ec_point_free(B); ec_point_free(C);
+	ec_ctx_free(ctx);
+}
+
+static void ecp_mul_proj_test(ec_point P, ec_point X, mpz_t x, ec_group ec) {
+	fprintf(stdout, "\nverifying scalar multiplication in Jacobian coordinates ...\n");
+	mpz_t k; mpz_init(k);
+	int ok;
+
+	ec_point Rop = ecp_mul_proj(P, x, ec);
+	ok = ec_point_cmp(Rop, X, ec->field);
+	ec_point_free(Rop);
+
+	// order * G is the point at infinity, (order + 1) * G = G
+	Rop = ecp_mul_proj(ec->generator, ec->order, ec);
+	ok &= Rop->infinity;
+	ec_point_free(Rop);
+	mpz_add_ui(k, ec->order, 1);
+	Rop = ecp_mul_proj(ec->generator, k, ec);
+	ok &= ec_point_cmp(Rop, ec->generator, ec->field);
+	ec_point_free(Rop);
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+
+	mpz_clear(k);
+}
+
+static void ec_dbl_mul_proj_test(ec_point X, ec_point P, ec_point T, mpz_t d, mpz_t e, ec_group ec) {
+	fprintf(stdout, "\nverifying double scalar multiplication in Jacobian coordinates ...\n");
+	ec_point Rop = ecp_mul2_proj(P, d, T, e, ec);
+
+	if (ec_point_cmp(Rop, X, ec->field))
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+
+	ec_point_free(Rop);
+}
+
+/* Random state of the tests, seeded in main */
+static gmp_randstate_t test_state;
+
+static void test_report(int ok) {
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+}
+
+/* Scalar multiplication under test, k * P or NULL on failure */
+typedef ec_point (*ec_mul_func)(const ec_point P, const mpz_t k, ec_group ec);
+
+#define EC_EDGE_SCALARS	5
+
+/* Scalar number i for the multiplications: 0, 1, n - 1, n, 2n - 1 (the largest k + n of the
+ * signature), then random scalars below 2n */
+static void ec_edge_scalar(mpz_t k, int i, const ec_group ec) {
+	switch (i) {
+	case 0: mpz_set_ui(k, 0); break;
+	case 1: mpz_set_ui(k, 1); break;
+	case 2: mpz_sub_ui(k, ec->order, 1); break;
+	case 3: mpz_set(k, ec->order); break;
+	case 4: mpz_mul_2exp(k, ec->order, 1); mpz_sub_ui(k, k, 1); break;
+	default: mpz_mul_2exp(k, ec->order, 1); mpz_urandomm(k, test_state, k); break;
+	}
+}
+
+/* Compare mul(P, k) with ecp_mul_proj(P, k), a NULL result failing */
+static int ec_mul_cmp(ec_mul_func mul, const ec_point P, const mpz_t k, ec_group ec) {
+	ec_point R = mul(P, k, ec), S = ecp_mul_proj(P, k, ec);
+	int ok = (R != NULL && ec_point_cmp(R, S, ec->field));
+
+	if (R != NULL)
+		ec_point_free(R);
+	ec_point_free(S);
+	return ok;
+}
+
+/* Compare mul with ecp_mul_proj on the n first scalars of ec_edge_scalar */
+static int ec_mul_edge_cmp(ec_mul_func mul, const ec_point P, int n, ec_group ec) {
+	mpz_t k; mpz_init(k);
+	int i, ok = 1;
+
+	for (i = 0; i < n && ok; i++) {
+		ec_edge_scalar(k, i, ec);
+		ok &= ec_mul_cmp(mul, P, k, ec);
+	}
+	mpz_clear(k);
+	return ok;
+}
+
+/* A random point of ec */
+static ec_point ec_random_point(ec_group ec) {
+	mpz_t l; mpz_init(l);
+	ec_point P;
+
+	mpz_urandomm(l, test_state, ec->order);
+	P = ecp_mul_proj(ec->generator, l, ec);
+	mpz_clear(l);
+	return P;
+}
+
+/* The doubling formulas selected for the curve give the same multiples as the generic ones */
+static void ec_dbl_formulas_test(const char* name) {
+	fprintf(stdout, "\nverifying doubling formulas of the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	ec_a_form a_form = ec->a_form;
+	mpz_t k; mpz_init_set_str(k, "C51E4753AFDEC1E6B6C6A5B992F43F8DD0C7A8933072708B6522468B2FFB06FD", 16);
+
+	ec_point R = ecp_mul_proj(ec->generator, k, ec);
+	ec->a_form = EC_A_GENERIC;
+	ec_point S = ecp_mul_proj(ec->generator, k, ec);
+
+	if (a_form != EC_A_GENERIC && ec_point_cmp(R, S, ec->field) && ec_point_is_on_curve(R, ec))
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+
+	ec_point_free(R); ec_point_free(S);
+	mpz_clear(k);
+	ec_group_free(ec);
+}
+
+static ec_point ecp_mul_base_of(const ec_point P, const mpz_t k, ec_group ec) {
+	return ecp_mul_base(k, ec);
+}
+
+/* Multiples of the generator from the comb table against the variable-base multiplication */
+static void ecp_mul_base_test(const char* name) {
+	fprintf(stdout, "\nverifying fixed-base comb multiplication on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	int ok = (ecp_comb_get(ec) != NULL);
+
+	ok = ok && ec_mul_edge_cmp(ecp_mul_base_of, ec->generator, 20, ec);
+	test_report(ok);
+
+	ec_group_free(ec);
+}
+
+/* Compression round trip of random points, one by one and in a batch, and rejection of
+ * invalid encodings: x not on the curve, x >= p, wrong prefix */
+static void ec_decompress_test(const char* name) {
+	fprintf(stdout, "\nverifying point decompression on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	const int n = 8;
+	ec_point P[n], Q[n];
+	char *z[n];
+	int results[n];
+	mpz_t k, t; mpz_init(k); mpz_init(t);
+	int i, ok = 1;
+
+	for (i = 0; i < n; i++) {
+		mpz_urandomm(k, test_state, ec->order);
+		P[i] = ecp_mul_base(k, ec);
+		Q[i] = ec_point_init();
+		z[i] = ec_point_compress(P[i]);
+		ok &= (z[i][1] == (mpz_odd_p(P[i]->y) ? '3' : '2'));
+		ok &= ec_point_decompress(Q[i], z[i], ec) && ec_point_cmp(P[i], Q[i], ec->field);
+	}
+
+	/* x with no point on the curve */
+	mpz_set(t, ec->generator->x);
+	do {
+		mpz_add_ui(t, t, 1);
+		mpz_powm_ui(k, t, 3, ec->field);
+		mpz_addmul(k, ec->A, t);
+		mpz_add(k, k, ec->B);
+		mpz_mod(k, k, ec->field);
+	} while (mpz_legendre(k, ec->field) != -1);
+	free(z[3]);
+	z[3] = malloc(mpz_sizeinbase(t, 16) + 3);
+	strcpy(z[3], "02");
+	mpz_get_str(z[3] + 2, 16, t);
+	ok &= !ec_point_decompress(Q[3], z[3], ec);
+
+	/* x = p and the prefix of an uncompressed point */
+	free(z[5]);
+	z[5] = malloc(mpz_sizeinbase(ec->field, 16) + 3);
+	strcpy(z[5], "03");
+	mpz_get_str(z[5] + 2, 16, ec->field);
+	ok &= !ec_point_decompress(Q[5], z[5], ec);
+	z[6][1] = '4';
+
+	ok &= (ec_point_decompress_batch(Q, (const char **) z, n, ec, results) == n - 3);
+	for (i = 0; i < n; i++) {
+		ok &= (results[i] == (i != 3 && i != 5 && i != 6));
+		if (results[i])
+			ok &= ec_point_cmp(P[i], Q[i], ec->field);
+	}
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+
+	for (i = 0; i < n; i++) {
+		ec_point_free(P[i]); ec_point_free(Q[i]);
+		free(z[i]);
+	}
+	mpz_clear(k); mpz_clear(t);
+	ec_group_free(ec);
+}
+
+/* k * G + 0 * P and 0 * G + k * P with the interleaved wNAF, P = G giving k * G on both sides */
+static ec_point ecp_mul2_base_k(const ec_point P, const mpz_t k, ec_group ec) {
+	mpz_t z; mpz_init(z);
+	ec_point R = ecp_mul2_base(k, P, z, ec);
+
+	mpz_clear(z);
+	return R;
+}
+
+static ec_point ecp_mul2_base_l(const ec_point P, const mpz_t k, ec_group ec) {
+	mpz_t z; mpz_init(z);
+	ec_point R = ecp_mul2_base(z, P, k, ec);
+
+	mpz_clear(z);
+	return R;
+}
+
+/* Interleaved wNAF k * G + l * Q against two separate multiplications, including Q = G and Q = -G */
+static void ecp_mul2_base_test(const char* name) {
+	fprintf(stdout, "\nverifying simultaneous multiplication on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	mpz_t k, l, t; mpz_init(k); mpz_init(l); mpz_init(t);
+	int naf[FE_BITS + 2];
+	int i, j, len, ok = 1;
+
+	ok &= ec_mul_edge_cmp(ecp_mul2_base_k, ec->generator, EC_EDGE_SCALARS, ec);
+	ok &= ec_mul_edge_cmp(ecp_mul2_base_l, ec->generator, EC_EDGE_SCALARS, ec);
+	for (i = 0; i < 20 && ok; i++) {
+		mpz_urandomm(k, test_state, ec->order);
+		mpz_urandomm(l, test_state, ec->order);
+		ec_point Q = ecp_mul_proj(ec->generator, l, ec);
+		if (i == 0)
+			mpz_set_ui(k, 0);
+		if (i == 1) {	// Q = G, l * Q = k * G
+			ec_point_cpy(Q, ec->generator);
+			mpz_set(l, k);
+		}
+		if (i == 2) {	// Q = -G, the sum is the point at infinity
+			mpz_sub(t, ec->field, ec->generator->y);
+			ec_point_set_mpz(Q, ec->generator->x, t);
+			mpz_set(l, k);
+		}
+
+		ec_point R = ecp_mul2_base(k, Q, l, ec);
+		ec_point S = ecp_mul2_proj(ec->generator, k, Q, l, ec);
+		ok &= ec_point_cmp(R, S, ec->field);
+		ec_point_free(R); ec_point_free(S); ec_point_free(Q);
+
+		// the NAF digits add up to the scalar
+		len = ecp_wnaf_recode(naf, k, ECP_WNAF_WINDOW);
+		mpz_set_ui(t, 0);
+		for (j = len - 1; j >= 0; j--) {
+			mpz_mul_2exp(t, t, 1);
+			if (naf[j] >= 0)
+				mpz_add_ui(t, t, naf[j]);
+			else
+				mpz_sub_ui(t, t, -naf[j]);
+		}
+		ok &= (mpz_cmp(t, k) == 0);
+	}
+	test_report(ok);
+
+	mpz_clear(k); mpz_clear(l); mpz_clear(t);
+	ec_group_free(ec);
+}
+
+
+/* Width of ecp_mul_wnaf_of */
+static int test_wnaf_width;
+
+static ec_point ecp_mul_wnaf_of(const ec_point P, const mpz_t k, ec_group ec) {
+	return ecp_mul_wnaf(P, k, test_wnaf_width, ec);
+}
+
+/* Variable-time wNAF k * P of every width against the Jacobian multiplication, on the edge
+ * scalars and a scalar of FE_BITS bits */
+static void ecp_mul_wnaf_test(const char* name) {
+	fprintf(stdout, "\nverifying wNAF multiplication on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	ec_point P = ec_random_point(ec);
+	mpz_t k; mpz_init(k);
+	int ok = 1;
+
+	for (test_wnaf_width = 2; test_wnaf_width <= 8 && ok; test_wnaf_width++) {
+		ok &= ec_mul_edge_cmp(ecp_mul_wnaf_of, P, 10, ec);
+		mpz_urandomb(k, test_state, FE_BITS);
+		mpz_setbit(k, FE_BITS - 1);
+		ok &= ec_mul_cmp(ecp_mul_wnaf_of, P, k, ec);
+	}
+	test_report(ok);
+
+	ec_point_free(P);
+	mpz_clear(k);
+	ec_group_free(ec);
+}
+
+/* Constant-time fixed-window k * P against the Jacobian multiplication, on the edge scalars
+ * and scalars with zero windows */
+static void ec_sec_wmul_test(const char* name) {
+	fprintf(stdout, "\nverifying fixed-window multiplication on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	ec_point P = ec_random_point(ec);
+	mpz_t k; mpz_init(k);
+	int ok;
+
+	ok = ec_mul_edge_cmp(ec_sec_wmul, P, 20, ec);
+
+	// zero windows but one
+	mpz_set_ui(k, 0);
+	mpz_setbit(k, mpz_sizeinbase(ec->order, 2) / 2);
+	ok &= ec_mul_cmp(ec_sec_wmul, P, k, ec);
+	// low windows all zero
+	mpz_urandomm(k, test_state, ec->order);
+	mpz_tdiv_q_2exp(k, k, 128);
+	mpz_mul_2exp(k, k, 128);
+	ok &= ec_mul_cmp(ec_sec_wmul, P, k, ec);
+	test_report(ok);
+
+	ec_point_free(P);
+	mpz_clear(k);
+	ec_group_free(ec);
+}
+
+/* Complete formulas on the exceptional cases P + P, P + (-P), O + P, P + O and O + O, and the
+ * ladder built on them against the Jacobian multiplication, with the formulas of the form of A
+ * and those for any A */
+static void ec_complete_test(const char* name) {
+	fprintf(stdout, "\nverifying complete addition formulas on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	ec_point P = ec_random_point(ec);
+	mpz_t k, t; mpz_init(k); mpz_init(t);
+	int ok = 1;
+
+	ec_point N = ec_point_init(), O = ec_point_init();
+	mpz_sub(t, ec->field, P->y);
+	ec_point_set_mpz(N, P->x, t);
+	ec_point_set_at_infinity(O);
+
+	ec_point R = ec_point_add_atomic(P, P, ec), S = ec_point_dbl(P, ec);
+	ok &= ec_point_cmp(R, S, ec->field);
+	ec_point_free(R); ec_point_free(S);
+	R = ec_point_add_atomic(P, N, ec);
+	ok &= R->infinity;
+	ec_point_free(R);
+	R = ec_point_add_atomic(O, P, ec);
+	ok &= ec_point_cmp(R, P, ec->field);
+	ec_point_free(R);
+	R = ec_point_add_atomic(P, O, ec);
+	ok &= ec_point_cmp(R, P, ec->field);
+	ec_point_free(R);
+	R = ec_point_add_atomic(O, O, ec);
+	ok &= R->infinity;
+	ec_point_free(R);
+
+	ok &= ec_mul_edge_cmp(ecp_mul_complete, P, 20, ec);
+
+	// the formulas for any A give the same multiples
+	ec_edge_scalar(k, EC_EDGE_SCALARS, ec);
+	ec->a_form = EC_A_GENERIC;
+	R = ecp_mul_complete(P, k, ec);
+	ec_group_init_arith(ec);
+	S = ecp_mul_proj(P, k, ec);
+	ok &= ec_point_cmp(R, S, ec->field);
+	ec_point_free(R); ec_point_free(S);
+	test_report(ok);
+
+	ec_point_free(P); ec_point_free(N); ec_point_free(O);
+	mpz_clear(k); mpz_clear(t);
+	ec_group_free(ec);
+}
+
+/* The co-Z ladders do not modify the scalar */
+static ec_point ecp_mul_montgomery_of(const ec_point P, const mpz_t k, ec_group ec) {
+	return ecp_mul_montgomery(P, (mpz_ptr) k, ec);
+}
+
+static ec_point ecp_mul_rand_montgomery_of(const ec_point P, const mpz_t k, ec_group ec) {
+	return ecp_mul_rand_montgomery(P, (mpz_ptr) k, ec);
+}
+
+/* Co-Z Montgomery ladders, plain and with a random Z, against the Jacobian multiplication, on
+ * the edge scalars and the exceptional cases of the ladder 2, n - 3, n - 2, (n - 1) / 2 and
+ * (n + 1) / 2 */
+static void ec_coz_test(const char* name) {
+	fprintf(stdout, "\nverifying co-Z Montgomery ladders on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	ec_point P = ec_random_point(ec);
+	mpz_t k; mpz_init(k);
+	int i, ok;
+
+	ok = ec_mul_edge_cmp(ecp_mul_montgomery_of, P, 20, ec);
+	ok &= ec_mul_edge_cmp(ecp_mul_rand_montgomery_of, P, 20, ec);
+	for (i = 0; i < 5 && ok; i++) {
+		switch (i) {
+		case 0: mpz_set_ui(k, 2); break;
+		case 1: mpz_sub_ui(k, ec->order, 3); break;
+		case 2: mpz_sub_ui(k, ec->order, 2); break;
+		case 3: mpz_sub_ui(k, ec->order, 1); mpz_fdiv_q_2exp(k, k, 1); break;
+		default: mpz_add_ui(k, ec->order, 1); mpz_fdiv_q_2exp(k, k, 1); break;
+		}
+		ok &= ec_mul_cmp(ecp_mul_montgomery_of, P, k, ec);
+		ok &= ec_mul_cmp(ecp_mul_rand_montgomery_of, P, k, ec);
+	}
+	test_report(ok);
+
+	ec_point_free(P);
+	mpz_clear(k);
+	ec_group_free(ec);
+}
+
+/* GLV endomorphism of secp256k1: phi(G) = lambda * G, and the split of scalars into halves of
+ * FE_BITS / 2 bits adding up to the scalar, including the edge cases 0, 1, n - 1 and lambda */
+static void ecp_glv_test(const char* name) {
+	fprintf(stdout, "\nverifying the GLV endomorphism on the curve %s ...\n", name);
+	ec_group ec = ec_group_init_by_curve_name(name);
+	mpz_t k, lambda, t, u, z; mpz_init(k); mpz_init(lambda); mpz_init(t); mpz_init(u);
+	ecp_fe g, h;
+	fe_t k1, k2;
+	int i, neg1, neg2, ok = (ec->glv != NULL);
+
+	if (ok) {
+		fe_to_mpz(lambda, ec->glv->lambda, ec->fn);
+		ec_point L = ecp_mul_proj(ec->generator, lambda, ec);
+		ec_point E = ec_point_init();
+		ecp_fe_set_point(&g, ec->generator, ec);
+		ecp_glv_endo(&h, &g, ec);
+		ecp_fe_get_point(E, &h, ec);
+		ok &= ec_point_cmp(L, E, ec->field);
+		ec_point_free(L); ec_point_free(E);
+	}
+
+	for (i = 0; i < 100 && ok; i++) {
+		if (i < 3)	// 0, 1, n - 1
+			ec_edge_scalar(k, i, ec);
+		else if (i == 3)
+			mpz_set(k, lambda);
+		else
+			mpz_urandomm(k, test_state, ec->order);
+		ec_glv_split(k1, &neg1, k2, &neg2, k, ec);
+		mpz_set(t, mpz_roinit_n(z, k1, FE_LIMBS));
+		mpz_set(u, mpz_roinit_n(z, k2, FE_LIMBS));
+		ok &= mpz_sizeinbase(t, 2) <= FE_BITS / 2 && mpz_sizeinbase(u, 2) <= FE_BITS / 2;
+
+		// (-1)^neg1 * k1 + (-1)^neg2 * k2 * lambda = k mod n
+		if (neg1)
+			mpz_neg(t, t);
+		if (neg2)
+			mpz_neg(u, u);
+		mpz_mul(u, u, lambda);
+		mpz_add(u, u, t);
+		mpz_sub(u, u, k);
+		ok &= mpz_divisible_p(u, ec->order);
+	}
+
+	test_report(ok);
+
+	mpz_clear(k); mpz_clear(lambda); mpz_clear(t); mpz_clear(u);
+	ec_group_free(ec);
+}
+
 
 static void nist_single_test(const struct nistp_params *test) {
 	fprintf(stdout, "\n-------------------------------------------------------------");
@@ -277,6 +775,9 @@ static void nist_single_test(const struct nistp_params *test) {
 	//ec_mul_test(G, Q, d, ec);
 	ecp_mul_test(P, X, x, ec);
 	ec_dbl_mul_test(Y, P, T, x, y, ec);
+	ec_inplace_test(P, T, R, D, X, x, ec);
+	ecp_mul_proj_test(P, X, x, ec);
+	ec_dbl_mul_proj_test(Y, P, T, x, y, ec);
 
 	/* Release memory for struct/variables used */
 	ec_group_free(ec);
@@ -294,12 +795,61 @@ static void nist_single_test(const struct nistp_params *test) {
 int main(int argc, char* argv[]) {
 
 	unsigned i;
+	unsigned long seed = argc > 1 ? strtoul(argv[1], NULL, 10) : (unsigned long) time(NULL);
+
+	fprintf(stdout, "random seed %lu\n", seed);
+	gmp_randinit_default(test_state);
+	gmp_randseed_ui(test_state, seed);
 
 	for (i = 0;
 			i < sizeof(nistps_params) / sizeof(struct nistp_params);
 			i++) {
 		nist_single_test(&nistps_params[i]);
 	}
+
+	ec_dbl_formulas_test("secp224r1");
+	ec_dbl_formulas_test("secp256r1");
+	ec_dbl_formulas_test("secp224k1");
+	ec_dbl_formulas_test("secp256k1");
+
+	ecp_mul_base_test("secp224r1");
+	ecp_mul_base_test("secp256r1");
+	ecp_mul_base_test("secp224k1");
+	ecp_mul_base_test("secp256k1");
+
+	ecp_mul2_base_test("secp224r1");
+	ecp_mul2_base_test("secp256r1");
+	ecp_mul2_base_test("secp224k1");
+	ecp_mul2_base_test("secp256k1");
+
+	ec_decompress_test("secp224r1");
+	ec_decompress_test("secp256r1");
+	ec_decompress_test("secp224k1");
+	ec_decompress_test("secp256k1");
+
+	ecp_mul_wnaf_test("secp224r1");
+	ecp_mul_wnaf_test("secp256r1");
+	ecp_mul_wnaf_test("secp224k1");
+	ecp_mul_wnaf_test("secp256k1");
+
+	ec_sec_wmul_test("secp224r1");
+	ec_sec_wmul_test("secp256r1");
+	ec_sec_wmul_test("secp224k1");
+	ec_sec_wmul_test("secp256k1");
+
+	ec_complete_test("secp224r1");
+	ec_complete_test("secp256r1");
+	ec_complete_test("secp224k1");
+	ec_complete_test("secp256k1");
+
+	ec_coz_test("secp224r1");
+	ec_coz_test("secp256r1");
+	ec_coz_test("secp224k1");
+	ec_coz_test("secp256k1");
+
+	ecp_glv_test("secp256k1");
+
+	gmp_randclear(test_state);
 	return 0;
 
 }
@@ -0,0 +1,1105 @@
+/*
+ * fe_ops.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#include "ecdsa.h"
+#include "fe_ops.h"
+
+typedef unsigned __int128 fe_dlimb;
+typedef __int128 fe_sdlimb;
+
+/*
+ * Limb helpers on FE_LIMBS limbs. They return the carry (resp. borrow) out of the top limb
+ */
+static inline mp_limb_t fe_add_n(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b) {
+	fe_dlimb t = 0;
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++) {
+		t += (fe_dlimb) a[i] + b[i];
+		r[i] = (mp_limb_t) t;
+		t >>= GMP_LIMB_BITS;
+	}
+	return (mp_limb_t) t;
+}
+
+static inline mp_limb_t fe_sub_n(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b) {
+	fe_dlimb t;
+	mp_limb_t borrow = 0;
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++) {
+		t = (fe_dlimb) a[i] - b[i] - borrow;
+		r[i] = (mp_limb_t) t;
+		borrow = (mp_limb_t) (t >> GMP_LIMB_BITS) & 1;
+	}
+	return borrow;
+}
+
+/* r = mask ? a : b, where mask is either 0 or all ones */
+static inline void fe_select(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b, mp_limb_t mask) {
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++)
+		r[i] = (a[i] & mask) | (b[i] & ~mask);
+}
+
+/*
+ * Conditional final subtraction of the Montgomery algorithms: r = a - p if (carry:a) >= p,
+ * r = a otherwise. Require: (carry:a) < 2p
+ */
+static inline void fe_reduce_once(fe_t r, const mp_limb_t *a, mp_limb_t carry, const fe_field f) {
+	fe_t s;
+	mp_limb_t borrow;
+
+	borrow = fe_sub_n(s, a, f->p);
+	fe_select(r, a, s, 0 - (borrow & (carry ^ 1)));
+}
+
+/*
+ * Montgomery reduction r = t * R^-1 mod p of a 2 * FE_LIMBS limbs value t < p * R.
+ * t is destroyed
+ */
+static void fe_mont_reduce(fe_t r, mp_limb_t *t, const fe_field f) {
+	fe_dlimb uv;
+	mp_limb_t m, c, hi = 0;
+	int i, j;
+
+	for (i = 0; i < FE_LIMBS; i++) {
+		m = t[i] * f->n0;
+		c = 0;
+		for (j = 0; j < FE_LIMBS; j++) {
+			uv = (fe_dlimb) m * f->p[j] + t[i + j] + c;
+			t[i + j] = (mp_limb_t) uv;
+			c = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+		}
+		uv = (fe_dlimb) t[i + FE_LIMBS] + c + hi;
+		t[i + FE_LIMBS] = (mp_limb_t) uv;
+		hi = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+	}
+	fe_reduce_once(r, t + FE_LIMBS, hi, f);
+}
+
+/*
+ * Montgomery multiplication r = a * b * R^-1 mod p, Coarsely Integrated Operand Scanning:
+ * one multiplication row and one reduction row per limb of b
+ */
+static void fe_mont_mul(fe_t r, const fe_t a, const fe_t b, const fe_field f) {
+	mp_limb_t t[FE_LIMBS + 2];
+	fe_dlimb uv;
+	mp_limb_t m, c;
+	int i, j;
+
+	for (i = 0; i < FE_LIMBS + 2; i++)
+		t[i] = 0;
+
+	for (i = 0; i < FE_LIMBS; i++) {
+		c = 0;
+		for (j = 0; j < FE_LIMBS; j++) {
+			uv = (fe_dlimb) a[j] * b[i] + t[j] + c;
+			t[j] = (mp_limb_t) uv;
+			c = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+		}
+		uv = (fe_dlimb) t[FE_LIMBS] + c;
+		t[FE_LIMBS] = (mp_limb_t) uv;
+		t[FE_LIMBS + 1] = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+
+		m = t[0] * f->n0;
+		uv = (fe_dlimb) m * f->p[0] + t[0];
+		c = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+		for (j = 1; j < FE_LIMBS; j++) {
+			uv = (fe_dlimb) m * f->p[j] + t[j] + c;
+			t[j - 1] = (mp_limb_t) uv;
+			c = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+		}
+		uv = (fe_dlimb) t[FE_LIMBS] + c;
+		t[FE_LIMBS - 1] = (mp_limb_t) uv;
+		t[FE_LIMBS] = t[FE_LIMBS + 1] + (mp_limb_t) (uv >> GMP_LIMB_BITS);
+	}
+	fe_reduce_once(r, t, t[FE_LIMBS], f);
+}
+
+/*
+ * Full product t = a * b, on 2 * FE_LIMBS limbs
+ */
+static void fe_mul_wide(mp_limb_t *t, const fe_t a, const fe_t b) {
+	fe_dlimb uv;
+	mp_limb_t c;
+	int i, j;
+
+	for (i = 0; i < 2 * FE_LIMBS; i++)
+		t[i] = 0;
+
+	for (i = 0; i < FE_LIMBS; i++) {
+		c = 0;
+		for (j = 0; j < FE_LIMBS; j++) {
+			uv = (fe_dlimb) a[j] * b[i] + t[i + j] + c;
+			t[i + j] = (mp_limb_t) uv;
+			c = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+		}
+		t[i + FE_LIMBS] = c;
+	}
+}
+
+/*
+ * Full square t = a^2, on 2 * FE_LIMBS limbs: the cross products are computed once and doubled
+ */
+static void fe_sqr_wide(mp_limb_t *t, const fe_t a) {
+	fe_dlimb uv;
+	mp_limb_t c, hi;
+	int i, j;
+
+	for (i = 0; i < 2 * FE_LIMBS; i++)
+		t[i] = 0;
+
+	/* cross products a[i] * a[j], i < j */
+	for (i = 0; i < FE_LIMBS - 1; i++) {
+		c = 0;
+		for (j = i + 1; j < FE_LIMBS; j++) {
+			uv = (fe_dlimb) a[i] * a[j] + t[i + j] + c;
+			t[i + j] = (mp_limb_t) uv;
+			c = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+		}
+		t[i + FE_LIMBS] = c;
+	}
+
+	/* double them */
+	c = 0;
+	for (i = 0; i < 2 * FE_LIMBS; i++) {
+		hi = t[i] >> (GMP_LIMB_BITS - 1);
+		t[i] = (t[i] << 1) | c;
+		c = hi;
+	}
+
+	/* add the squares a[i]^2 */
+	c = 0;
+	for (i = 0; i < FE_LIMBS; i++) {
+		uv = (fe_dlimb) a[i] * a[i] + t[2 * i] + c;
+		t[2 * i] = (mp_limb_t) uv;
+		uv = (fe_dlimb) t[2 * i + 1] + (mp_limb_t) (uv >> GMP_LIMB_BITS);
+		t[2 * i + 1] = (mp_limb_t) uv;
+		c = (mp_limb_t) (uv >> GMP_LIMB_BITS);
+	}
+}
+
+/*
+ * Montgomery reduction r = t * R^-1 mod p for p = 2^224 - 2^96 + 1, t < p * R.
+ * Since p = 1 mod 2^64 the quotient digit is m = -t[i], and m * p = m * 2^224 - m * 2^96 + m
+ * only needs shifts. t[i] + m clears limb i with a carry iff t[i] != 0. t is destroyed
+ */
+static inline void fe_reduce_p224(fe_t r, mp_limb_t *t, const fe_field f) {
+	fe_sdlimb acc;
+	mp_limb_t m, hi = 0;
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++) {
+		m = 0 - t[i];
+		acc = (fe_sdlimb) t[i + 1] + (t[i] != 0) - (fe_sdlimb) (m << 32);
+		t[i + 1] = (mp_limb_t) acc;
+		acc >>= 64;
+		acc += (fe_sdlimb) t[i + 2] - (fe_sdlimb) (m >> 32);
+		t[i + 2] = (mp_limb_t) acc;
+		acc >>= 64;
+		acc += (fe_sdlimb) t[i + 3] + (m << 32);
+		t[i + 3] = (mp_limb_t) acc;
+		acc >>= 64;
+		acc += (fe_sdlimb) t[i + 4] + (m >> 32) + hi;
+		t[i + 4] = (mp_limb_t) acc;
+		hi = (mp_limb_t) (acc >> 64);
+	}
+	fe_reduce_once(r, t + FE_LIMBS, hi, f);
+}
+
+/*
+ * Montgomery reduction r = t * R^-1 mod p for p = 2^256 - 2^224 + 2^192 + 2^96 - 1, t < p * R.
+ * Since p = -1 mod 2^64 the quotient digit is m = t[i], and the sparse limbs of p
+ * (2^64 - 1, 2^32 - 1, 0, 2^64 - 2^32 + 1) turn each row into one multiplication and a few
+ * additions. t is destroyed
+ */
+static inline void fe_reduce_p256(fe_t r, mp_limb_t *t, const fe_field f) {
+	fe_dlimb uv, mp;
+	mp_limb_t m, c, hi = 0;
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++) {
+		m = t[i];
+		/* t[i] + m * (2^64 - 1) = m * 2^64, so the row starts with m * 2^32 at limb i + 1 */
+		uv = (fe_dlimb) t[i + 1] + (m << 32);
+		t[i + 1] = (mp_limb_t) uv;
+		c = (mp_limb_t) (uv >> 64);
+		uv = (fe_dlimb) t[i + 2] + (m >> 32) + c;
+		t[i + 2] = (mp_limb_t) uv;
+		c = (mp_limb_t) (uv >> 64);
+		mp = (fe_dlimb) m * 0xFFFFFFFF00000001ULL;
+		uv = (fe_dlimb) t[i + 3] + (mp_limb_t) mp + c;
+		t[i + 3] = (mp_limb_t) uv;
+		c = (mp_limb_t) (uv >> 64);
+		uv = (fe_dlimb) t[i + 4] + (mp_limb_t) (mp >> 64) + c + hi;
+		t[i + 4] = (mp_limb_t) uv;
+		hi = (mp_limb_t) (uv >> 64);
+	}
+	fe_reduce_once(r, t + FE_LIMBS, hi, f);
+}
+
+/*
+ * Reduction modulo p = 2^256 - c of t < 2^512, using 2^256 = c mod p.
+ * t = L + H * 2^256 -> L + H * c < 2^320 -> folding the top limb again leaves at most one
+ * carry, which folds in without overflow. The result < 2^256 < 2p, then a conditional subtraction
+ */
+static inline void fe_reduce_pm(fe_t r, const mp_limb_t *t, const fe_field f) {
+	mp_limb_t a[FE_LIMBS], top, k;
+	fe_dlimb uv;
+	int i;
+
+	top = 0;
+	for (i = 0; i < FE_LIMBS; i++) {
+		uv = (fe_dlimb) t[FE_LIMBS + i] * f->c + t[i] + top;
+		a[i] = (mp_limb_t) uv;
+		top = (mp_limb_t) (uv >> 64);
+	}
+
+	uv = (fe_dlimb) top * f->c + a[0];
+	a[0] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[1] + (mp_limb_t) (uv >> 64);
+	a[1] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[2] + (mp_limb_t) (uv >> 64);
+	a[2] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[3] + (mp_limb_t) (uv >> 64);
+	a[3] = (mp_limb_t) uv;
+	k = (mp_limb_t) (uv >> 64);
+
+	/* a < 2^128 when k = 1, so adding c cannot carry out */
+	uv = (fe_dlimb) a[0] + (f->c & (0 - k));
+	a[0] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[1] + (mp_limb_t) (uv >> 64);
+	a[1] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[2] + (mp_limb_t) (uv >> 64);
+	a[2] = (mp_limb_t) uv;
+	a[3] += (mp_limb_t) (uv >> 64);
+
+	fe_reduce_once(r, a, 0, f);
+}
+
+/*
+ * Reduction modulo p = 2^224 - c of t < p^2, c < 2^62, using 2^224 = c mod p. The split falls in
+ * the middle of limb 3: t = L + H * 2^224 -> L + H * c < 2^287 -> folding the bits above 2^224
+ * again leaves < 2^224 + 2^125, whose bit 224 folds in without overflow since the rest is then
+ * < 2^125. The result < 2^224 < 2p, then a conditional subtraction
+ */
+static inline void fe_reduce_pm224(fe_t r, const mp_limb_t *t, const fe_field f) {
+	mp_limb_t a[FE_LIMBS], h, top, k;
+	fe_dlimb uv;
+	int i;
+
+	top = 0;
+	for (i = 0; i < FE_LIMBS; i++) {
+		h = (t[i + 3] >> 32) | (t[i + 4] << 32);
+		uv = (fe_dlimb) h * f->c + (i < 3 ? t[i] : t[3] & 0xFFFFFFFF) + top;
+		a[i] = (mp_limb_t) uv;
+		top = (mp_limb_t) (uv >> 64);
+	}
+
+	h = (a[3] >> 32) | (top << 32);
+	a[3] &= 0xFFFFFFFF;
+	uv = (fe_dlimb) h * f->c + a[0];
+	a[0] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[1] + (mp_limb_t) (uv >> 64);
+	a[1] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[2] + (mp_limb_t) (uv >> 64);
+	a[2] = (mp_limb_t) uv;
+	a[3] += (mp_limb_t) (uv >> 64);
+	k = a[3] >> 32;
+	a[3] &= 0xFFFFFFFF;
+
+	uv = (fe_dlimb) a[0] + (f->c & (0 - k));
+	a[0] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[1] + (mp_limb_t) (uv >> 64);
+	a[1] = (mp_limb_t) uv;
+	uv = (fe_dlimb) a[2] + (mp_limb_t) (uv >> 64);
+	a[2] = (mp_limb_t) uv;
+	a[3] += (mp_limb_t) (uv >> 64);
+
+	fe_reduce_once(r, a, 0, f);
+}
+
+/* Reduce a full product t < p^2 with the method of the field. t is destroyed */
+static inline void fe_reduce(fe_t r, mp_limb_t *t, const fe_field f) {
+	switch (f->red) {
+	case FE_RED_NIST_P224:
+		fe_reduce_p224(r, t, f);
+		break;
+	case FE_RED_NIST_P256:
+		fe_reduce_p256(r, t, f);
+		break;
+	case FE_RED_PSEUDO_MERSENNE:
+		if (f->bits == FE_BITS)
+			fe_reduce_pm(r, t, f);
+		else
+			fe_reduce_pm224(r, t, f);
+		break;
+	default:
+		fe_mont_reduce(r, t, f);
+		break;
+	}
+}
+
+/*-
+ * Inversion with the divsteps of Bernstein and Yang ("Fast constant-time gcd computation and
+ * modular inversion", 2019), organized as in libsecp256k1.
+ *
+ * f = p and g = a are held in signed 62-bit limbs. Each round applies 59 divsteps to the low
+ * bits of f and g only, accumulating them in a 2x2 matrix scaled by 2^62, then applies the
+ * matrix to the full f and g and to the Bezout coefficients d and e, which are kept in
+ * (-2p, p) with a multiple of p that clears their low 62 bits. 10 rounds, i.e. 590 divsteps,
+ * bring g to 0 for every modulus of at most 256 bits; then f = +-gcd(a, p) and d = +-a^-1 mod p.
+ * The number of rounds is fixed and the divsteps use masks instead of branches, so the
+ * sequence of operations and memory accesses does not depend on a.
+ */
+
+#define FE_S62_LIMBS	(FE_LIMBS + 1)
+#define FE_M62			(UINT64_MAX >> 2)
+#define FE_DIVSTEPS		59
+#define FE_ROUNDS		10
+
+/* Transition matrix of FE_DIVSTEPS divsteps, scaled by 2^62 */
+typedef struct {
+	int64_t u, v, q, r;
+} fe_trans;
+
+/* p^-1 mod 2^64 for odd p0, Newton iteration doubles the number of correct bits each step */
+static mp_limb_t fe_limb_inverse(mp_limb_t p0) {
+	mp_limb_t inv = p0;
+	int i;
+
+	for (i = 0; i < 5; i++)
+		inv *= 2 - p0 * inv;
+	return inv;
+}
+
+/* Convert a to signed 62-bit limbs */
+static void fe_to_s62(int64_t *r, const mp_limb_t *a) {
+	r[0] = a[0] & FE_M62;
+	r[1] = (a[0] >> 62 | a[1] << 2) & FE_M62;
+	r[2] = (a[1] >> 60 | a[2] << 4) & FE_M62;
+	r[3] = (a[2] >> 58 | a[3] << 6) & FE_M62;
+	r[4] = a[3] >> 56;
+}
+
+/* Convert back a in [0, 2^FE_BITS) with limbs 0 .. 3 in [0, 2^62) */
+static void fe_from_s62(mp_limb_t *r, const int64_t *a) {
+	r[0] = (uint64_t) a[0] | (uint64_t) a[1] << 62;
+	r[1] = (uint64_t) a[1] >> 2 | (uint64_t) a[2] << 60;
+	r[2] = (uint64_t) a[2] >> 4 | (uint64_t) a[3] << 58;
+	r[3] = (uint64_t) a[3] >> 6 | (uint64_t) a[4] << 56;
+}
+
+/*
+ * FE_DIVSTEPS divsteps on the low bits f0 and g0 of f and g, f odd. zeta = -(delta + 1/2):
+ * while delta > 0 and g is odd, (delta, f, g) -> (1 - delta, g, (g - f) / 2),
+ * otherwise (delta, f, g) -> (1 + delta, f, (g + (g mod 2) f) / 2).
+ * Return the new zeta and the transition matrix in t
+ */
+static int64_t fe_divsteps(int64_t zeta, uint64_t f0, uint64_t g0, fe_trans *t) {
+	uint64_t u = 8, v = 0, q = 0, r = 8;
+	uint64_t mask1, mask2, f = f0, g = g0, x, y, z;
+	int i;
+
+	for (i = 62 - FE_DIVSTEPS; i < 62; i++) {
+		mask1 = (uint64_t) (zeta >> 63);		/* delta > 0 */
+		mask2 = 0 - (g & 1);					/* g odd */
+		/* g = g - f if delta > 0, g + f otherwise, when g is odd */
+		x = (f ^ mask1) - mask1;
+		y = (u ^ mask1) - mask1;
+		z = (v ^ mask1) - mask1;
+		g += x & mask2;
+		q += y & mask2;
+		r += z & mask2;
+		/* swap: f takes the former g, with f + (g - f) */
+		mask1 &= mask2;
+		zeta = (zeta ^ (int64_t) mask1) - 1;
+		f += g & mask1;
+		u += q & mask1;
+		v += r & mask1;
+		g >>= 1;
+		u <<= 1;
+		v <<= 1;
+	}
+	t->u = (int64_t) u;
+	t->v = (int64_t) v;
+	t->q = (int64_t) q;
+	t->r = (int64_t) r;
+	return zeta;
+}
+
+/*
+ * (d, e) = t * (d, e) / 2^62 mod p. The multiples md and me of p are chosen so that the
+ * division is exact and the results stay in (-2p, p)
+ */
+static void fe_update_de(int64_t *d, int64_t *e, const fe_trans *t, const int64_t *p62, uint64_t pinv62) {
+	const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+	int64_t md, me, sd, se;
+	fe_sdlimb cd, ce;
+	int i;
+
+	/* add p times u, q if d < 0 and v, r if e < 0, keeping the results above -2p */
+	sd = d[FE_LIMBS] >> 63;
+	se = e[FE_LIMBS] >> 63;
+	md = (u & sd) + (v & se);
+	me = (q & sd) + (r & se);
+
+	cd = (fe_sdlimb) u * d[0] + (fe_sdlimb) v * e[0];
+	ce = (fe_sdlimb) q * d[0] + (fe_sdlimb) r * e[0];
+	md -= (pinv62 * (uint64_t) cd + md) & FE_M62;
+	me -= (pinv62 * (uint64_t) ce + me) & FE_M62;
+	cd += (fe_sdlimb) p62[0] * md;
+	ce += (fe_sdlimb) p62[0] * me;
+	cd >>= 62;
+	ce >>= 62;
+
+	for (i = 1; i < FE_S62_LIMBS; i++) {
+		cd += (fe_sdlimb) u * d[i] + (fe_sdlimb) v * e[i] + (fe_sdlimb) p62[i] * md;
+		ce += (fe_sdlimb) q * d[i] + (fe_sdlimb) r * e[i] + (fe_sdlimb) p62[i] * me;
+		d[i - 1] = (int64_t) ((uint64_t) cd & FE_M62);
+		e[i - 1] = (int64_t) ((uint64_t) ce & FE_M62);
+		cd >>= 62;
+		ce >>= 62;
+	}
+	d[FE_LIMBS] = (int64_t) cd;
+	e[FE_LIMBS] = (int64_t) ce;
+}
+
+/* (f, g) = t * (f, g) / 2^62, the division is exact */
+static void fe_update_fg(int64_t *f, int64_t *g, const fe_trans *t) {
+	const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+	fe_sdlimb cf, cg;
+	int i;
+
+	cf = (fe_sdlimb) u * f[0] + (fe_sdlimb) v * g[0];
+	cg = (fe_sdlimb) q * f[0] + (fe_sdlimb) r * g[0];
+	cf >>= 62;
+	cg >>= 62;
+
+	for (i = 1; i < FE_S62_LIMBS; i++) {
+		cf += (fe_sdlimb) u * f[i] + (fe_sdlimb) v * g[i];
+		cg += (fe_sdlimb) q * f[i] + (fe_sdlimb) r * g[i];
+		f[i - 1] = (int64_t) ((uint64_t) cf & FE_M62);
+		g[i - 1] = (int64_t) ((uint64_t) cg & FE_M62);
+		cf >>= 62;
+		cg >>= 62;
+	}
+	f[FE_LIMBS] = (int64_t) cf;
+	g[FE_LIMBS] = (int64_t) cg;
+}
+
+/* Bring r from (-2p, p) to [0, p), negated if sign < 0 */
+static void fe_normalize_s62(int64_t *r, int64_t sign, const int64_t *p62) {
+	int64_t cond_add, cond_negate;
+	int i;
+
+	cond_add = r[FE_LIMBS] >> 63;
+	for (i = 0; i < FE_S62_LIMBS; i++)
+		r[i] += p62[i] & cond_add;
+	cond_negate = sign >> 63;
+	for (i = 0; i < FE_S62_LIMBS; i++)
+		r[i] = (r[i] ^ cond_negate) - cond_negate;
+	for (i = 0; i < FE_LIMBS; i++) {
+		r[i + 1] += r[i] >> 62;
+		r[i] &= FE_M62;
+	}
+
+	/* r is in (-p, p) */
+	cond_add = r[FE_LIMBS] >> 63;
+	for (i = 0; i < FE_S62_LIMBS; i++)
+		r[i] += p62[i] & cond_add;
+	for (i = 0; i < FE_LIMBS; i++) {
+		r[i + 1] += r[i] >> 62;
+		r[i] &= FE_M62;
+	}
+}
+
+/* x = x^-1 mod p, x in [0, p) in signed 62-bit limbs. Return 1 if x is invertible; otherwise
+ * x = 0 if x was 0, and is unspecified if gcd(x, p) > 1 */
+static int fe_safegcd(int64_t *x, const int64_t *p62, uint64_t pinv62) {
+	int64_t d[FE_S62_LIMBS] = { 0 }, e[FE_S62_LIMBS] = { 1 }, f[FE_S62_LIMBS], g[FE_S62_LIMBS];
+	int64_t zeta = -1;		/* delta = 1/2 */
+	uint64_t one, minus_one;
+	fe_trans t;
+	int i;
+
+	for (i = 0; i < FE_S62_LIMBS; i++) {
+		f[i] = p62[i];
+		g[i] = x[i];
+	}
+	for (i = 0; i < FE_ROUNDS; i++) {
+		zeta = fe_divsteps(zeta, f[0], g[0], &t);
+		fe_update_de(d, e, &t, p62, pinv62);
+		fe_update_fg(f, g, &t);
+	}
+
+	/* g = 0 and f = +-gcd(x, p): x is invertible if f = 1 or f = -1 */
+	one = (uint64_t) (f[0] ^ 1) | (uint64_t) f[4];
+	minus_one = (uint64_t) (f[4] + 1);
+	for (i = 1; i < FE_LIMBS; i++) {
+		one |= (uint64_t) f[i];
+		minus_one |= (uint64_t) f[i] ^ FE_M62;
+	}
+	minus_one |= (uint64_t) f[0] ^ FE_M62;
+
+	fe_normalize_s62(d, f[FE_LIMBS], p62);
+	for (i = 0; i < FE_S62_LIMBS; i++)
+		x[i] = d[i];
+	return !one | !minus_one;
+}
+
+/* Return the addition chains of the exponents of p, FE_CHAIN_GENERIC if p has no known form */
+static fe_chain fe_select_chain(const mpz_t p) {
+	static const struct {
+		fe_chain chain;
+		const char *p;
+	} chains[] = {
+		{ FE_CHAIN_P224, "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF000000000000000000000001" },
+		{ FE_CHAIN_P256, "FFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF" },
+		{ FE_CHAIN_K256, "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F" }
+	};
+	fe_chain chain = FE_CHAIN_GENERIC;
+	mpz_t t;
+	int i;
+
+	mpz_init(t);
+	for (i = 0; i < sizeof(chains) / sizeof(chains[0]); i++) {
+		mpz_set_str(t, chains[i].p, 16);
+		if (mpz_cmp(p, t) == 0)
+			chain = chains[i].chain;
+	}
+	mpz_clear(t);
+	return chain;
+}
+
+/* Check that p has the form expected by the reduction method red */
+static int fe_check_reduction(const mpz_t p, fe_reduction red) {
+	mpz_t t;
+	int ok = 0;
+
+	mpz_init(t);
+	switch (red) {
+	case FE_RED_NIST_P224:
+		mpz_set_str(t, "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF000000000000000000000001", 16);
+		ok = (mpz_cmp(p, t) == 0);
+		break;
+	case FE_RED_NIST_P256:
+		mpz_set_str(t, "FFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF", 16);
+		ok = (mpz_cmp(p, t) == 0);
+		break;
+	case FE_RED_PSEUDO_MERSENNE:
+		/* c = 2^k - p must fit in a limb for k = 256, and leave room for the folds of
+		 * fe_reduce_pm224 for k = 224 (e.g. c = 2^32 + 6803 for secp224k1) */
+		mpz_setbit(t, mpz_sizeinbase(p, 2));
+		mpz_sub(t, t, p);
+		if (mpz_sizeinbase(p, 2) == FE_BITS)
+			ok = (mpz_size(t) <= 1);
+		else if (mpz_sizeinbase(p, 2) == 224)
+			ok = (mpz_sizeinbase(t, 2) <= 62);
+		break;
+	default:
+		ok = 1;
+		break;
+	}
+	mpz_clear(t);
+	return ok;
+}
+
+/** Create the arithmetic context of the modulus p
+ *	\param p	odd modulus, 2 < p < 2^FE_BITS
+ *	\param red	reduction method, FE_RED_MONTGOMERY is used instead if p does not have
+ *				the form required by red
+ *	\return		pointer to a fe_field structure or NULL if p is not supported
+ */
+fe_field fe_field_init(const mpz_t p, fe_reduction red) {
+	fe_field f;
+	mp_limb_t inv;
+	mpz_t t;
+	int i;
+
+	if (mpz_cmp_ui(p, 2) <= 0 || mpz_even_p(p) || mpz_size(p) > FE_LIMBS)
+		return NULL;
+
+	f = (fe_field) malloc(sizeof(struct fe_field_st));
+	assert(f != NULL);
+
+	for (i = 0; i < FE_LIMBS; i++)
+		f->p[i] = mpz_getlimbn(p, i);
+	f->size = mpz_size(p);
+	f->bits = mpz_sizeinbase(p, 2);
+
+	/* n0 = -p^-1 mod 2^64, and p in the form of the inversion */
+	inv = fe_limb_inverse(f->p[0]);
+	f->n0 = 0 - inv;
+	fe_to_s62(f->p62, f->p);
+	f->pinv62 = inv & FE_M62;
+
+	/* one = R mod p and r2 = R^2 mod p */
+	mpz_init(t);
+	mpz_setbit(t, FE_BITS);
+	mpz_mod(t, t, p);
+	for (i = 0; i < FE_LIMBS; i++)
+		f->one[i] = mpz_getlimbn(t, i);
+	mpz_mul(t, t, t);
+	mpz_mod(t, t, p);
+	for (i = 0; i < FE_LIMBS; i++)
+		f->r2[i] = mpz_getlimbn(t, i);
+
+	f->red = fe_check_reduction(p, red) ? red : FE_RED_MONTGOMERY;
+	f->chain = fe_select_chain(p);
+	f->mont = (f->red != FE_RED_PSEUDO_MERSENNE);
+	f->c = 0;
+	if (!f->mont) {
+		fe_set_zero(f->one);
+		f->one[0] = 1;
+	}
+	if (f->red == FE_RED_PSEUDO_MERSENNE) {
+		mpz_set_ui(t, 0);
+		mpz_setbit(t, f->bits);
+		mpz_sub(t, t, p);
+		f->c = mpz_getlimbn(t, 0);
+	}
+	mpz_clear(t);
+
+	return f;
+}
+
+void fe_field_free(fe_field f) {
+	if (f == NULL)
+		return;
+	memset(f, 0, sizeof(struct fe_field_st));
+	free(f);
+}
+
+/** Convert a big integer to a fixed-width element, a is reduced modulo p if needed
+ */
+void fe_from_mpz(fe_t r, const mpz_t a, const fe_field f) {
+	mpz_t p, t;
+	int i;
+
+	mpz_roinit_n(p, f->p, f->size);
+	if (LIKELY(mpz_sgn(a) >= 0 && mpz_cmp(a, p) < 0)) {
+		for (i = 0; i < FE_LIMBS; i++)
+			r[i] = mpz_getlimbn(a, i);
+	} else {
+		mpz_init(t);
+		mpz_mod(t, a, p);
+		for (i = 0; i < FE_LIMBS; i++)
+			r[i] = mpz_getlimbn(t, i);
+		mpz_clear(t);
+	}
+	fe_set_limbs(r, r, f);
+}
+
+void fe_to_mpz(mpz_t r, const fe_t a, const fe_field f) {
+	fe_t c;
+	mpz_t z;
+
+	fe_get_limbs(c, a, f);
+	mpz_set(r, mpz_roinit_n(z, c, FE_LIMBS));
+}
+
+void fe_set_limbs(fe_t r, const fe_t a, const fe_field f) {
+	/* enter the Montgomery domain: a * R = REDC(a * R^2) */
+	if (f->mont)
+		fe_mont_mul(r, a, f->r2, f);
+	else
+		fe_copy(r, a);
+}
+
+void fe_get_limbs(fe_t r, const fe_t a, const fe_field f) {
+	mp_limb_t t[2 * FE_LIMBS];
+	int i;
+
+	/* leave the Montgomery domain: a = REDC(a * R) */
+	if (f->mont) {
+		for (i = 0; i < FE_LIMBS; i++) {
+			t[i] = a[i];
+			t[i + FE_LIMBS] = 0;
+		}
+		fe_mont_reduce(r, t, f);
+	} else
+		fe_copy(r, a);
+}
+
+/*
+ * Compute r = round(a * b / 2^shift) for plain integers a, b. Require: FE_BITS <= shift < 2 * FE_BITS.
+ * The shift is public, the time does not depend on a and b
+ */
+void fe_mul_shift(fe_t r, const fe_t a, const fe_t b, int shift) {
+	mp_limb_t t[2 * FE_LIMBS], c;
+	int limb = shift / GMP_LIMB_BITS, bit = shift % GMP_LIMB_BITS, i;
+
+	assert(shift >= FE_BITS && shift < 2 * FE_BITS);
+	fe_mul_wide(t, a, b);
+
+	/* the bit below the shift rounds to the nearest */
+	c = (t[(shift - 1) / GMP_LIMB_BITS] >> ((shift - 1) % GMP_LIMB_BITS)) & 1;
+	for (i = 0; i < FE_LIMBS; i++) {
+		r[i] = 0;
+		if (limb + i < 2 * FE_LIMBS)
+			r[i] = t[limb + i] >> bit;
+		if (bit != 0 && limb + i + 1 < 2 * FE_LIMBS)
+			r[i] |= t[limb + i + 1] << (GMP_LIMB_BITS - bit);
+		r[i] += c;
+		c = r[i] < c;
+	}
+}
+
+void fe_copy(fe_t r, const fe_t a) {
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++)
+		r[i] = a[i];
+}
+
+void fe_set_zero(fe_t r) {
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++)
+		r[i] = 0;
+}
+
+void fe_set_one(fe_t r, const fe_field f) {
+	fe_copy(r, f->one);
+}
+
+/** Return 1 if a = 0, 0 otherwise
+ */
+int fe_is_zero(const fe_t a) {
+	mp_limb_t z = 0;
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++)
+		z |= a[i];
+	return (int) (((z | (0 - z)) >> (GMP_LIMB_BITS - 1)) ^ 1);
+}
+
+/** Return 1 if a = b, 0 otherwise
+ */
+int fe_equal(const fe_t a, const fe_t b) {
+	mp_limb_t z = 0;
+	int i;
+
+	for (i = 0; i < FE_LIMBS; i++)
+		z |= a[i] ^ b[i];
+	return (int) (((z | (0 - z)) >> (GMP_LIMB_BITS - 1)) ^ 1);
+}
+
+/** Copy a to r if flag = 1, leave r unchanged if flag = 0
+ */
+void fe_cmov(fe_t r, const fe_t a, int flag) {
+	fe_select(r, a, r, 0 - (mp_limb_t) flag);
+}
+
+/*
+ * Compute R = A + B mod p. Require: A, B < p
+ */
+void fe_add(fe_t r, const fe_t a, const fe_t b, const fe_field f) {
+	fe_t t, s;
+	mp_limb_t carry, borrow;
+
+	carry = fe_add_n(t, a, b);
+	borrow = fe_sub_n(s, t, f->p);
+	/* keep the sum when subtracting p borrows and the sum itself did not overflow */
+	fe_select(r, t, s, 0 - (borrow & (carry ^ 1)));
+}
+
+/*
+ * Compute R = A - B mod p. Require: A, B < p
+ */
+void fe_sub(fe_t r, const fe_t a, const fe_t b, const fe_field f) {
+	fe_t t, s;
+	mp_limb_t borrow;
+
+	borrow = fe_sub_n(t, a, b);
+	fe_add_n(s, t, f->p);
+	fe_select(r, s, t, 0 - borrow);
+}
+
+/*
+ * Compute R = -A mod p. Require: A < p
+ */
+void fe_neg(fe_t r, const fe_t a, const fe_field f) {
+	fe_t zero;
+
+	fe_set_zero(zero);
+	fe_sub(r, zero, a, f);
+}
+
+/*
+ * Compute R = A * B mod p, in the representation of the field. Require: A, B < p
+ */
+void fe_mul(fe_t r, const fe_t a, const fe_t b, const fe_field f) {
+	mp_limb_t t[2 * FE_LIMBS];
+
+	if (f->red == FE_RED_MONTGOMERY) {
+		fe_mont_mul(r, a, b, f);
+	} else {
+		fe_mul_wide(t, a, b);
+		fe_reduce(r, t, f);
+	}
+}
+
+void fe_sqr(fe_t r, const fe_t a, const fe_field f) {
+	mp_limb_t t[2 * FE_LIMBS];
+
+	fe_sqr_wide(t, a);
+	fe_reduce(r, t, f);
+}
+
+/** Compute r = a^-1 mod p, r = 0 if a = 0. The sequence of operations does not depend on a.
+ *	The Montgomery form (aR)^-1 is brought back to a^-1 R with two multiplications by R^2
+ */
+void fe_inv(fe_t r, const fe_t a, const fe_field f) {
+	int64_t x[FE_S62_LIMBS];
+
+	fe_to_s62(x, a);
+	fe_safegcd(x, f->p62, f->pinv62);
+	fe_from_s62(r, x);
+	if (f->mont) {
+		fe_mont_mul(r, r, f->r2, f);
+		fe_mont_mul(r, r, f->r2, f);
+	}
+	memset(x, 0, sizeof(x));
+}
+
+/** Compute r = a^-1 mod p on plain integers, without a fe_field: p is any odd modulus below
+ *	2^FE_BITS, e.g. the order of a curve, and a < p. The sequence of operations does not depend on a.
+ *	\return 1 if a is invertible mod p, 0 otherwise
+ */
+int fe_modinv(fe_t r, const fe_t a, const fe_t p) {
+	int64_t x[FE_S62_LIMBS], p62[FE_S62_LIMBS];
+	int ok;
+
+	fe_to_s62(p62, p);
+	fe_to_s62(x, a);
+	ok = fe_safegcd(x, p62, fe_limb_inverse(p[0]) & FE_M62);
+	fe_from_s62(r, x);
+	memset(x, 0, sizeof(x));
+	return ok;
+}
+
+/*-
+ * Exponentiations by the public exponents p - 2 and (p + 1) / 4. The primes of known form use
+ * addition chains built from the runs of ones of the exponent: x_k = a^(2^k - 1) is computed
+ * for the run lengths k, with x_(j+k) = x_j^(2^k) * x_k, then the runs are assembled by
+ * squarings. That is about bits squarings and a dozen multiplications, against one
+ * multiplication every FE_POW_WINDOW bits for the fixed window of the other moduli. The exponent
+ * is public, so the sequence of operations does not depend on a.
+ */
+
+#define FE_POW_WINDOW	4
+
+/* r = a^(2^n) */
+static void fe_sqr_n(fe_t r, const fe_t a, int n, const fe_field f) {
+	int i;
+
+	fe_copy(r, a);
+	for (i = 0; i < n; i++)
+		fe_sqr(r, r, f);
+}
+
+/* r = x^(2^n) * y */
+static void fe_sqr_n_mul(fe_t r, const fe_t x, int n, const fe_t y, const fe_field f) {
+	fe_sqr_n(r, x, n, f);
+	fe_mul(r, r, y, f);
+}
+
+/* r = a^e with a fixed window, e of at most bits bits */
+static void fe_pow(fe_t r, const fe_t a, const fe_t e, int bits, const fe_field f) {
+	fe_t table[1 << FE_POW_WINDOW], t;
+	int i, j, w;
+
+	fe_set_one(table[0], f);
+	fe_copy(table[1], a);
+	for (i = 2; i < (1 << FE_POW_WINDOW); i++)
+		fe_mul(table[i], table[i - 1], a, f);
+
+	bits = (bits + FE_POW_WINDOW - 1) / FE_POW_WINDOW * FE_POW_WINDOW;
+	fe_set_one(t, f);
+	for (i = bits - FE_POW_WINDOW; i >= 0; i -= FE_POW_WINDOW) {
+		fe_sqr_n(t, t, FE_POW_WINDOW, f);
+		w = 0;
+		for (j = FE_POW_WINDOW - 1; j >= 0; j--)
+			w = (w << 1) | ((e[(i + j) / GMP_LIMB_BITS] >> ((i + j) % GMP_LIMB_BITS)) & 1);
+		fe_mul(t, t, table[w], f);
+	}
+	fe_copy(r, t);
+}
+
+/* x_k = a^(2^k - 1) for the runs of ones of the NIST primes: 1, 2, 3, 6, 12, 15, 30, 32 */
+static void fe_chain_nist(fe_t x2, fe_t x30, fe_t x32, const fe_t a, const fe_field f) {
+	fe_t x3, x6, x12, x15;
+
+	fe_sqr_n_mul(x2, a, 1, a, f);
+	fe_sqr_n_mul(x3, x2, 1, a, f);
+	fe_sqr_n_mul(x6, x3, 3, x3, f);
+	fe_sqr_n_mul(x12, x6, 6, x6, f);
+	fe_sqr_n_mul(x15, x12, 3, x3, f);
+	fe_sqr_n_mul(x30, x15, 15, x15, f);
+	fe_sqr_n_mul(x32, x30, 2, x2, f);
+}
+
+/* x_k = a^(2^k - 1) for the runs of ones of the secp256k1 prime, as in libsecp256k1:
+ * 1, [2], 3, 6, 9, 11, [22], 44, 88, 176, 220, [223] */
+static void fe_chain_k256(fe_t x2, fe_t x22, fe_t x223, const fe_t a, const fe_field f) {
+	fe_t x3, x6, x9, x11, x44, x88, x176, x220;
+
+	fe_sqr_n_mul(x2, a, 1, a, f);
+	fe_sqr_n_mul(x3, x2, 1, a, f);
+	fe_sqr_n_mul(x6, x3, 3, x3, f);
+	fe_sqr_n_mul(x9, x6, 3, x3, f);
+	fe_sqr_n_mul(x11, x9, 2, x2, f);
+	fe_sqr_n_mul(x22, x11, 11, x11, f);
+	fe_sqr_n_mul(x44, x22, 22, x22, f);
+	fe_sqr_n_mul(x88, x44, 44, x44, f);
+	fe_sqr_n_mul(x176, x88, 88, x88, f);
+	fe_sqr_n_mul(x220, x176, 44, x44, f);
+	fe_sqr_n_mul(x223, x220, 3, x3, f);
+}
+
+/* x_k = a^(2^k - 1) for the runs of ones of the P-224 prime: 1, 2, 3, 6, 7, 12, 24, 31, 48, 96, 127 */
+static void fe_chain_p224(fe_t x96, fe_t x127, const fe_t a, const fe_field f) {
+	fe_t x2, x3, x6, x7, x12, x24, x31, x48;
+
+	fe_sqr_n_mul(x2, a, 1, a, f);
+	fe_sqr_n_mul(x3, x2, 1, a, f);
+	fe_sqr_n_mul(x6, x3, 3, x3, f);
+	fe_sqr_n_mul(x7, x6, 1, a, f);
+	fe_sqr_n_mul(x12, x6, 6, x6, f);
+	fe_sqr_n_mul(x24, x12, 12, x12, f);
+	fe_sqr_n_mul(x31, x24, 7, x7, f);
+	fe_sqr_n_mul(x48, x24, 24, x24, f);
+	fe_sqr_n_mul(x96, x48, 48, x48, f);
+	fe_sqr_n_mul(x127, x96, 31, x31, f);
+}
+
+/** Compute r = a^(p - 2) = a^-1 mod p, r = 0 if a = 0, with the addition chain of p.
+ *	Require: p prime.
+ */
+void fe_inv_fermat(fe_t r, const fe_t a, const fe_field f) {
+	fe_t x2, x22, x30, x32, x96, x127, x223, t, e, two;
+
+	switch (f->chain) {
+	case FE_CHAIN_P224:
+		/* p - 2 = [127 ones] 0 [96 ones] */
+		fe_chain_p224(x96, x127, a, f);
+		fe_sqr_n_mul(r, x127, 97, x96, f);
+		break;
+	case FE_CHAIN_P256:
+		/* p - 2 = [32 ones] [31 zeros] 1 [96 zeros] [94 ones] 0 1 */
+		fe_chain_nist(x2, x30, x32, a, f);
+		fe_sqr_n_mul(t, x32, 32, a, f);
+		fe_sqr_n_mul(t, t, 128, x32, f);
+		fe_sqr_n_mul(t, t, 32, x32, f);
+		fe_sqr_n_mul(t, t, 30, x30, f);
+		fe_sqr_n_mul(r, t, 2, a, f);
+		break;
+	case FE_CHAIN_K256:
+		/* p - 2 = [223 ones] 0 [22 ones] 0000 1 0 11 0 1 */
+		fe_chain_k256(x2, x22, x223, a, f);
+		fe_sqr_n_mul(t, x223, 23, x22, f);
+		fe_sqr_n_mul(t, t, 5, a, f);
+		fe_sqr_n_mul(t, t, 3, x2, f);
+		fe_sqr_n_mul(r, t, 2, a, f);
+		break;
+	default:
+		fe_set_zero(two);
+		two[0] = 2;
+		fe_sub_n(e, f->p, two);
+		fe_pow(r, a, e, f->bits, f);
+		break;
+	}
+}
+
+/** Compute a square root r = a^((p + 1) / 4) mod p, with the addition chain of p.
+ *	Require: p prime and p = 3 mod 4.
+ *	\return 1 if a is a square, i.e. r^2 = a, 0 otherwise
+ */
+int fe_sqrt(fe_t r, const fe_t a, const fe_field f) {
+	fe_t x2, x22, x30, x32, x223, t, e, one;
+	int i;
+
+	assert((f->p[0] & 3) == 3);
+
+	switch (f->chain) {
+	case FE_CHAIN_P256:
+		/* (p + 1) / 4 = [32 ones] [31 zeros] 1 [95 zeros] 1 [94 zeros] */
+		fe_chain_nist(x2, x30, x32, a, f);
+		fe_sqr_n_mul(t, x32, 32, a, f);
+		fe_sqr_n_mul(t, t, 96, a, f);
+		fe_sqr_n(t, t, 94, f);
+		break;
+	case FE_CHAIN_K256:
+		/* (p + 1) / 4 = [223 ones] 0 [22 ones] 0000 11 00 */
+		fe_chain_k256(x2, x22, x223, a, f);
+		fe_sqr_n_mul(t, x223, 23, x22, f);
+		fe_sqr_n_mul(t, t, 6, x2, f);
+		fe_sqr_n(t, t, 2, f);
+		break;
+	default:
+		/* e = (p + 1) / 4 = (p >> 2) + 1, since p = 3 mod 4 */
+		for (i = 0; i < FE_LIMBS - 1; i++)
+			e[i] = (f->p[i] >> 2) | (f->p[i + 1] << (GMP_LIMB_BITS - 2));
+		e[FE_LIMBS - 1] = f->p[FE_LIMBS - 1] >> 2;
+		fe_set_zero(one);
+		one[0] = 1;
+		fe_add_n(e, e, one);
+		fe_pow(t, a, e, f->bits, f);
+		break;
+	}
+
+	fe_sqr(x2, t, f);
+	fe_copy(r, t);
+	return fe_equal(x2, a);
+}
+
+/** Compute r[i] = a[i]^-1 mod p, i = 0 .. n - 1, with one inversion and 3(n - 1) multiplications
+ *	(Montgomery's trick). The zero elements give r[i] = 0 and are selected with conditional moves,
+ *	so the sequence of operations depends only on n. r and a may be the same array.
+ */
+void fe_batch_inv(fe_t *r, const fe_t *a, int n, const fe_field f) {
+	fe_t *acc, inv, t, z, one;
+	int i, zero;
+
+	if (n <= 0)
+		return;
+	acc = malloc(n * sizeof(fe_t));
+	assert(acc != NULL);
+
+	/* acc[i] = a_0 * ... * a_i, with a = 1 for the zero elements */
+	fe_set_one(one, f);
+	for (i = 0; i < n; i++) {
+		fe_copy(z, a[i]);
+		fe_cmov(z, one, fe_is_zero(z));
+		if (i == 0)
+			fe_copy(acc[0], z);
+		else
+			fe_mul(acc[i], acc[i - 1], z, f);
+	}
+
+	fe_inv(inv, acc[n - 1], f);
+	for (i = n - 1; i > 0; i--) {
+		fe_copy(z, a[i]);
+		zero = fe_is_zero(z);
+		fe_cmov(z, one, zero);
+		fe_mul(t, inv, acc[i - 1], f);
+		fe_mul(inv, inv, z, f);
+		fe_set_zero(z);
+		fe_cmov(t, z, zero);
+		fe_copy(r[i], t);
+	}
+	zero = fe_is_zero(a[0]);
+	fe_set_zero(z);
+	fe_cmov(inv, z, zero);
+	fe_copy(r[0], inv);
+
+	free(acc);
+}
@@ -0,0 +1,62 @@
+/*
+ * fe_ops.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: tslld
+ */
+
+#ifndef FE_OPS_H_
+#define FE_OPS_H_
+
+/* Create/Release the arithmetic context of an odd modulus p of at most FE_BITS bits.
+ * red selects a special reduction, with FE_RED_MONTGOMERY as fallback.
+ * Returns NULL if p is not supported */
+fe_field fe_field_init(const mpz_t p, fe_reduction red);
+void fe_field_free(fe_field f);
+
+/* Conversion between big integers and fixed-width elements */
+void fe_from_mpz(fe_t r, const mpz_t a, const fe_field f);
+void fe_to_mpz(mpz_t r, const fe_t a, const fe_field f);
+
+/* Conversion between plain integers a < p and the representation of the field, r may be a */
+void fe_set_limbs(fe_t r, const fe_t a, const fe_field f);
+void fe_get_limbs(fe_t r, const fe_t a, const fe_field f);
+
+/* Compute r = round(a * b / 2^shift) for plain integers, FE_BITS <= shift < 2 * FE_BITS */
+void fe_mul_shift(fe_t r, const fe_t a, const fe_t b, int shift);
+
+/* Assignments */
+void fe_copy(fe_t r, const fe_t a);
+void fe_set_zero(fe_t r);
+void fe_set_one(fe_t r, const fe_field f);
+
+/* Comparisons and selection in data-independent time, flags are 0 or 1 */
+int fe_is_zero(const fe_t a);
+int fe_equal(const fe_t a, const fe_t b);
+void fe_cmov(fe_t r, const fe_t a, int flag);
+
+/* Modular operations in data-independent time */
+void fe_add(fe_t r, const fe_t a, const fe_t b, const fe_field f);
+void fe_sub(fe_t r, const fe_t a, const fe_t b, const fe_field f);
+void fe_neg(fe_t r, const fe_t a, const fe_field f);
+void fe_mul(fe_t r, const fe_t a, const fe_t b, const fe_field f);
+void fe_sqr(fe_t r, const fe_t a, const fe_field f);
+
+/* Compute r = a^-1 mod p, r = 0 if a = 0, in data-independent time (safegcd) */
+void fe_inv(fe_t r, const fe_t a, const fe_field f);
+
+/* Compute r = a^-1 mod p for plain integers a < p, p odd, without a fe_field.
+ * Returns 1 if a is invertible */
+int fe_modinv(fe_t r, const fe_t a, const fe_t p);
+
+/* Compute r = a^(p - 2) = a^-1 mod p for prime p, with the addition chain of p */
+void fe_inv_fermat(fe_t r, const fe_t a, const fe_field f);
+
+/* Compute a square root r = a^((p + 1) / 4) for prime p = 3 mod 4, with the addition chain of p.
+ * Returns 1 if a is a square */
+int fe_sqrt(fe_t r, const fe_t a, const fe_field f);
+
+/* Compute r[i] = a[i]^-1 mod p for n elements with a single inversion, r[i] = 0 if a[i] = 0 */
+void fe_batch_inv(fe_t *r, const fe_t *a, int n, const fe_field f);
+
+#endif /* FE_OPS_H_ */
@@ -7,7 +7,9 @@
 
 #include<stdio.h>
 #include<gmp.h>
+#include"ecdsa.h"
 #include"field_ops.h"
+#include"fe_ops.h"
 
 // Values represented in hex string
 static char* field[] = {
@@ -126,6 +128,279 @@ static void GF_exp_test(mpz_t R, mpz_t a, mpz_t b, mpz_t field) {
 	mpz_clear(Rop); mpz_clear(Rop2);
 }
 
+/* Check the fixed-width arithmetic against the same vectors */
+static void GF_fe_test(mpz_t Ra, mpz_t Rs, mpz_t Rm, mpz_t Ri, mpz_t a, mpz_t b, mpz_t field) {
+	fprintf(stdout, "Fixed-width arithmetic checking ...\n");
+	mpz_t Rop; mpz_init(Rop);
+	fe_t fa, fb, fr;
+	int ok = 1;
+	fe_field f = fe_field_init(field, FE_RED_MONTGOMERY);
+
+	fe_from_mpz(fa, a, f);
+	fe_from_mpz(fb, b, f);
+
+	fe_add(fr, fa, fb, f); fe_to_mpz(Rop, fr, f);
+	ok &= (mpz_cmp(Rop, Ra) == 0);
+	fe_sub(fr, fa, fb, f); fe_to_mpz(Rop, fr, f);
+	ok &= (mpz_cmp(Rop, Rs) == 0);
+	fe_mul(fr, fa, fb, f); fe_to_mpz(Rop, fr, f);
+	ok &= (mpz_cmp(Rop, Rm) == 0);
+	fe_inv(fr, fa, f); fe_to_mpz(Rop, fr, f);
+	ok &= (mpz_cmp(Rop, Ri) == 0);
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+	fe_field_free(f);
+	mpz_clear(Rop);
+}
+
+/* Moduli of the built-in curves, used to cross-check the fixed-width arithmetic with GMP */
+static char* fe_moduli[] = {
+		"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF000000000000000000000001",			// secp224r1 p
+		"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFE56D",			// secp224k1 p
+		"FFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF",	// secp256r1 p
+		"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F",	// secp256k1 p
+		"FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551"	// secp256r1 order
+};
+
+/* Special reduction of each modulus above */
+static fe_reduction fe_reductions[] = {
+		FE_RED_NIST_P224,
+		FE_RED_PSEUDO_MERSENNE,
+		FE_RED_NIST_P256,
+		FE_RED_PSEUDO_MERSENNE,
+		FE_RED_MONTGOMERY
+};
+
+static void GF_fe_random_test(mpz_t field, fe_field f) {
+	fprintf(stdout, "Fixed-width arithmetic on random operands checking (reduction %d) ...\n", f->red);
+	mpz_t a, b, R, Rop; mpz_init(a); mpz_init(b); mpz_init(R); mpz_init(Rop);
+	gmp_randstate_t state;
+	fe_t fa, fb, fr;
+	int i, ok = 1;
+
+	gmp_randinit_default(state);
+	for (i = 0; i < 1000 && ok; i++) {
+		mpz_urandomm(a, state, field);
+		mpz_urandomm(b, state, field);
+		if (i == 0)
+			mpz_sub_ui(a, field, 1);		// largest element
+		if (i == 1) {
+			mpz_sub_ui(a, field, 1);		// largest product
+			mpz_sub_ui(b, field, 1);
+		}
+		fe_from_mpz(fa, a, f);
+		fe_from_mpz(fb, b, f);
+
+		fe_add(fr, fa, fb, f); fe_to_mpz(Rop, fr, f);
+		mpz_add(R, a, b); mpz_mod(R, R, field);
+		ok &= (mpz_cmp(Rop, R) == 0);
+
+		fe_sub(fr, fa, fb, f); fe_to_mpz(Rop, fr, f);
+		mpz_sub(R, a, b); mpz_mod(R, R, field);
+		ok &= (mpz_cmp(Rop, R) == 0);
+
+		fe_mul(fr, fa, fb, f); fe_to_mpz(Rop, fr, f);
+		mpz_mul(R, a, b); mpz_mod(R, R, field);
+		ok &= (mpz_cmp(Rop, R) == 0);
+
+		fe_sqr(fr, fa, f); fe_to_mpz(Rop, fr, f);
+		mpz_mul(R, a, a); mpz_mod(R, R, field);
+		ok &= (mpz_cmp(Rop, R) == 0);
+
+		if (i % 50 == 0 && mpz_sgn(a)) {
+			fe_inv(fr, fa, f); fe_to_mpz(Rop, fr, f);
+			mpz_invert(R, a, field);
+			ok &= (mpz_cmp(Rop, R) == 0);
+		}
+	}
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+	gmp_randclear(state);
+	mpz_clear(a); mpz_clear(b); mpz_clear(R); mpz_clear(Rop);
+}
+
+/* Constant-time inversions against GMP: safegcd on the limbs and Fermat, on random elements,
+ * the extreme ones and 0 */
+static void GF_sec_inv_test(mpz_t field) {
+	fprintf(stdout, "Constant-time inversion checking ...\n");
+	mpz_t a, R, Rop; mpz_init(a); mpz_init(R); mpz_init(Rop);
+	gmp_randstate_t state;
+	int i, ok = 1;
+
+	gmp_randinit_default(state);
+	for (i = 0; i < 200 && ok; i++) {
+		mpz_urandomm(a, state, field);
+		if (i == 0)
+			mpz_sub_ui(a, field, 1);
+		else if (i == 1)
+			mpz_set_ui(a, 1);
+		else if (i == 2)
+			mpz_set_ui(a, 0);
+
+		if (mpz_sgn(a) == 0) {
+			ok &= (mod_sec_invert(Rop, a, field) == 0) && mpz_sgn(Rop) == 0;
+			continue;
+		}
+		mpz_invert(R, a, field);
+		ok &= (mod_sec_invert(Rop, a, field) == 1) && mpz_cmp(Rop, R) == 0;
+		if (i % 20 == 0) {
+			mod_Fermat_invert(Rop, a, field);
+			ok &= (mpz_cmp(Rop, R) == 0);
+		}
+	}
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+	gmp_randclear(state);
+	mpz_clear(a); mpz_clear(R); mpz_clear(Rop);
+}
+
+/* Exponentiations by p - 2 and (p + 1) / 4 against GMP, with the addition chain of the field and
+ * with the generic fixed window */
+static void GF_chain_test(mpz_t field, fe_field f) {
+	fprintf(stdout, "Addition chains checking (chain %d) ...\n", f->chain);
+	mpz_t a, R, Rop; mpz_init(a); mpz_init(R); mpz_init(Rop);
+	gmp_randstate_t state;
+	fe_chain chain = f->chain;
+	fe_t fa, fr;
+	int i, pass, ok = 1;
+
+	gmp_randinit_default(state);
+	for (pass = 0; pass < 2; pass++) {
+		if (pass == 1)
+			f->chain = FE_CHAIN_GENERIC;
+		for (i = 0; i < 100 && ok; i++) {
+			mpz_urandomm(a, state, field);
+			if (i == 0)
+				mpz_set_ui(a, 0);
+			fe_from_mpz(fa, a, f);
+
+			fe_inv_fermat(fr, fa, f); fe_to_mpz(Rop, fr, f);
+			if (mpz_sgn(a))
+				mpz_invert(R, a, field);
+			else
+				mpz_set_ui(R, 0);
+			ok &= (mpz_cmp(Rop, R) == 0);
+
+			if (mpz_fdiv_ui(field, 4) == 3) {
+				/* a^2 has the square roots +-a, -a^2 is not a square */
+				mpz_mul(R, a, a); mpz_mod(R, R, field);
+				fe_sqr(fa, fa, f);
+				ok &= fe_sqrt(fr, fa, f);
+				fe_to_mpz(Rop, fr, f);
+				mpz_mul(Rop, Rop, Rop); mpz_mod(Rop, Rop, field);
+				ok &= (mpz_cmp(Rop, R) == 0);
+				fe_neg(fa, fa, f);
+				ok &= (fe_sqrt(fr, fa, f) == !mpz_sgn(a));
+			}
+		}
+	}
+	f->chain = chain;
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+	gmp_randclear(state);
+	mpz_clear(a); mpz_clear(R); mpz_clear(Rop);
+}
+
+/* Square roots of random squares, and non-squares rejected */
+static void GF_sqrt_test(mpz_t field) {
+	fprintf(stdout, "Modular square root checking ...\n");
+	mpz_t a, R, Rop; mpz_init(a); mpz_init(R); mpz_init(Rop);
+	gmp_randstate_t state;
+	int i, ok = 1;
+
+	gmp_randinit_default(state);
+	for (i = 0; i < 50 && ok; i++) {
+		mpz_urandomm(a, state, field);
+		mpz_mul(R, a, a); mpz_mod(R, R, field);
+		ok &= mod_sqrt(Rop, R, field);
+		mpz_mul(Rop, Rop, Rop); mpz_mod(Rop, Rop, field);
+		ok &= (mpz_cmp(Rop, R) == 0);
+
+		mpz_urandomm(a, state, field);
+		ok &= (mod_sqrt(Rop, a, field) == (mpz_legendre(a, field) >= 0));
+	}
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+	gmp_randclear(state);
+	mpz_clear(a); mpz_clear(R); mpz_clear(Rop);
+}
+
+static void GF_batch_inv_test(mpz_t field, fe_field f) {
+	fprintf(stdout, "Batch inversion checking ...\n");
+	const int n = 17;
+	mpz_t A[n], R[n], S[n], Rop; mpz_init(Rop);
+	gmp_randstate_t state;
+	fe_t fa[n];
+	int i, ok = 1;
+
+	gmp_randinit_default(state);
+	for (i = 0; i < n; i++) {
+		mpz_init(A[i]); mpz_init(R[i]); mpz_init(S[i]);
+		mpz_urandomm(A[i], state, field);
+	}
+	mpz_set_ui(A[0], 1);
+	mpz_set_ui(A[5], 0);				// no inverse, gives 0
+	mpz_set(A[n - 1], field);			// 0 mod field
+	mpz_sub_ui(A[n - 2], field, 1);
+
+	ok &= (mod_batch_invert(R, A, n, field) == 0);
+	ok &= (mod_sec_batch_invert(S, A, n, field, f) == 0);
+	for (i = 0; i < n; i++)
+		fe_from_mpz(fa[i], A[i], f);
+	fe_batch_inv(fa, (const fe_t *) fa, n, f);
+
+	for (i = 0; i < n; i++) {
+		if (!mpz_invert(Rop, A[i], field))
+			mpz_set_ui(Rop, 0);
+		ok &= (mpz_cmp(R[i], Rop) == 0) && (mpz_cmp(S[i], Rop) == 0);
+		fe_to_mpz(S[i], fa[i], f);
+		ok &= (mpz_cmp(S[i], Rop) == 0);
+	}
+
+	/* without the fixed-width field, the mpz version */
+	ok &= (mod_sec_batch_invert(R, A, n, field, NULL) == 0);
+	for (i = 0; i < n; i++) {
+		if (!mpz_invert(Rop, A[i], field))
+			mpz_set_ui(Rop, 0);
+		ok &= (mpz_cmp(R[i], Rop) == 0);
+	}
+
+	/* in place, every element invertible */
+	mpz_set_ui(A[5], 5); mpz_set_ui(A[n - 1], 7);
+	for (i = 0; i < n; i++)
+		mpz_set(S[i], A[i]);
+	ok &= (mod_batch_invert(S, S, n, field) == 1);
+	for (i = 0; i < n; i++) {
+		mpz_invert(Rop, A[i], field);
+		ok &= (mpz_cmp(S[i], Rop) == 0);
+	}
+	ok &= (mod_sec_batch_invert(A, A, 1, field, f) == 1) && (mpz_cmp_ui(A[0], 1) == 0);
+
+	if (ok)
+		fprintf(stdout, "passed ! \n");
+	else
+		fprintf(stdout, "failed ! \n");
+	gmp_randclear(state);
+	for (i = 0; i < n; i++) {
+		mpz_clear(A[i]); mpz_clear(R[i]); mpz_clear(S[i]);
+	}
+	mpz_clear(Rop);
+}
 
 int main(int agrc, char* argv[]) {
 	int i;
@@ -150,6 +425,26 @@ int main(int agrc, char* argv[]) {
 		GF_mul_test(Rm, a, b, mod);
 		GF_inv_test(Ri, a, mod);
 		GF_exp_test(Re, a, b, mod);
+		GF_fe_test(Ra, Rs, Rm, Ri, a, b, mod);
+	}
+
+	for (i = 0; i < sizeof(fe_moduli) / sizeof(char*); i++) {
+		fprintf(stdout, "\nChecking the prime finite field GF(p), where p = 0x%s\n", fe_moduli[i]);
+		mpz_set_str(mod, fe_moduli[i], 16);
+		fe_field f = fe_field_init(mod, FE_RED_MONTGOMERY);
+		GF_fe_random_test(mod, f);
+		GF_batch_inv_test(mod, f);
+		GF_sec_inv_test(mod);
+		GF_sqrt_test(mod);
+		fe_field_free(f);
+
+		f = fe_field_init(mod, fe_reductions[i]);
+		if (f->red == fe_reductions[i]) {
+			GF_fe_random_test(mod, f);
+			GF_chain_test(mod, f);
+		} else
+			fprintf(stdout, "Special reduction selection -- failed ! \n");
+		fe_field_free(f);
 	}
 
 	mpz_clear(a); mpz_clear(b); mpz_clear(Ra); mpz_clear(Rs); mpz_clear(Rm); mpz_clear(Ri); mpz_clear(mod);
@@ -7,6 +7,7 @@
 
 #include "ecdsa.h"
 #include "field_ops.h"
+#include "fe_ops.h"
 
 /** Verify whether x = 0 mod N
  *	\param
@@ -36,7 +37,7 @@ void mod_neg(mpz_t R, mpz_t A, mpz_t N){
  */
 void mod_add(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
 	mpz_add(R, A, B);
-	if (mpz_cmp(R, N) > 0){
+	if (mpz_cmp(R, N) >= 0){
 		mpz_sub(R, R, N);
 	}
 	//mpz_mod(R, R, N); //mpz_set(R, A);
@@ -46,8 +47,11 @@ void mod_add(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
  *
  */
 void mod_sec_add(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
-	mpz_t T[2];
-	mpz_init(T[0]); mpz_init(T[1]);
+	ec_ctx ctx = ec_ctx_field_thread();
+	mpz_ptr T[2];
+
+	ec_ctx_start(ctx);
+	T[0] = ec_ctx_get(ctx); T[1] = ec_ctx_get(ctx);
 
 	mpz_add(T[0], A, B);
 	mpz_sub(T[1], T[0], N);
@@ -55,7 +59,7 @@ void mod_sec_add(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
 	int i = mpz_sgn(T[1]);
 	i = (i & 0xF) % 0xF;
 	mpz_set(R, T[i]);
-	mpz_clear(T[0]); mpz_clear(T[1]);
+	ec_ctx_end(ctx);
 }
 
 /*
@@ -67,7 +71,7 @@ void mod_sec_add(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
 void mod_addadd(mpz_t R, mpz_t A, mpz_t B, mpz_t C, mpz_t N) {
 	mpz_add(R, A, B);
 	mpz_add(R, R, C);
-	while (mpz_cmp(R, N) > 0){
+	while (mpz_cmp(R, N) >= 0){
 		mpz_sub(R, R, N);
 	}
 }
@@ -89,8 +93,11 @@ void mod_sub(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
 }
 
 void mod_sec_sub(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
-	mpz_t T[2];
-	mpz_init(T[0]); mpz_init(T[1]);
+	ec_ctx ctx = ec_ctx_field_thread();
+	mpz_ptr T[2];
+
+	ec_ctx_start(ctx);
+	T[0] = ec_ctx_get(ctx); T[1] = ec_ctx_get(ctx);
 
 	mpz_sub(T[1], A, B);
 	mpz_add(T[0], T[1], N);
@@ -99,7 +106,7 @@ void mod_sec_sub(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
 	mask = (mask & 0xF) % 0xF;
 
 	mpz_set(R, T[mask]);
-	mpz_clear(T[0]); mpz_clear(T[1]);
+	ec_ctx_end(ctx);
 }
 
 /** Compute a modular subtraction. Require: all element were initialized.
@@ -108,7 +115,11 @@ void mod_sec_sub(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
  * 	\return R = A - B - C mod N
  */
 void mod_subsub(mpz_t R, mpz_t A, mpz_t B, mpz_t C, mpz_t N) {
-	mpz_t tmp; mpz_init(tmp);
+	ec_ctx ctx = ec_ctx_field_thread();
+	mpz_ptr tmp;
+
+	ec_ctx_start(ctx);
+	tmp = ec_ctx_get(ctx);
 
 	if (mpz_cmp(A, B) >= 0) {
 		mpz_sub(tmp, A, B);
@@ -128,7 +139,7 @@ void mod_subsub(mpz_t R, mpz_t A, mpz_t B, mpz_t C, mpz_t N) {
 		mod_add(tmp, B, C, N);
 		mod_sub(R, A, tmp, N);
 	}
-	mpz_clear(tmp);
+	ec_ctx_end(ctx);
 }
 
 /*
@@ -148,23 +159,16 @@ void mod_mul(mpz_t R, mpz_t A, mpz_t B, mpz_t N) {
  *
  */
 void mod_4mul(mpz_t R, mpz_t A, mpz_t N) {
-	mpz_t tmp; mpz_init(tmp);
-	mpz_add(R, A, A);
-	mpz_add(tmp, R, R);
-	mpz_mod(R, tmp, N);
-	mpz_clear(tmp);
+	mpz_mul_2exp(R, A, 2);
+	mpz_mod(R, R, N);
 }
 
 /**	Compute 8 * A
  *
  */
 void mod_8mul(mpz_t R, mpz_t A, mpz_t N) {
-	mpz_t tmp; mpz_init(tmp);
-	mpz_add(tmp, A, A);
-	mpz_add(R, tmp, tmp);
-	mpz_add(tmp, R, R);
-	mpz_mod(R, tmp, N);
-	mpz_clear(tmp);
+	mpz_mul_2exp(R, A, 3);
+	mpz_mod(R, R, N);
 }
 
 
@@ -205,14 +209,19 @@ void mod_mul_ui(mpz_t R, mpz_t A, unsigned long int b, mpz_t N) {
 
 /* Compute R = A*B - C mod N */
 void mod_mulsub(mpz_t R, mpz_t A, mpz_t B, mpz_t C, mpz_t N) {
-	mpz_t tmp; mpz_init(tmp);
+	ec_ctx ctx = ec_ctx_field_thread();
+	mpz_ptr tmp;
+
+	ec_ctx_start(ctx);
+	tmp = ec_ctx_get(ctx);
 	mpz_mul(tmp, A, B);
-	if (mpz_cmp(tmp, N) <= 0)
+	if (mpz_cmp(tmp, N) < 0)
 		mod_sub(R, tmp, C, N);
 	else {
 		mpz_sub(R, tmp, C);
 		mpz_mod(R, R, N);
 	}
+	ec_ctx_end(ctx);
 }
 
 /*
@@ -264,100 +273,266 @@ int mod_invert(mpz_t R, mpz_t A, mpz_t N) {
 }*/
 
 /** Perform a modular inverse R = A^{-1} mod P, in data-independent time using the little Fermat theorem
+ *	Require P prime
  *	\param R 	return value
  *	\param A 	big number to be inverted
  *	\pram  P	modulus
  */
 void mod_Fermat_invert(mpz_t R, mpz_t A, mpz_t P) {
-	mpz_t E;
-	mpz_init(E);
-	mpz_sub_ui(E, E, 2);
+	ec_ctx ctx = ec_ctx_field_thread();
+	mpz_ptr E;
+
+	ec_ctx_start(ctx);
+	E = ec_ctx_get(ctx);
+	mpz_sub_ui(E, P, 2);
 	modexp_atomic(R, A, E, P);
-	mpz_clear(E);
+	ec_ctx_end(ctx);
 }
 
-/** Perform a modular inverse R = A^{-1} mod P, using the extended Euclidean algorithm
- *	Require order must be prime
- *	\param R	return value
- *	\param A
- *	\param
- *
- *	\return
+/** Perform a modular inverse R = A^{-1} mod P, in data-independent time.
+ *	Moduli of up to FE_BITS bits, i.e. the fields and orders of all built-in curves, use the
+ *	safegcd inversion on fixed-width limbs (fe_modinv). Larger moduli fall back to
+ *	mod_Fermat_invert and then require P prime.
+ *	\param R	return value, 0 if A = 0 mod P
+ *	\param A	big number to be inverted
+ *	\param P	odd modulus
+ *	\return		1 if A is invertible, 0 otherwise
  */
 int mod_sec_invert(mpz_t R, mpz_t A, mpz_t P) {
-	//Initialize variables
-	mpz_t a;mpz_init(a);
-	mpz_t b;mpz_init(b);
-	mpz_t q;mpz_init(q);
-	mpz_t r;mpz_init(r);
-	mpz_t x;mpz_init(x);
-	mpz_t lastx;mpz_init(lastx);
-	mpz_t y;mpz_init(y);
-	mpz_t lasty;mpz_init(lasty);
-	mpz_t t1;mpz_init(t1);
-	mpz_t t2;mpz_init(t2);
-
-	//Copy b, since we don't want to alter P or A
-	mpz_set(b, P);
-	mpz_set(a, A);
-
-	//Set variables
-	mpz_set_ui(x, 0);
-	mpz_set_ui(y, 1);
-	mpz_set_ui(lastx, 1);
-	mpz_set_ui(lasty, 0);
-
-	//while b != 0
-	while(mpz_sgn(b) != 0) {
-		//r = a mod b;
-		mpz_mod(r, a, b);
-
-		//q = (a - r)/b
-		mpz_sub(t1, a, r);
-		mpz_divexact(q,t1,b);
-
-		mpz_set(a, b);
-
-		//temp := x
-		//x := lastx-quotient*x
-		//lastx := temp
-		mpz_set(t1, x);
-		mpz_mul(t2, q, x);
-		mpz_sub(x, lastx, t2);
-		mpz_mod(lastx, t1, P);//We must keep it mod p, so why not just do it where instead of using set
-
-		//temp := y
-		//y := lasty-quotient*y
-		//lasty := temp
-		mpz_set(t1, y);
-		mpz_mul(t2, q, y);
-		mpz_sub(y, lasty, t2);
-		mpz_mod(lasty, t1, P);//We must keep it mod p, so why not just do it where instead of using set
-
-		//Set b = r
-		mpz_set(b, r);
+	ec_ctx ctx;
+	mpz_ptr a;
+	fe_t fa, fp, fr;
+	mpz_t z;
+	int i, ok;
+
+	if (UNLIKELY (mpz_tstbit(P, 0) == 0)) {
+		printf("Modulus N must be odd. DIVIDE BY ZERO !\n");
+		return 0;
 	}
-	/*d = a, greatest common divisitor
-	 *lastx = x
-	 *lasty = y
-	 *in d = a*x+b*y
-	 *Thus x is the multiplicative inverse of a mod b
-	 *if d = 1, since otherwise there's no mulitplicative inverse.
-	 *But when b is a prime, a must be coprime thus d=1
-	 */
-
-	//Set the result
-	mpz_set(R, lastx);
-
-	//Clear variables
-	mpz_clear(a); mpz_clear(b); mpz_clear(r); mpz_clear(q); mpz_clear(x);
-	mpz_clear(y); mpz_clear(lastx); mpz_clear(lasty); mpz_clear(t1); mpz_clear(t2);
-	return 1;
 
+	ctx = ec_ctx_field_thread();
+	ec_ctx_start(ctx);
+	a = ec_ctx_get(ctx);
+	mpz_mod(a, A, P);
+
+	if (LIKELY(mpz_size(P) <= FE_LIMBS)) {
+		for (i = 0; i < FE_LIMBS; i++) {
+			fa[i] = mpz_getlimbn(a, i);
+			fp[i] = mpz_getlimbn(P, i);
+		}
+		ok = fe_modinv(fr, fa, fp);
+		mpz_set(R, mpz_roinit_n(z, fr, FE_LIMBS));
+		memset(fa, 0, sizeof(fe_t));
+		memset(fr, 0, sizeof(fe_t));
+	} else {
+		ok = (mpz_sgn(a) != 0);
+		mod_Fermat_invert(R, a, P);
+	}
+
+	ec_ctx_end(ctx);
+	return ok;
 }
 
-void mod_sqrt(mpz_t R, mpz_t A, mpz_t N) {
+/* Invert the elements of A with a single inversion (Montgomery's trick). The multiplication
+ * and the inversion are given by the caller, so that the constant-time and the variable-time
+ * variants share the same sequence of operations.
+ */
+static int mod_batch_invert_with(mpz_t R[], mpz_t A[], int n, mpz_t N,
+		void (*mul)(mpz_t, mpz_t, mpz_t, mpz_t), int (*inv)(mpz_t, mpz_t, mpz_t)) {
+	mpz_t *acc, a, t, c;
+	int i, zero, ok;
+
+	if (n <= 0)
+		return 1;
+	acc = malloc(n * sizeof(mpz_t));
+	assert(acc != NULL);
+	mpz_init(a); mpz_init(t); mpz_init(c);
+
+	/* acc[i] = A_0 * ... * A_i mod N, with A = 1 for the elements equal to 0 mod N */
+	zero = 0;
+	for (i = 0; i < n; i++) {
+		mpz_init(acc[i]);
+		mpz_mod(a, A[i], N);
+		zero |= !mpz_sgn(a);
+		mpz_set_ui(c, !mpz_sgn(a));
+		mpz_add(a, a, c);
+		if (i == 0)
+			mpz_set(acc[0], a);
+		else
+			mul(acc[i], acc[i - 1], a, N);
+	}
+
+	/* one inversion, then R_i = (A_0 * ... * A_i)^-1 * (A_0 * ... * A_{i-1}) */
+	ok = inv(t, acc[n - 1], N);
+	for (i = n - 1; ok && i >= 0; i--) {
+		mpz_mod(a, A[i], N);
+		mpz_set_ui(c, !mpz_sgn(a));
+		if (i > 0) {
+			mpz_add(a, a, c);
+			mul(acc[i], t, acc[i - 1], N);
+			mul(t, t, a, N);
+		} else
+			mpz_set(acc[0], t);
+		/* R_i = 0 for the elements equal to 0 mod N */
+		mpz_sub_ui(c, c, 1);
+		mpz_and(R[i], acc[i], c);
+	}
+
+	for (i = 0; i < n; i++)
+		mpz_clear(acc[i]);
+	free(acc);
+	mpz_clear(a); mpz_clear(t); mpz_clear(c);
+	return ok && !zero;
+}
 
+/** Perform the modular inverses R[i] = A[i]^{-1} mod N, i = 0 .. n - 1, with one inversion and
+ *	3(n - 1) multiplications. Variable time.
+ *	R and A may be the same array. An element equal to 0 mod N gives R[i] = 0.
+ *	Require: N odd, all elements were initialized
+ *	\param R	array of n results
+ *	\param A	array of n big numbers to be inverted
+ *	\param n	number of elements
+ *	\param N	modulus
+ *	\return		1 if every element was inverted, 0 otherwise
+ */
+int mod_batch_invert(mpz_t R[], mpz_t A[], int n, mpz_t N) {
+	int i, ok;
+
+	ok = mod_batch_invert_with(R, A, n, N, mod_mul, mod_invert);
+	if (ok || n <= 0 || mpz_probab_prime_p(N, 25))
+		return ok;
+
+	/* composite N: the product may share a factor with N, fall back to one inversion each */
+	ok = 1;
+	for (i = 0; i < n; i++)
+		if (!mod_invert(R[i], A[i], N)) {
+			mpz_set_ui(R[i], 0);
+			ok = 0;
+		}
+	return ok;
+}
+
+/** Perform the modular inverses R[i] = A[i]^{-1} mod P, i = 0 .. n - 1, with one inversion and
+ *	3(n - 1) multiplications. With the fixed-width field of P, such as ec->fp or ec->fn of a
+ *	group, they go through fe_batch_inv, whose sequence of operations does not depend on the
+ *	values of A. Without it, the mpz version of the same algorithm with mod_sec_mul and
+ *	mod_sec_invert does not hide the sizes of the intermediate values.
+ *	R and A may be the same array. An element equal to 0 mod P gives R[i] = 0.
+ *	Require: P prime, all elements were initialized, f is NULL or a field of modulus P
+ *	\param R	array of n results
+ *	\param A	array of n big numbers to be inverted
+ *	\param n	number of elements
+ *	\param P	modulus
+ *	\param f	fixed-width arithmetic modulo P, or NULL
+ *	\return		1 if every element was inverted, 0 otherwise
+ */
+int mod_sec_batch_invert(mpz_t R[], mpz_t A[], int n, mpz_t P, const fe_field f) {
+	fe_t *fa;
+	int i, ok;
+
+	if (n <= 0)
+		return 1;
+	if (f == NULL)
+		return mod_batch_invert_with(R, A, n, P, mod_sec_mul, mod_sec_invert);
+
+	fa = malloc(n * sizeof(fe_t));
+	assert(fa != NULL);
+
+	ok = 1;
+	for (i = 0; i < n; i++) {
+		fe_from_mpz(fa[i], A[i], f);
+		ok &= !fe_is_zero(fa[i]);
+	}
+	fe_batch_inv(fa, (const fe_t *) fa, n, f);
+	for (i = 0; i < n; i++)
+		fe_to_mpz(R[i], fa[i], f);
+
+	memset(fa, 0, n * sizeof(fe_t));
+	free(fa);
+	return ok;
+}
+
+/** Compute a modular square root R = sqrt(A) mod N, N an odd prime. Variable time, for public
+ *	values such as the coordinates of a compressed public key.
+ *	N = 3 mod 4 uses R = A^((N + 1) / 4), the other primes (e.g. P-224) the Tonelli-Shanks algorithm.
+ *	\param R	return value, one of the two square roots, left unchanged if A is not a square
+ *	\param A	big number
+ *	\param N	odd prime modulus
+ *	\return		1 if A is a square mod N, 0 otherwise
+ */
+int mod_sqrt(mpz_t R, mpz_t A, mpz_t N) {
+	ec_ctx ctx;
+	mpz_ptr a, q, x, c, t, b;
+	unsigned long m, i, j, s;
+
+	if (UNLIKELY (mpz_tstbit(N, 0) == 0)) {
+		printf("Modulus N must be odd. DIVIDE BY ZERO !\n");
+		return 0;
+	}
+
+	ctx = ec_ctx_field_thread();
+	ec_ctx_start(ctx);
+	a = ec_ctx_get(ctx);
+	mpz_mod(a, A, N);
+
+	if (mpz_sgn(a) == 0 || mpz_legendre(a, N) != 1) {
+		if (mpz_sgn(a) == 0)
+			mpz_set_ui(R, 0);
+		ec_ctx_end(ctx);
+		return mpz_sgn(a) == 0;
+	}
+
+	q = ec_ctx_get(ctx);
+	x = ec_ctx_get(ctx);
+
+	if (mpz_fdiv_ui(N, 4) == 3) {
+		mpz_add_ui(q, N, 1);
+		mpz_fdiv_q_2exp(q, q, 2);
+		mpz_powm(R, a, q, N);
+		ec_ctx_end(ctx);
+		return 1;
+	}
+
+	c = ec_ctx_get(ctx);
+	t = ec_ctx_get(ctx);
+	b = ec_ctx_get(ctx);
+
+	/* N - 1 = q * 2^s, q odd */
+	mpz_sub_ui(q, N, 1);
+	s = mpz_scan1(q, 0);
+	mpz_fdiv_q_2exp(q, q, s);
+
+	/* c = z^q for a non-residue z, of order 2^s */
+	for (mpz_set_ui(b, 2); mpz_legendre(b, N) != -1; mpz_add_ui(b, b, 1))
+		;
+	mpz_powm(c, b, q, N);
+
+	/* x = a^((q + 1) / 2), t = a^q: x^2 = a * t, the order of t divides 2^(s - 1) */
+	mpz_powm(t, a, q, N);
+	mpz_add_ui(q, q, 1);
+	mpz_fdiv_q_2exp(q, q, 1);
+	mpz_powm(x, a, q, N);
+
+	m = s;
+	while (mpz_cmp_ui(t, 1) != 0) {
+		/* least i such that t^(2^i) = 1 */
+		mpz_set(b, t);
+		for (i = 0; mpz_cmp_ui(b, 1) != 0; i++)
+			mod_sqr(b, b, N);
+
+		/* b = c^(2^(m - i - 1)), x = x * b, c = b^2, t = t * c */
+		mpz_set(b, c);
+		for (j = i + 1; j < m; j++)
+			mod_sqr(b, b, N);
+		m = i;
+		mod_mul(x, x, b, N);
+		mod_sqr(c, b, N);
+		mod_mul(t, t, c, N);
+	}
+	mpz_set(R, x);
+
+	ec_ctx_end(ctx);
+	return 1;
 }
 
 /*
@@ -375,7 +550,8 @@ void mod_sqrt(mpz_t R, mpz_t A, mpz_t N) {
 void modexp_multiply_always(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 
 	int i, b;
-	mpz_t R[2];
+	mpz_ptr R[2];
+	ec_ctx ctx;
 	mp_size_t k;
 
 	k = mpz_sizeinbase(exp, 2); //Set k = bit length of the exponent
@@ -385,7 +561,10 @@ void modexp_multiply_always(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 		return;
 	}
 
-	mpz_init_set(R[0], base); mpz_init_set(R[1], base);
+	ctx = ec_ctx_field_thread();
+	ec_ctx_start(ctx);
+	R[0] = ec_ctx_get(ctx); R[1] = ec_ctx_get(ctx);
+	mpz_set(R[0], base); mpz_set(R[1], base);
 
 	for(i = k - 2; i >= 0; i--) {
 
@@ -399,7 +578,7 @@ void modexp_multiply_always(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 	}
 
 	mpz_set(rop, R[0]);
-	mpz_clear(R[0]);mpz_clear(R[1]);
+	ec_ctx_end(ctx);
 }
 
 /*
@@ -413,7 +592,8 @@ void modexp_multiply_always(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 void modexp_atomic(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 
 	int i, k, b;
-	mpz_t R[2];
+	mpz_ptr R[2];
+	ec_ctx ctx;
 
 	k = mpz_sizeinbase(exp, 2); //Set t = bit length
 
@@ -422,7 +602,10 @@ void modexp_atomic(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 		return;
 	}
 
-	i = k - 1; mpz_init_set_ui(R[0], 1); mpz_init_set(R[1], base);
+	ctx = ec_ctx_field_thread();
+	ec_ctx_start(ctx);
+	R[0] = ec_ctx_get(ctx); R[1] = ec_ctx_get(ctx);
+	i = k - 1; mpz_set_ui(R[0], 1); mpz_set(R[1], base);
 	b = 0;
 
 	while(i >= 0) {
@@ -434,7 +617,7 @@ void modexp_atomic(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 	}
 
 	mpz_set(rop, R[0]);
-	mpz_clear(R[0]); mpz_clear(R[1]);
+	ec_ctx_end(ctx);
 
 }
 
@@ -474,7 +657,8 @@ static int coinToss() {
 void modexp_rand_montgomery_ladder(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 
 	int i, k, bit, randbit, irandbit;
-	mpz_t R[2];
+	mpz_ptr R[2];
+	ec_ctx ctx;
 
 	k = mpz_sizeinbase(exp, 2); //Set k = bit length of the exponent
 
@@ -483,15 +667,18 @@ void modexp_rand_montgomery_ladder(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 		return;
 	}
 
-	mpz_init_set_ui(R[0], 1);
+	ctx = ec_ctx_field_thread();
+	ec_ctx_start(ctx);
+	R[0] = ec_ctx_get(ctx); R[1] = ec_ctx_get(ctx);
+	mpz_set_ui(R[0], 1);
 	srand(time(NULL)); //     <- srand() here, just ONCE
 
 	randbit = coinToss();
 
 	if (! randbit)
-		mpz_init_set(R[1], base);
+		mpz_set(R[1], base);
 	else
-		mpz_init_set_ui(R[1], 1);
+		mpz_set_ui(R[1], 1);
 
 	for(i = k - 1; i >= 0; i--) {
 		bit = mpz_tstbit(exp,i);
@@ -509,7 +696,7 @@ void modexp_rand_montgomery_ladder(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 	}
 
 	mpz_set(rop, R[0]);
-	mpz_clear(R[0]);mpz_clear(R[1]);
+	ec_ctx_end(ctx);
 }
 
 /** Implementing the randomized Montgomery powering ladder proposed in WISTP 2015
@@ -518,7 +705,8 @@ void modexp_rand_montgomery_ladder(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N){
 void modexp_montgomery_ladder(mpz_t rop, mpz_t rop2, mpz_t base, mpz_t exp, mpz_t N){
 
 	int i, k, bit, ibit;
-	mpz_t R[2];
+	mpz_ptr R[2];
+	ec_ctx ctx;
 
 	k = mpz_sizeinbase(exp, 2); //Set k = bit length of the exponent
 
@@ -527,8 +715,11 @@ void modexp_montgomery_ladder(mpz_t rop, mpz_t rop2, mpz_t base, mpz_t exp, mpz_
 		return;
 	}
 
-	mpz_init_set_ui(R[0], 1);
-	mpz_init_set(R[1], base);
+	ctx = ec_ctx_field_thread();
+	ec_ctx_start(ctx);
+	R[0] = ec_ctx_get(ctx); R[1] = ec_ctx_get(ctx);
+	mpz_set_ui(R[0], 1);
+	mpz_set(R[1], base);
 
 	for(i = k - 1; i >= 0; i--) {
 		bit = mpz_tstbit(exp,i); ibit = bit ^ 0x1;
@@ -541,7 +732,7 @@ void modexp_montgomery_ladder(mpz_t rop, mpz_t rop2, mpz_t base, mpz_t exp, mpz_
 	}
 
 	mpz_set(rop, R[0]);mpz_set(rop2, R[1]);
-	mpz_clear(R[0]);mpz_clear(R[1]);
+	ec_ctx_end(ctx);
 }
 
 
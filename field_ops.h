@@ -8,6 +8,13 @@
 #ifndef FIELD_OPS_H_
 #define FIELD_OPS_H_
 
+/* Return the scratch context of the field operations of the calling thread, see ec_ctx.c */
+ec_ctx ec_ctx_field_thread(void);
+/* Open a frame, take temporaries from it, close it and give them all back */
+void ec_ctx_start(ec_ctx ctx);
+mpz_ptr ec_ctx_get(ec_ctx ctx);
+void ec_ctx_end(ec_ctx ctx);
+
 /* Perform modular operations: multiplication, square, inverse */
 void mod_neg(mpz_t R, mpz_t A, mpz_t N);
 void mod_sec_add(mpz_t R, mpz_t A, mpz_t B, mpz_t N);
@@ -23,6 +30,7 @@ void mod_mulsub(mpz_t R, mpz_t A, mpz_t B, mpz_t C, mpz_t N);
 
 void mod_sqr(mpz_t R, mpz_t A, mpz_t N);
 int mod_invert(mpz_t R, mpz_t A, mpz_t N);
+int mod_batch_invert(mpz_t R[], mpz_t A[], int n, mpz_t N);
 
 /* Perform a modular operations in data-independent time */
 void mod_add(mpz_t R, mpz_t A, mpz_t B, mpz_t N);
@@ -30,9 +38,11 @@ void mod_sec_sub(mpz_t R, mpz_t A, mpz_t B, mpz_t N);
 void mod_sec_mul(mpz_t R, mpz_t A, mpz_t B, mpz_t N);
 void mod_sec_sqr(mpz_t R, mpz_t A, mpz_t N);
 int mod_sec_invert(mpz_t R, mpz_t A, mpz_t N);
+void mod_Fermat_invert(mpz_t R, mpz_t A, mpz_t P);
+int mod_sec_batch_invert(mpz_t R[], mpz_t A[], int n, mpz_t P, const fe_field f);
 
 /* Number theory functions */
-void mod_sqrt(mpz_t R, mpz_t A, mpz_t N);
+int mod_sqrt(mpz_t R, mpz_t A, mpz_t N);
 
 /* Compute base ^ exp mod N, using left-to-right square-and-multiply always algorithm */
 void modexp_multiply_always(mpz_t rop, mpz_t base, mpz_t exp, mpz_t N);
@@ -8,96 +8,149 @@
 #include "ecdsa.h"
 #include "hash_functions.h"
 
-/**	Given a file. Function hashes and returns a string
- * 	\param 	in_fname		name of the input file
- *	\return hash digest of the file in_fname
- */
-char* get_dgst_224(const char* in_fname) {
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-	char *hash = malloc(SHA224_DIGEST_STRING_LENGTH);
-	hash[SHA224_DIGEST_STRING_LENGTH] = '\0';
-	FILE *msg_fp = NULL;
-	SHA224_Context ctx;
-	uchar buf[1000];
-	uchar sha224sum[SHA224_DIGEST_LENGTH];
-	int i;
+/* Size of the slices of a mapped file given to the update functions, whose length is a uint,
+ * and of the buffer of the streaming path. Multiples of the blocks of SHA-256 and SHA-384 */
+#define DGST_MAP_CHUNK		(1UL << 30)
+#define DGST_READ_CHUNK		(64 * 1024)
 
-	if (!(msg_fp = fopen( in_fname, "rb"))) {
-		hash = sha224(in_fname);
-	} else {
-		sha224_init( &ctx );
+typedef void (*dgst_update_fn)(void *ctx, uchar data[], uint len);
 
-		while ((i = fread( buf, 1, sizeof(buf), msg_fp )) > 0) {
-			sha224_update(&ctx, buf, i);
-		}
+static void dgst_update_256(void *ctx, uchar data[], uint len) {
+	sha256_update(ctx, data, len);
+}
 
-		sha224_final(&ctx, sha224sum);
+static void dgst_update_384(void *ctx, uchar data[], uint len) {
+	sha384_update(ctx, data, len);
+}
 
-		for(i = 0; i < SHA224_DIGEST_LENGTH ; ++i) {
-			sprintf(hash +i*2, "%02x", sha224sum[i]);
+/* Feed the content of the file fname to update. A regular file is mapped in memory and read in
+ * place, with a hint that it is read sequentially; pipes, devices and files that cannot be
+ * mapped are read in chunks of DGST_READ_CHUNK bytes.
+ * Return 0 if the file cannot be opened, 1 otherwise */
+static int dgst_file(const char *fname, dgst_update_fn update, void *ctx) {
+	uchar buf[DGST_READ_CHUNK];
+	struct stat st;
+	size_t size, off, n;
+	ssize_t r;
+	uchar *map;
+	int fd;
+
+	if ((fd = open(fname, O_RDONLY)) < 0)
+		return 0;
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+			&& (off_t) (size_t) st.st_size == st.st_size) {
+		size = st.st_size;
+		map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			madvise(map, size, MADV_SEQUENTIAL);
+			for (off = 0; off < size; off += n) {
+				n = size - off < DGST_MAP_CHUNK ? size - off : DGST_MAP_CHUNK;
+				update(ctx, map + off, n);
+			}
+			munmap(map, size);
+			close(fd);
+			return 1;
 		}
 	}
 
-	return hash;
+	while ((r = read(fd, buf, sizeof(buf))) != 0) {
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		update(ctx, buf, r);
+	}
+	close(fd);
+	return 1;
+}
+
+/* Write the len bytes of dgst in lower-case hexadecimal, terminated by '\0' */
+static void dgst_to_hex(char *hex, const uchar *dgst, int len) {
+	static const char digits[] = "0123456789abcdef";
+	int i;
 
+	for (i = 0; i < len; i++) {
+		hex[2 * i] = digits[dgst[i] >> 4];
+		hex[2 * i + 1] = digits[dgst[i] & 0xf];
+	}
+	hex[2 * len] = '\0';
 }
 
-char* get_dgst_256(const char* msg) {
+/**	Given a file, hashes it with SHA-224 into raw bytes, from a memory mapping of the file when
+ *	possible. If the file cannot be opened, the name itself is hashed, as get_dgst_224 does.
+ * 	\param 	dgst			SHA224_DIGEST_LENGTH bytes
+ * 	\param 	in_fname		name of the input file
+ */
+void get_dgst_bin_224(uchar dgst[], const char* in_fname) {
+
+	SHA224_Context ctx;
+
+	sha224_init( &ctx );
+	if (!dgst_file(in_fname, dgst_update_256, &ctx))
+		sha224_update(&ctx, (uchar *) in_fname, strlen(in_fname));
+	sha224_final(&ctx, dgst);
+}
+
+void get_dgst_bin_256(uchar dgst[], const char* msg) {
 
-	int i;
 	SHA256_Context ctx;
-	uchar buf[1000];
-	uchar sha256sum[SHA256_DIGEST_LENGTH];
-	char* hash = malloc(SHA256_DIGEST_STRING_LENGTH);
-	hash[SHA256_DIGEST_STRING_LENGTH] = '\0';
-	FILE *msg_fp = NULL;
 
-	if (!(msg_fp = fopen( msg, "rb"))) {
-		hash = sha256(msg);
-	} else {
-		sha256_init( &ctx );
+	sha256_init( &ctx );
+	if (!dgst_file(msg, dgst_update_256, &ctx))
+		sha256_update(&ctx, (uchar *) msg, strlen(msg));
+	sha256_final(&ctx, dgst);
+}
 
-		while ((i = fread( buf, 1, sizeof(buf), msg_fp )) > 0) {
-			sha256_update(&ctx, buf, i);
-		}
+void get_dgst_bin_384(uchar dgst[], const char* msg) {
 
-		sha256_final(&ctx, sha256sum);
+	SHA384_Context ctx;
 
-		for(i = 0; i < SHA256_DIGEST_LENGTH ; ++i) {
-			sprintf(hash +i*2, "%02x", sha256sum[i]);
-		}
-	}
+	sha384_init( &ctx );
+	if (!dgst_file(msg, dgst_update_384, &ctx))
+		sha384_update(&ctx, (uchar *) msg, strlen(msg));
+	sha384_final(&ctx, dgst);
+}
+
+/**	Given a file. Function hashes and returns a string
+ * 	\param 	in_fname		name of the input file
+ *	\return hash digest of the file in_fname, must be released with free()
+ */
+char* get_dgst_224(const char* in_fname) {
+
+	uchar sha224sum[SHA224_DIGEST_LENGTH];
+	char *hash = malloc(SHA224_DIGEST_STRING_LENGTH);
 
+	get_dgst_bin_224(sha224sum, in_fname);
+	dgst_to_hex(hash, sha224sum, SHA224_DIGEST_LENGTH);
 	return hash;
 
 }
 
-char* get_dgst_384(const char* msg) {
+char* get_dgst_256(const char* msg) {
 
-	int i;
-	SHA384_Context ctx;
-	uchar buf[1000];
-	uchar sha384sum[SHA384_DIGEST_LENGTH];
-	char* hash = malloc(SHA384_DIGEST_STRING_LENGTH);
-	hash[SHA384_DIGEST_STRING_LENGTH] = '\0';
-	FILE *msg_fp = NULL;
+	uchar sha256sum[SHA256_DIGEST_LENGTH];
+	char *hash = malloc(SHA256_DIGEST_STRING_LENGTH);
 
-	if (!(msg_fp = fopen( msg, "rb"))) {
-		hash = sha384(msg);
-	} else {
-		sha384_init( &ctx );
+	get_dgst_bin_256(sha256sum, msg);
+	dgst_to_hex(hash, sha256sum, SHA256_DIGEST_LENGTH);
+	return hash;
 
-		while ((i = fread( buf, 1, sizeof(buf), msg_fp )) > 0) {
-			sha384_update(&ctx, buf, i);
-		}
+}
 
-		sha384_final(&ctx, sha384sum);
+char* get_dgst_384(const char* msg) {
 
-		for(i = 0; i < SHA384_DIGEST_LENGTH ; ++i) {
-			sprintf(hash +i*2, "%02x", sha384sum[i]);
-		}
-	}
+	uchar sha384sum[SHA384_DIGEST_LENGTH];
+	char *hash = malloc(SHA384_DIGEST_STRING_LENGTH);
 
+	get_dgst_bin_384(sha384sum, msg);
+	dgst_to_hex(hash, sha384sum, SHA384_DIGEST_LENGTH);
 	return hash;
 
 }
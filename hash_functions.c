@@ -10,7 +10,9 @@
 
 static void sha1_transform(SHA1_Context *ctx, uchar data[]);
 static void sha224_256_transform(SHA256_Context *ctx, uchar data[]);
+static void sha224_256_transform_blocks(uint state[8], const uchar *data, size_t nblocks);
 static void sha384_512_transform(SHA512_Context *ctx);
+static void sha384_512_transform_blocks(uint64 state[8], const uchar *data, size_t nblocks);
 
 /* Hash constant words K defined in SHA-1   */
 const uint K160[] = {
@@ -130,75 +132,103 @@ static void sha1_transform(SHA1_Context *ctx, uchar data[]) {
 
 
 static void sha224_256_transform(SHA256_Context *ctx, uchar data[]) {
+	sha224_256_transform_blocks(ctx->state, data, 1);
+}
+
+/* Process nblocks consecutive blocks of 64 bytes of data, read with byte loads at any alignment.
+ * The working variables stay in local variables from one block to the next, the state is only
+ * written back after the last block */
+static void sha224_256_transform_blocks(uint state[8], const uchar *data, size_t nblocks) {
 	uint i, j, t1, t2, m[64];
-	uint wv[8];
+	uint wv[8], h[8];
 
-	for (i=0,j=0; i < 16; ++i, j += 4)
-		m[i] = (data[j] << 24) | (data[j+1] << 16) | (data[j+2] << 8) | (data[j+3]);
-	for ( ; i < 64; ++i)
-		m[i] = SHA256_F4(m[i-2]) + m[i-7] + SHA256_F3(m[i-15]) + m[i-16];
+	for (j = 0; j < 8; j++)
+		h[j] = state[j];
 
-	for (j = 0; j < 8; j++) {
-		wv[j] = ctx->state[j];
-	}
+	for ( ; nblocks > 0; nblocks--, data += SHA256_BLOCK_LENGTH) {
+		for (i=0,j=0; i < 16; ++i, j += 4)
+			m[i] = ((uint) data[j] << 24) | (data[j+1] << 16) | (data[j+2] << 8) | (data[j+3]);
+		for ( ; i < 64; ++i)
+			m[i] = SHA256_F4(m[i-2]) + m[i-7] + SHA256_F3(m[i-15]) + m[i-16];
 
-	for (i = 0; i < 64; ++i) {
-		t1 = wv[7] + SHA256_F2(wv[4]) + CH(wv[4],wv[5],wv[6]) + K256[i] + m[i];
-		t2 = SHA256_F1(wv[0]) + MAJ(wv[0],wv[1],wv[2]);
-		wv[7] = wv[6];
-		wv[6] = wv[5];
-		wv[5] = wv[4];
-		wv[4] = wv[3] + t1;
-		wv[3] = wv[2];
-		wv[2] = wv[1];
-		wv[1] = wv[0];
-		wv[0] = t1 + t2;
-	}
+		for (j = 0; j < 8; j++) {
+			wv[j] = h[j];
+		}
+
+		for (i = 0; i < 64; ++i) {
+			t1 = wv[7] + SHA256_F2(wv[4]) + CH(wv[4],wv[5],wv[6]) + K256[i] + m[i];
+			t2 = SHA256_F1(wv[0]) + MAJ(wv[0],wv[1],wv[2]);
+			wv[7] = wv[6];
+			wv[6] = wv[5];
+			wv[5] = wv[4];
+			wv[4] = wv[3] + t1;
+			wv[3] = wv[2];
+			wv[2] = wv[1];
+			wv[1] = wv[0];
+			wv[0] = t1 + t2;
+		}
 
-	for (j = 0; j < 8; j++) {
-		ctx->state[j] += wv[j];
+		for (j = 0; j < 8; j++) {
+			h[j] += wv[j];
+		}
 	}
+
+	for (j = 0; j < 8; j++)
+		state[j] = h[j];
 }
 
 static void sha384_512_transform(SHA512_Context *ctx){
+	sha384_512_transform_blocks(ctx->state, ctx->data, 1);
+}
+
+/* Process nblocks consecutive blocks of 128 bytes of data, see sha224_256_transform_blocks */
+static void sha384_512_transform_blocks(uint64 state[8], const uchar *data, size_t nblocks){
 
 	uint i, j;
 	uint64 t1, t2, m[80];
-	uint64 wv[8];
-
-	for (i = 0, j = 0; i < 16; ++i, j += 8)
-		m[i] = ((uint64) (ctx->data[j]) << 56) |
-				((uint64) (ctx->data[j+1]) << 48) |
-				((uint64) (ctx->data[j+2]) << 40) |
-				((uint64) (ctx->data[j+3]) << 32) |
-				((uint64) (ctx->data[j+4]) << 24) |
-				((uint64) (ctx->data[j+5]) << 16) |
-				((uint64) (ctx->data[j+6]) << 8) |
-				((uint64) (ctx->data[j+7]));
-
-	for ( ; i < 80; ++i)
-		m[i] = SHA512_F4(m[i-2]) + m[i-7] + SHA512_F3(m[i-15]) + m[i-16];
-
-	for (j = 0; j < 8; j++) {
-		wv[j] = ctx->state[j];
-	}
+	uint64 wv[8], h[8];
+
+	for (j = 0; j < 8; j++)
+		h[j] = state[j];
+
+	for ( ; nblocks > 0; nblocks--, data += SHA512_BLOCK_LENGTH) {
+		for (i = 0, j = 0; i < 16; ++i, j += 8)
+			m[i] = ((uint64) (data[j]) << 56) |
+					((uint64) (data[j+1]) << 48) |
+					((uint64) (data[j+2]) << 40) |
+					((uint64) (data[j+3]) << 32) |
+					((uint64) (data[j+4]) << 24) |
+					((uint64) (data[j+5]) << 16) |
+					((uint64) (data[j+6]) << 8) |
+					((uint64) (data[j+7]));
+
+		for ( ; i < 80; ++i)
+			m[i] = SHA512_F4(m[i-2]) + m[i-7] + SHA512_F3(m[i-15]) + m[i-16];
+
+		for (j = 0; j < 8; j++) {
+			wv[j] = h[j];
+		}
 
-	for (i = 0; i < 80; ++i) {
-		t1 = wv[7] + SHA512_F2(wv[4]) + CH(wv[4],wv[5],wv[6]) + K512[i] + m[i];
-		t2 = SHA512_F1(wv[0]) + MAJ(wv[0],wv[1],wv[2]);
-		wv[7] = wv[6];
-		wv[6] = wv[5];
-		wv[5] = wv[4];
-		wv[4] = wv[3] + t1;
-		wv[3] = wv[2];
-		wv[2] = wv[1];
-		wv[1] = wv[0];
-		wv[0] = t1 + t2;
-	}
+		for (i = 0; i < 80; ++i) {
+			t1 = wv[7] + SHA512_F2(wv[4]) + CH(wv[4],wv[5],wv[6]) + K512[i] + m[i];
+			t2 = SHA512_F1(wv[0]) + MAJ(wv[0],wv[1],wv[2]);
+			wv[7] = wv[6];
+			wv[6] = wv[5];
+			wv[5] = wv[4];
+			wv[4] = wv[3] + t1;
+			wv[3] = wv[2];
+			wv[2] = wv[1];
+			wv[1] = wv[0];
+			wv[0] = t1 + t2;
+		}
 
-	for (j = 0; j < 8; j++) {
-		ctx->state[j] += wv[j];
+		for (j = 0; j < 8; j++) {
+			h[j] += wv[j];
+		}
 	}
+
+	for (j = 0; j < 8; j++)
+		state[j] = h[j];
 }
 
 
@@ -310,33 +340,71 @@ void sha224_update(SHA224_Context *ctx, uchar data[], uint len){
  */
 void sha256_update(SHA256_Context *ctx, uchar data[], uint len){
 
-   uint i;
+   uint i = 0, n;
+   uint64 bits;
+
+   // Complete the block already in the buffer
+   if (ctx->datalen > 0) {
+      n = SHA256_BLOCK_LENGTH - ctx->datalen;
+      if (n > len)
+         n = len;
+      memcpy(ctx->data + ctx->datalen, data, n);
+      ctx->datalen += n;
+      i = n;
+      if (ctx->datalen < SHA256_BLOCK_LENGTH)
+         return;
+      sha224_256_transform(ctx,ctx->data);
+      DBL_INT_ADD(ctx->bitlen[0],ctx->bitlen[1], SHA256_BLOCK_LENGTH << 3); //512);
+      ctx->datalen = 0;
+   }
 
-   for (i=0; i < len; ++i) {
-      ctx->data[ctx->datalen] = data[i];
-      ctx->datalen++;
-      if (ctx->datalen == SHA256_BLOCK_LENGTH) {
-         sha224_256_transform(ctx,ctx->data);
-         DBL_INT_ADD(ctx->bitlen[0],ctx->bitlen[1], SHA256_BLOCK_LENGTH << 3); //512);
-         ctx->datalen = 0;
-      }
+   // Whole blocks straight from data, without copying them into the buffer
+   n = (len - i) / SHA256_BLOCK_LENGTH;
+   if (n > 0) {
+      sha224_256_transform_blocks(ctx->state, data + i, n);
+      bits = (((uint64) ctx->bitlen[1] << 32) | ctx->bitlen[0]) + ((uint64) n * SHA256_BLOCK_LENGTH << 3);
+      ctx->bitlen[0] = (uint) bits;
+      ctx->bitlen[1] = (uint) (bits >> 32);
+      i += n * SHA256_BLOCK_LENGTH;
    }
+
+   // Keep the tail for the next update or the padding
+   memcpy(ctx->data, data + i, len - i);
+   ctx->datalen = len - i;
 }
 
 
 
 void sha384_update(SHA384_Context *ctx, uchar data[], uint len){
 
-	uint i;
-	for (i=0; i < len; ++i) {
-		ctx->data[ctx->datalen] = data[i];
-		ctx->datalen++;
-		if (ctx->datalen == SHA512_BLOCK_LENGTH) {
-			DBL_INT_ADD_128(ctx->bitlen[0], ctx->bitlen[1], SHA512_BLOCK_LENGTH << 3);
-			sha384_512_transform(ctx);
-			ctx->datalen = 0;
-		}
+	uint i = 0, n;
+
+	// Complete the block already in the buffer
+	if (ctx->datalen > 0) {
+		n = SHA512_BLOCK_LENGTH - ctx->datalen;
+		if (n > len)
+			n = len;
+		memcpy(ctx->data + ctx->datalen, data, n);
+		ctx->datalen += n;
+		i = n;
+		if (ctx->datalen < SHA512_BLOCK_LENGTH)
+			return;
+		DBL_INT_ADD_128(ctx->bitlen[0], ctx->bitlen[1], SHA512_BLOCK_LENGTH << 3);
+		sha384_512_transform(ctx);
+		ctx->datalen = 0;
 	}
+
+	// Whole blocks straight from data, without copying them into the buffer
+	n = (len - i) / SHA512_BLOCK_LENGTH;
+	if (n > 0) {
+		sha384_512_transform_blocks(ctx->state, data + i, n);
+		DBL_INT_ADD_128(ctx->bitlen[0], ctx->bitlen[1], (uint64) n * SHA512_BLOCK_LENGTH << 3);
+		i += n * SHA512_BLOCK_LENGTH;
+	}
+
+	// Keep the tail for the next update or the padding
+	memcpy(ctx->data, data + i, len - i);
+	ctx->datalen = len - i;
 }
 
 
@@ -393,7 +461,11 @@ void sha1_final(SHA1_Context *ctx, uchar dgst[]) {
  *
  */
 void sha224_final(SHA224_Context *ctx, uchar dgst[]) {
-	sha256_final(ctx, dgst);
+	uchar full[SHA256_DIGEST_LENGTH];
+
+	// SHA-224 is SHA-256 with other initial values, truncated to its first 28 bytes
+	sha256_final(ctx, full);
+	memcpy(dgst, full, SHA224_DIGEST_LENGTH);
 }
 
 /**
@@ -507,8 +579,7 @@ void sha384_final(SHA384_Context *ctx, uchar dgst[]){
 		dgst[i+24] = (ctx->state[3] >> (56-i*8)) & 0x000000ff;
 		dgst[i+32] = (ctx->state[4] >> (56-i*8)) & 0x000000ff;
 		dgst[i+40] = (ctx->state[5] >> (56-i*8)) & 0x000000ff;
-		dgst[i+48] = (ctx->state[6] >> (56-i*8)) & 0x000000ff;
-		dgst[i+56] = (ctx->state[7] >> (56-i*8)) & 0x000000ff;
+		// SHA-384 keeps the first 6 words of the state only
 	}
 	/** or the following code
 	 * 	giving the same result
@@ -548,7 +619,7 @@ char* sha1(const char* msg){
 	SHA1_Context ctx;
 	uchar digest[SHA1_DIGEST_LENGTH];
 	char* hash = malloc(SHA1_DIGEST_STRING_LENGTH);
-	hash[SHA1_DIGEST_STRING_LENGTH] = '\0';
+	hash[SHA1_DIGEST_STRING_LENGTH - 1] = '\0';
 	int i;
 
 	// Initialize sha context
@@ -572,7 +643,7 @@ char* sha224(const char* msg){
 	SHA224_Context ctx;
 	uchar digest[SHA224_DIGEST_LENGTH];
 	char* hash = malloc(SHA224_DIGEST_STRING_LENGTH);
-	hash[SHA224_DIGEST_STRING_LENGTH] = '\0';
+	hash[SHA224_DIGEST_STRING_LENGTH - 1] = '\0';
 	int i;
 
 	// Initialize sha context
@@ -596,7 +667,7 @@ char* sha256(const char* msg){
 	SHA256_Context ctx;
 	uchar digest[SHA256_DIGEST_LENGTH];
 	char* hash = malloc(SHA256_DIGEST_STRING_LENGTH);
-	hash[SHA256_DIGEST_STRING_LENGTH] = '\0';
+	hash[SHA256_DIGEST_STRING_LENGTH - 1] = '\0';
 	int i;
 
 	// Initialize sha context
@@ -622,7 +693,7 @@ char* sha384(const char* msg){
 	SHA384_Context ctx;
 	uchar digest[SHA384_DIGEST_LENGTH];
 	char* hash = malloc(SHA384_DIGEST_STRING_LENGTH);
-	hash[SHA384_DIGEST_STRING_LENGTH] = '\0';
+	hash[SHA384_DIGEST_STRING_LENGTH - 1] = '\0';
 	int i;
 
 	// Initialize sha context
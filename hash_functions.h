@@ -127,13 +127,16 @@ char* sha1(const char* message);
 /* Given a message with arbitrary length, function SHA2-224 hashes and returns a fixed digest of 256 bits */
 char* sha224(const char* message);
 char* get_dgst_224(const char* filename);
+void get_dgst_bin_224(uchar dgst[], const char* filename);
 
 /* Given a message with arbitrary length, function SHA2-256 hashes and returns a fixed digest of 256 bits */
 char* sha256(const char* message);
 char* get_dgst_256(const char* filename);
+void get_dgst_bin_256(uchar dgst[], const char* filename);
 
 /* Given a message with arbitrary length, function hashes and returns a fixed digest of 256 bits */
 char* sha384(const char* message);
 char* get_dgst_384(const char* filename);
+void get_dgst_bin_384(uchar dgst[], const char* filename);
 
 #endif /* HASH_FUNCTIONS_H_ */
@@ -8,6 +8,8 @@
 #include"ecdsa.h"
 #include"hash_functions.h"
 
+#include <sys/wait.h>
+
 /*
  * Testing SHA1, SHA2, the following msgs, vals are the standard FIPS-180-2 test vectors
  * http://csrc.nist.gov/groups/ST/toolkit/examples.html
@@ -60,6 +62,104 @@ static char *sha512_val[] = {
 		"96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445"
 };*/
 
+/* Digests of one million repetitions of 'a', FIPS 180-2 */
+static const char *million_a_val[] = {
+		"20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67",
+		"cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+		"9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b" \
+		"07b8b3dc38ecc4ebae97ddd87f3d8985"
+};
+
+/* Compare the digests of fname with those of one million 'a' */
+static int million_a_cmp(const char *fname) {
+	char *d224 = get_dgst_224(fname), *d256 = get_dgst_256(fname), *d384 = get_dgst_384(fname);
+	int ok = !strcmp(d224, million_a_val[0]) && !strcmp(d256, million_a_val[1])
+			&& !strcmp(d384, million_a_val[2]);
+
+	free(d224); free(d256); free(d384);
+	return ok;
+}
+
+/* Hashing of files: a regular file, read through a memory mapping, and a pipe, read as a stream */
+static int dgst_file_test(void) {
+	char fname[] = "/tmp/hashtestXXXXXX", pname[32];
+	char *a = malloc(1000000), *d;
+	int fd, p[2], ok;
+	pid_t pid;
+
+	memset(a, 'a', 1000000);
+	fd = mkstemp(fname);
+	ok = fd >= 0 && write(fd, a, 1000000) == 1000000;
+	if (fd >= 0) {
+		close(fd);
+		ok &= million_a_cmp(fname);
+		unlink(fname);
+	}
+
+	ok &= pipe(p) == 0;
+	if (ok && (pid = fork()) == 0) {
+		close(p[0]);
+		_exit(write(p[1], a, 1000000) != 1000000);
+	} else if (ok) {
+		close(p[1]);
+		snprintf(pname, sizeof(pname), "/dev/fd/%d", p[0]);
+		d = get_dgst_256(pname);	// a pipe is read once
+		ok &= !strcmp(d, million_a_val[1]);
+		free(d);
+		close(p[0]);
+		waitpid(pid, NULL, 0);
+	}
+
+	free(a);
+	return ok;
+}
+
+/* Updates split at every offset, and byte by byte, give the digest of a single update: the
+ * whole blocks taken from the input and the partial blocks kept in the buffer must agree */
+static int update_split_test(void) {
+	uchar data[3 * SHA512_BLOCK_LENGTH + 5], d256[SHA256_DIGEST_LENGTH], d384[SHA384_DIGEST_LENGTH];
+	uchar r256[SHA256_DIGEST_LENGTH], r384[SHA384_DIGEST_LENGTH];
+	SHA256_Context c256;
+	SHA384_Context c384;
+	uint i, k;
+	int ok = 1;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 31 + 7;
+
+	sha256_init(&c256);
+	sha256_update(&c256, data, sizeof(data));
+	sha256_final(&c256, r256);
+	sha384_init(&c384);
+	sha384_update(&c384, data, sizeof(data));
+	sha384_final(&c384, r384);
+
+	for (k = 0; k <= sizeof(data); k++) {
+		sha256_init(&c256);
+		sha256_update(&c256, data, k);
+		sha256_update(&c256, data + k, sizeof(data) - k);
+		sha256_final(&c256, d256);
+		ok &= !memcmp(d256, r256, sizeof(d256));
+		sha384_init(&c384);
+		sha384_update(&c384, data, k);
+		sha384_update(&c384, data + k, sizeof(data) - k);
+		sha384_final(&c384, d384);
+		ok &= !memcmp(d384, r384, sizeof(d384));
+	}
+
+	sha256_init(&c256);
+	sha384_init(&c384);
+	for (i = 0; i < sizeof(data); i++) {
+		sha256_update(&c256, data + i, 1);
+		sha384_update(&c384, data + i, 1);
+	}
+	sha256_final(&c256, d256);
+	sha384_final(&c384, d384);
+	ok &= !memcmp(d256, r256, sizeof(d256)) && !memcmp(d384, r384, sizeof(d384));
+
+	return ok;
+}
+
 int main(int argc, char* argv[]) {
     FILE *fp;
     int i, j;
@@ -68,13 +168,13 @@ int main(int argc, char* argv[]) {
     uchar sha256sum[32];
 
     char *output160 = malloc(SHA1_DIGEST_STRING_LENGTH);
-    output160[SHA1_DIGEST_STRING_LENGTH] = '\0';
+    output160[SHA1_DIGEST_STRING_LENGTH - 1] = '\0';
     char *output224 = malloc(SHA224_DIGEST_STRING_LENGTH);
-    output224[SHA224_DIGEST_STRING_LENGTH] = '\0';
+    output224[SHA224_DIGEST_STRING_LENGTH - 1] = '\0';
     char *output256 = malloc(SHA256_DIGEST_STRING_LENGTH);
-    output256[SHA256_DIGEST_STRING_LENGTH] = '\0';
+    output256[SHA256_DIGEST_STRING_LENGTH - 1] = '\0';
     char *output384 = malloc(SHA384_DIGEST_STRING_LENGTH);
-    output384[SHA256_DIGEST_STRING_LENGTH] = '\0';
+    output384[SHA384_DIGEST_STRING_LENGTH - 1] = '\0';
 
 
     if( argc < 2 ) {
@@ -138,6 +238,20 @@ int main(int argc, char* argv[]) {
         }
 
 
+        fprintf(stdout, "\nSplit Update Tests:\n\n" );
+        if( !update_split_test() ) {
+        	fprintf(stdout, "failed!\n" );
+        	return( 1 );
+        }
+        fprintf(stdout, "passed.\n" );
+
+        fprintf(stdout, "\nFile Hashing Tests:\n\n" );
+        if( !dgst_file_test() ) {
+        	fprintf(stdout, "failed!\n" );
+        	return( 1 );
+        }
+        fprintf(stdout, "passed.\n" );
+
         fprintf(stdout, "\n\n" );
 
     } else  {